@@ -0,0 +1,38 @@
+# =========================
+#
+#    Synthetic game emitter for the analytics ingest benchmark.
+#    Plays any number of players through the tasks and graphs in bin/ and streams their events to the tool.
+#
+
+QT          += core network
+QT          -= gui
+CONFIG      += c++11 console
+CONFIG      -= app_bundle
+DEFINES     *= QT_USE_QSTRINGBUILDER
+
+TARGET = AnalyticsBench
+TEMPLATE = app
+
+#the event encoding is shared with the tool
+INCLUDEPATH += ../Source
+
+SOURCES += main.cpp \
+    syntheticworld.cpp \
+    syntheticplayer.cpp \
+    analyticsemitter.cpp \
+    ../Source/analyticscbor.cpp \
+    ../Source/analyticsevent.cpp \
+    ../Source/analyticsframer.cpp \
+    ../Source/analyticsprotocol.cpp \
+    ../Source/analyticstimestamp.cpp \
+    ../Source/analyticsverbs.cpp
+
+HEADERS += syntheticworld.h \
+    syntheticplayer.h \
+    analyticsemitter.h \
+    ../Source/analyticscbor.h \
+    ../Source/analyticsevent.h \
+    ../Source/analyticsframer.h \
+    ../Source/analyticsprotocol.h \
+    ../Source/analyticstimestamp.h \
+    ../Source/analyticsverbs.h
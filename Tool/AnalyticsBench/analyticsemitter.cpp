@@ -0,0 +1,211 @@
+#include "analyticsemitter.h"
+
+#include <QTcpSocket>
+#include <QDebug>
+
+#include "analyticscbor.h"
+#include "analyticsevent.h"
+#include "analyticsprotocol.h"
+#include "syntheticplayer.h"
+#include "syntheticworld.h"
+
+static const int kHelloTimeout = 1000;  //ms
+static const int kPacingInterval = 5;   //ms
+
+AnalyticsEmitter::AnalyticsEmitter(const SyntheticWorld &world, const EmitterOptions &options, QObject *parent)
+    : QObject(parent)
+    , m_world(world)
+    , m_options(options)
+    , m_lastTick(0)
+    , m_rate(options.rate)
+    , m_credit(0)
+    , m_second(0)
+    , m_sentThisSecond(0)
+    , m_sentTotal(0)
+{
+    m_pacingTimer.setTimerType(Qt::PreciseTimer);
+    m_pacingTimer.setInterval(kPacingInterval);
+    connect(&m_pacingTimer, SIGNAL(timeout()), this, SLOT(tick()));
+}
+
+AnalyticsEmitter::~AnalyticsEmitter()
+{
+    foreach (Session *session, m_sessions)
+    {
+        delete session->player;
+        delete session;
+    }
+}
+
+void AnalyticsEmitter::start()
+{
+    for(int i = 0; i < m_options.sessions; ++i)
+    {
+        Session *session = new Session();
+        session->socket = new QTcpSocket(this);
+        session->framer.setMode(m_options.framing);
+        session->player = new SyntheticPlayer(m_world, i, m_options.seed);
+        session->sending = false;
+        session->binary = false;
+
+        //lots of small writes, don't let them wait for each other
+        session->socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+
+        connect(session->socket, SIGNAL(connected()), this, SLOT(connected()));
+        connect(session->socket, SIGNAL(disconnected()), this, SLOT(disconnected()));
+        connect(session->socket, SIGNAL(readyRead()), this, SLOT(readyRead()));
+
+        m_sessions.append(session);
+        session->socket->connectToHost(m_options.host, quint16(m_options.port));
+    }
+
+    qDebug() << "Connecting" << m_options.sessions << "players to" << m_options.host << m_options.port;
+    qDebug() << "second,events_per_player_per_second,sent";
+
+    m_clock.start();
+    m_pacingTimer.start();
+}
+
+AnalyticsEmitter::Session *AnalyticsEmitter::findSession(QObject *socket)
+{
+    foreach (Session *session, m_sessions)
+        if(session->socket == socket)
+            return session;
+
+    return nullptr;
+}
+
+void AnalyticsEmitter::connected()
+{
+    Session *session = findSession(sender());
+
+    if(!session)
+        return;
+
+    //the hello picks the format, an older tool sends none
+    session->connectedFor.start();
+}
+
+void AnalyticsEmitter::disconnected()
+{
+    Session *session = findSession(sender());
+
+    if(!session)
+        return;
+
+    if(m_pacingTimer.isActive())
+        qDebug() << session->player->getName() << "was disconnected by the tool";
+
+    session->sending = false;
+}
+
+void AnalyticsEmitter::readyRead()
+{
+    Session *session = findSession(sender());
+
+    if(!session)
+        return;
+
+    session->framer.readFrom(session->socket);
+
+    QByteArray frame;
+    while(session->framer.nextFrame(frame))
+    {
+        bool offersBinary;
+        qint64 resumeAfter;
+
+        //acks are not needed, every event is new
+        if(!session->sending && AnalyticsProtocol::readHello(frame, offersBinary, resumeAfter))
+            startSending(session, m_options.format == EMIT_CBOR || (m_options.format == EMIT_AUTO && offersBinary));
+    }
+}
+
+void AnalyticsEmitter::startSending(Session *session, bool binary)
+{
+    session->sending = true;
+    session->binary = binary;
+
+    if(binary)
+        session->socket->write(AnalyticsProtocol::streamPreamble());
+}
+
+void AnalyticsEmitter::tick()
+{
+    qint64 elapsed = m_clock.elapsed();
+
+    foreach (Session *session, m_sessions)
+        if(!session->sending && session->connectedFor.isValid() && session->connectedFor.elapsed() > kHelloTimeout &&
+                session->socket->state() == QAbstractSocket::ConnectedState)
+            startSending(session, m_options.format == EMIT_CBOR);
+
+    //credit builds up with time, so a late timer sends more rather than slowing the rate down
+    m_credit += m_rate * (elapsed - m_lastTick) / 1000.0;
+    m_lastTick = elapsed;
+
+    int burst = qMax(1, m_options.burst);
+    int count = 0;
+
+    while(m_credit >= burst)
+    {
+        count += burst;
+        m_credit -= burst;
+    }
+
+    if(count > 0)
+        foreach (Session *session, m_sessions)
+            if(session->sending)
+                sendEvents(session, count);
+
+    //report once a second
+    if(elapsed >= (m_second + 1) * 1000)
+    {
+        qDebug().noquote() << QString("%1,%2,%3").arg(m_second).arg(m_rate).arg(m_sentThisSecond);
+
+        ++m_second;
+        m_sentThisSecond = 0;
+
+        if(m_options.ramp > 0 && m_options.step > 0 && m_second % m_options.step == 0)
+            m_rate += m_options.ramp;
+
+        if(m_second >= m_options.duration)
+            stop();
+    }
+}
+
+void AnalyticsEmitter::sendEvents(Session *session, int count)
+{
+    AnalyticsEvent event;
+    QByteArray data;
+
+    //one write for everything due this tick
+    for(int i = 0; i < count; ++i)
+    {
+        session->player->next(event);
+
+        if(session->binary)
+            data += AnalyticsProtocol::frame(AnalyticsCbor::encodeEvent(event), FRAMING_LENGTH_PREFIXED);
+        else
+            data += AnalyticsProtocol::frame(event.toJson(), m_options.framing);
+    }
+
+    session->socket->write(data);
+
+    m_sentThisSecond += count;
+    m_sentTotal += count;
+}
+
+void AnalyticsEmitter::stop()
+{
+    m_pacingTimer.stop();
+
+    qDebug() << "Sent" << m_sentTotal << "events in" << m_second << "seconds";
+
+    foreach (Session *session, m_sessions)
+    {
+        session->sending = false;
+        session->socket->disconnectFromHost();
+    }
+
+    //give the sockets a moment to flush what was written
+    QTimer::singleShot(kHelloTimeout, this, [=]{finished(0);});
+}
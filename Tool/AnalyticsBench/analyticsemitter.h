@@ -0,0 +1,108 @@
+#ifndef ANALYTICSEMITTER_H
+#define ANALYTICSEMITTER_H
+
+#include <QObject>
+#include <QList>
+#include <QString>
+#include <QTimer>
+#include <QElapsedTimer>
+
+#include "analyticsframer.h"
+
+class QTcpSocket;
+class SyntheticWorld;
+class SyntheticPlayer;
+
+enum EmitterFormat
+{
+    EMIT_AUTO,      //CBOR if the tool offers it in its hello, JSON otherwise
+    EMIT_JSON,
+    EMIT_CBOR
+};
+
+struct EmitterOptions
+{
+    EmitterOptions()
+        : port(0)
+        , sessions(1)
+        , rate(10)
+        , burst(1)
+        , ramp(0)
+        , step(10)
+        , duration(60)
+        , format(EMIT_AUTO)
+        , framing(FRAMING_NEWLINE)
+        , seed(1)
+    {}
+
+    QString host;       //tool listening for games
+    int port;
+    int sessions;       //players, each on its own connection
+    double rate;        //events per second per player
+    int burst;          //events written together, games tend to send a few at once
+    double ramp;        //added to the rate every step seconds, 0 keeps it fixed
+    int step;
+    int duration;       //seconds before disconnecting
+    EmitterFormat format;
+    FramingMode framing;
+    quint32 seed;
+};
+
+///
+/// \brief Streams the events of any number of synthetic players to the tool, paced to a target rate.
+///
+/// Every player connects like a game would, waits for the tool's hello to pick JSON or CBOR and
+/// then sends its events in bursts. Pacing is credit based so the rate holds when the timer is late,
+/// and the rate can be ramped up step by step to find where the tool falls behind.
+///
+class AnalyticsEmitter : public QObject
+{
+    Q_OBJECT
+public:
+    explicit AnalyticsEmitter(const SyntheticWorld &world, const EmitterOptions &options, QObject *parent = 0);
+    ~AnalyticsEmitter();
+
+    void start();
+
+signals:
+    void finished(int exitCode);
+
+private slots:
+    void connected();
+    void disconnected();
+    void readyRead();
+    void tick();
+
+private:
+    struct Session
+    {
+        QTcpSocket *socket;
+        AnalyticsFramer framer;
+        SyntheticPlayer *player;
+        QElapsedTimer connectedFor;
+        bool sending;
+        bool binary;
+    };
+
+    Session *findSession(QObject *socket);
+    void startSending(Session *session, bool binary);
+    void sendEvents(Session *session, int count);
+    void stop();
+
+    const SyntheticWorld &m_world;
+    EmitterOptions m_options;
+
+    QList<Session*> m_sessions;
+
+    QTimer m_pacingTimer;
+    QElapsedTimer m_clock;
+    qint64 m_lastTick;      //ms on m_clock
+    double m_rate;          //current events per second per player
+    double m_credit;        //events each player may send
+
+    int m_second;
+    int m_sentThisSecond;
+    qint64 m_sentTotal;
+};
+
+#endif // ANALYTICSEMITTER_H
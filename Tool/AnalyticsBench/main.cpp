@@ -0,0 +1,102 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDir>
+#include <QDebug>
+
+#include "analyticsemitter.h"
+#include "syntheticworld.h"
+
+static const int kGridWidth = 16;   //spatial graph made up when none is given
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("AnalyticsBench");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Plays synthetic players through the tasks and graphs of the tool and streams their events to it,\n"
+                                     "for measuring ingest latency. Start the tool with --benchmark <report.csv> and listen for players first.");
+    parser.addHelpOption();
+
+    QCommandLineOption connectOption("connect", "Tool listening for players at <host:port>.", "host:port");
+    QCommandLineOption sessionsOption("sessions", "Number of players, each on its own connection (default 1).", "count", "1");
+    QCommandLineOption rateOption("rate", "Events per second per player (default 10).", "rate", "10");
+    QCommandLineOption burstOption("burst", "Events written at once (default 1).", "count", "1");
+    QCommandLineOption rampOption("ramp", "Add <rate> events per second per player every step, to find the throughput ceiling.", "rate", "0");
+    QCommandLineOption stepOption("step", "Seconds between ramp steps (default 10).", "seconds", "10");
+    QCommandLineOption durationOption("duration", "Seconds to send for (default 60).", "seconds", "60");
+    QCommandLineOption formatOption("format", "auto, json or cbor (default auto, uses CBOR if the tool offers it).", "format", "auto");
+    QCommandLineOption framingOption("framing", "newline or length, must match the tool (default newline).", "framing", "newline");
+    QCommandLineOption binOption("bin", "Directory with tasks.json and gameplay_graph/ (default ../bin).", "dir", "../bin");
+    QCommandLineOption nodesOption("nodes", "Spatial graph nodes file, as loaded for lostness.", "file");
+    QCommandLineOption edgesOption("edges", "Spatial graph edges file, as loaded for lostness.", "file");
+    QCommandLineOption seedOption("seed", "Seed for the players (default 1).", "seed", "1");
+
+    parser.addOptions({connectOption, sessionsOption, rateOption, burstOption, rampOption, stepOption, durationOption,
+                       formatOption, framingOption, binOption, nodesOption, edgesOption, seedOption});
+    parser.process(app);
+
+    if(!parser.isSet(connectOption) || parser.isSet(nodesOption) != parser.isSet(edgesOption))
+        parser.showHelp(1);
+
+    EmitterOptions options;
+    QString address = parser.value(connectOption);
+    int separator = address.lastIndexOf(':');
+
+    options.host = address.left(separator);
+    options.port = address.mid(separator + 1).toInt();
+    options.sessions = parser.value(sessionsOption).toInt();
+    options.rate = parser.value(rateOption).toDouble();
+    options.burst = parser.value(burstOption).toInt();
+    options.ramp = parser.value(rampOption).toDouble();
+    options.step = parser.value(stepOption).toInt();
+    options.duration = parser.value(durationOption).toInt();
+    options.seed = parser.value(seedOption).toUInt();
+
+    QString format = parser.value(formatOption);
+
+    if(format == "json")
+        options.format = EMIT_JSON;
+    else
+        if(format == "cbor")
+            options.format = EMIT_CBOR;
+
+    if(parser.value(framingOption) == "length")
+        options.framing = FRAMING_LENGTH_PREFIXED;
+
+    if(options.port <= 0 || options.sessions <= 0 || options.rate <= 0 || options.duration <= 0)
+    {
+        qDebug() << "Port, sessions, rate and duration must be greater than 0";
+        return 1;
+    }
+
+    QDir bin(parser.value(binOption));
+    SyntheticWorld world;
+
+    if(!world.loadTasks(bin.filePath("tasks.json")))
+    {
+        qDebug() << "No tasks could be loaded from" << bin.filePath("tasks.json");
+        return 1;
+    }
+
+    if(!world.loadNarrativeGraphs(bin.filePath("gameplay_graph")))
+        qDebug() << "No narrative graphs found, players won't pick anything up";
+
+    if(parser.isSet(nodesOption))
+    {
+        if(!world.loadSpatialGraph(parser.value(nodesOption), parser.value(edgesOption)))
+            return 1;
+    }
+    else
+        world.makeGridGraph(kGridWidth);
+
+    qDebug() << world.getCuratorLabels().size() << "curator labels," << world.getNarrativeNodes().size() << "narrative nodes,"
+             << world.getSpatialNodes().size() << "spatial nodes";
+
+    AnalyticsEmitter emitter(world, options);
+    QObject::connect(&emitter, &AnalyticsEmitter::finished, &app, &QCoreApplication::exit);
+
+    emitter.start();
+
+    return app.exec();
+}
@@ -0,0 +1,133 @@
+#include "syntheticplayer.h"
+
+#include <QDateTime>
+
+#include "syntheticworld.h"
+#include "analyticsverbs.h"
+
+static const int kMaxWalk = 12;             //locomotion events between starting a label and its objectives
+static const int kPickUpChance = 8;         //one in this many steps picks something up
+static const int kFailChance = 4;           //one in this many attempts fails before unlocking
+
+static const QString kName_Unlock = "unlock";
+static const QString kName_Fail = "fail";
+
+SyntheticPlayer::SyntheticPlayer(const SyntheticWorld &world, int index, quint32 seed)
+    : m_world(world)
+    , m_name(QString("Player %1").arg(index + 1))
+    , m_state(seed * 2654435761u + quint32(index) + 1)
+    , m_curatorLabel(0)
+    , m_phase(PHASE_START)
+    , m_steps(0)
+    , m_objective(0)
+    , m_nextSequence(1)
+{
+    //xorshift gets stuck on 0
+    if(m_state == 0)
+        m_state = 1;
+
+    if(!m_world.getSpatialNodes().isEmpty())
+        m_location = m_world.getSpatialNodes()[random(m_world.getSpatialNodes().size())];
+}
+
+quint32 SyntheticPlayer::random()
+{
+    m_state ^= m_state << 13;
+    m_state ^= m_state >> 17;
+    m_state ^= m_state << 5;
+    return m_state;
+}
+
+void SyntheticPlayer::next(AnalyticsEvent &event)
+{
+    const QList<SyntheticCuratorLabel> &curatorLabels = m_world.getCuratorLabels();
+    const SyntheticCuratorLabel &curatorLabel = curatorLabels[m_curatorLabel];
+
+    switch(m_phase)
+    {
+    case PHASE_START:
+        makeEvent(event, VERB_ACTION_START_TASK, curatorLabel.id);
+        m_steps = 1 + random(kMaxWalk);
+        m_objective = 0;
+        m_phase = PHASE_WALK;
+        break;
+    case PHASE_WALK:
+        walk(event);
+        if(--m_steps <= 0)
+            m_phase = curatorLabel.objectives.isEmpty() ? PHASE_END_OBJECTIVE : PHASE_OBJECTIVES;
+        break;
+    case PHASE_OBJECTIVES:
+        makeEvent(event, VERB_ACTION_ATTEMPT, curatorLabel.objectives[m_objective]);
+        event.resultType = AnalyticsEvent::RESULT_STRING;
+
+        //a failed attempt is retried next time
+        if(random(kFailChance) == 0)
+            event.resultString = kName_Fail;
+        else
+        {
+            event.resultString = kName_Unlock;
+
+            if(++m_objective >= curatorLabel.objectives.size())
+                m_phase = PHASE_END_OBJECTIVE;
+            else
+            {
+                m_steps = 1 + random(kMaxWalk / 2);
+                m_phase = PHASE_WALK;
+            }
+        }
+        break;
+    case PHASE_END_OBJECTIVE:
+        makeEvent(event, VERB_ACTION_ATTEMPT, curatorLabel.endObjective);
+        event.resultType = AnalyticsEvent::RESULT_STRING;
+        event.resultString = kName_Unlock;
+        m_phase = PHASE_COMPLETE;
+        break;
+    case PHASE_COMPLETE:
+        makeEvent(event, VERB_ACTION_COMPLETE_TASK, curatorLabel.id);
+        m_curatorLabel = (m_curatorLabel + 1) % curatorLabels.size();
+        m_phase = PHASE_START;
+        break;
+    }
+}
+
+void SyntheticPlayer::walk(AnalyticsEvent &event)
+{
+    const QStringList &narrativeNodes = m_world.getNarrativeNodes();
+
+    if(!narrativeNodes.isEmpty() && random(kPickUpChance) == 0)
+    {
+        makeEvent(event, VERB_ACTION_INTERACTION, narrativeNodes[random(narrativeNodes.size())]);
+        return;
+    }
+
+    QStringList neighbours = m_world.getNeighbours(m_location);
+
+    //dead end, jump somewhere else
+    if(neighbours.isEmpty())
+        neighbours = m_world.getSpatialNodes();
+
+    if(!neighbours.isEmpty())
+        m_location = neighbours[random(neighbours.size())];
+
+    makeEvent(event, VERB_ACTION_LOCOMOTION, m_location);
+}
+
+void SyntheticPlayer::makeEvent(AnalyticsEvent &event, int verbAction, const QString &object)
+{
+    static const AnalyticsVerbTable verbs;
+
+    event.clear();
+
+    event.fields = AnalyticsEvent::FIELD_ACTOR | AnalyticsEvent::FIELD_VERB | AnalyticsEvent::FIELD_OBJECT | AnalyticsEvent::FIELD_TIMESTAMP;
+    event.actor = m_name;
+    event.verbId = verbs.getId(verbs.getNameOfAction(VerbAction(verbAction)));
+    event.verb = verbs.getName(event.verbId);
+    event.object = object;
+
+    //written as an ISO string from the decoded time when sent as JSON
+    event.time.msecs = QDateTime::currentMSecsSinceEpoch();
+    event.time.offsetSeconds = 0;
+    event.time.valid = true;
+
+    event.sequence = m_nextSequence++;
+}
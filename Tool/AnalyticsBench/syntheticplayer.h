@@ -0,0 +1,60 @@
+#ifndef SYNTHETICPLAYER_H
+#define SYNTHETICPLAYER_H
+
+#include <QString>
+
+#include "analyticsevent.h"
+
+class SyntheticWorld;
+
+///
+/// \brief Plays through every curator label of a SyntheticWorld, one event at a time.
+///
+/// Each label is started, walked to through the spatial graph with the odd object picked up on
+/// the way, its objectives attempted (some failing first) and completed. Once all labels are done
+/// the player starts again from the first, so it can emit for as long as the benchmark runs.
+/// Players with the same seed make the same events.
+///
+class SyntheticPlayer
+{
+public:
+    SyntheticPlayer(const SyntheticWorld &world, int index, quint32 seed);
+
+    ///
+    /// \brief Fill in the next event, timestamped now and numbered from 1
+    ///
+    void next(AnalyticsEvent &event);
+
+    const QString &getName() const {return m_name;}
+
+private:
+    enum Phase
+    {
+        PHASE_START,
+        PHASE_WALK,
+        PHASE_OBJECTIVES,
+        PHASE_END_OBJECTIVE,
+        PHASE_COMPLETE
+    };
+
+    quint32 random();
+    int random(int bound) {return bound > 0 ? int(random() % quint32(bound)) : 0;}
+
+    void makeEvent(AnalyticsEvent &event, int verbAction, const QString &object);
+    void walk(AnalyticsEvent &event);
+
+    const SyntheticWorld &m_world;
+    QString m_name;
+
+    quint32 m_state;    //xorshift32
+
+    int m_curatorLabel;
+    Phase m_phase;
+    int m_steps;        //left to walk before the objectives
+    int m_objective;
+    QString m_location;
+
+    qint64 m_nextSequence;
+};
+
+#endif // SYNTHETICPLAYER_H
@@ -0,0 +1,126 @@
+#include "syntheticworld.h"
+
+#include <QFile>
+#include <QDir>
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QDebug>
+
+static QJsonDocument readJson(const QString &fileName)
+{
+    QFile file(fileName);
+
+    if(!file.open(QIODevice::ReadOnly | QIODevice::Text))
+    {
+        qDebug() << "Could not open" << fileName;
+        return QJsonDocument();
+    }
+
+    return QJsonDocument::fromJson(file.readAll());
+}
+
+SyntheticWorld::SyntheticWorld()
+{
+
+}
+
+bool SyntheticWorld::loadTasks(const QString &fileName)
+{
+    QJsonDocument document = readJson(fileName);
+
+    if(!document.isArray())
+    {
+        qDebug() << fileName << "is not a task list";
+        return false;
+    }
+
+    foreach (const QJsonValue &value, document.array())
+    {
+        QJsonObject task = value.toObject();
+
+        if(!task["text_id"].isString())
+            continue;
+
+        SyntheticCuratorLabel curatorLabel;
+        curatorLabel.id = task["text_id"].toString();
+        curatorLabel.startObjective = task["begin_dep"].toString();
+        curatorLabel.endObjective = task["complete_dep"].toString();
+
+        foreach (const QJsonValue &dependency, task["narrative_deps"].toArray())
+            if(dependency.toObject()["narr_id"].isString())
+                curatorLabel.objectives.append(dependency.toObject()["narr_id"].toString());
+
+        m_curatorLabels.append(curatorLabel);
+    }
+
+    return !m_curatorLabels.isEmpty();
+}
+
+bool SyntheticWorld::loadNarrativeGraphs(const QString &directory)
+{
+    QDir dir(directory);
+
+    foreach (const QString &fileName, dir.entryList(QStringList("*.narrative.json"), QDir::Files, QDir::Name))
+    {
+        QJsonDocument document = readJson(dir.filePath(fileName));
+
+        foreach (const QJsonValue &value, document.array())
+            if(value.toObject()["id"].isString())
+                m_narrativeNodes.append(value.toObject()["id"].toString());
+    }
+
+    return !m_narrativeNodes.isEmpty();
+}
+
+bool SyntheticWorld::loadSpatialGraph(const QString &nodesFile, const QString &edgesFile)
+{
+    QJsonDocument nodes = readJson(nodesFile);
+    QJsonDocument edges = readJson(edgesFile);
+
+    if(!nodes.isArray() || !edges.isObject())
+    {
+        qDebug() << "Spatial graph files are not in the format the tool loads";
+        return false;
+    }
+
+    //players only walk between locomotion nodes
+    foreach (const QJsonValue &value, nodes.array())
+        if(value.toObject()["type"].toString() == "locomotion")
+            m_spatialNodes.append(value.toObject()["name"].toString());
+
+    foreach (const QJsonValue &value, edges.object()["edges"].toArray())
+    {
+        QJsonArray links = value.toObject()["links"].toArray();
+
+        if(links.size() == 2)
+            m_spatialEdges[links[0].toString()].append(links[1].toString());
+    }
+
+    return !m_spatialNodes.isEmpty();
+}
+
+void SyntheticWorld::makeGridGraph(int width)
+{
+    m_spatialNodes.clear();
+    m_spatialEdges.clear();
+
+    for(int y = 0; y < width; ++y)
+        for(int x = 0; x < width; ++x)
+            m_spatialNodes.append(QString("Loco_%1_%2").arg(x).arg(y));
+
+    for(int y = 0; y < width; ++y)
+        for(int x = 0; x < width; ++x)
+        {
+            QStringList &neighbours = m_spatialEdges[m_spatialNodes[y * width + x]];
+
+            if(x > 0)
+                neighbours.append(m_spatialNodes[y * width + x - 1]);
+            if(x + 1 < width)
+                neighbours.append(m_spatialNodes[y * width + x + 1]);
+            if(y > 0)
+                neighbours.append(m_spatialNodes[(y - 1) * width + x]);
+            if(y + 1 < width)
+                neighbours.append(m_spatialNodes[(y + 1) * width + x]);
+        }
+}
@@ -0,0 +1,51 @@
+#ifndef SYNTHETICWORLD_H
+#define SYNTHETICWORLD_H
+
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QHash>
+
+struct SyntheticCuratorLabel
+{
+    QString id;                 //text_id, what the tool calls the curator label
+    QString startObjective;     //begin_dep
+    QString endObjective;       //complete_dep
+    QStringList objectives;     //narr_id of the narrative dependencies
+};
+
+///
+/// \brief The game a synthetic player plays through, built from the files the tool is set up with.
+///
+/// Tasks come from tasks.json, the narrative nodes a player can unlock from gameplay_graph/*.narrative.json
+/// and the places they walk through from a spatial graph (the nodes and edges files loaded for lostness).
+/// Without a spatial graph a grid of locomotion nodes is made up, so the tool shouldn't have one loaded either.
+///
+class SyntheticWorld
+{
+public:
+    SyntheticWorld();
+
+    bool loadTasks(const QString &fileName);
+    bool loadNarrativeGraphs(const QString &directory);
+    bool loadSpatialGraph(const QString &nodesFile, const QString &edgesFile);
+
+    ///
+    /// \brief Spatial graph used when none is loaded, width x width locomotion nodes with 4-neighbour edges
+    ///
+    void makeGridGraph(int width);
+
+    const QList<SyntheticCuratorLabel> &getCuratorLabels() const {return m_curatorLabels;}
+    const QStringList &getNarrativeNodes() const {return m_narrativeNodes;}
+    const QStringList &getSpatialNodes() const {return m_spatialNodes;}
+    const QStringList getNeighbours(const QString &node) const {return m_spatialEdges.value(node);}
+
+private:
+    QList<SyntheticCuratorLabel> m_curatorLabels;
+    QStringList m_narrativeNodes;
+
+    QStringList m_spatialNodes;
+    QHash<QString, QStringList> m_spatialEdges;
+};
+
+#endif // SYNTHETICWORLD_H
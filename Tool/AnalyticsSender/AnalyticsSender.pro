@@ -0,0 +1,34 @@
+# =========================
+#
+#    Stand-in game for testing the analytics connection of the tool.
+#    Replays the events of a log file over TCP as JSON or binary (CBOR) events.
+#
+
+QT          += core network
+QT          -= gui
+CONFIG      += c++11 console
+CONFIG      -= app_bundle
+DEFINES     *= QT_USE_QSTRINGBUILDER
+
+TARGET = AnalyticsSender
+TEMPLATE = app
+
+#the event encoding is shared with the tool
+INCLUDEPATH += ../Source
+
+SOURCES += main.cpp \
+    analyticssender.cpp \
+    ../Source/analyticscbor.cpp \
+    ../Source/analyticsevent.cpp \
+    ../Source/analyticsframer.cpp \
+    ../Source/analyticsprotocol.cpp \
+    ../Source/analyticstimestamp.cpp \
+    ../Source/analyticsverbs.cpp
+
+HEADERS += analyticssender.h \
+    ../Source/analyticscbor.h \
+    ../Source/analyticsevent.h \
+    ../Source/analyticsframer.h \
+    ../Source/analyticsprotocol.h \
+    ../Source/analyticstimestamp.h \
+    ../Source/analyticsverbs.h
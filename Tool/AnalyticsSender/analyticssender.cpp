@@ -0,0 +1,237 @@
+#include "analyticssender.h"
+
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QFile>
+#include <QDebug>
+
+#include "analyticscbor.h"
+#include "analyticsprotocol.h"
+#include "analyticsverbs.h"
+
+static const int kHelloTimeout = 1000;  //ms
+
+AnalyticsSender::AnalyticsSender(const SenderOptions &options, QObject *parent)
+    : QObject(parent)
+    , m_options(options)
+    , m_server(nullptr)
+    , m_socket(nullptr)
+    , m_framer(options.framing)
+    , m_sending(false)
+    , m_binary(false)
+    , m_nextSequence(1)
+    , m_lastAck(-1)
+    , m_sentOnConnection(0)
+{
+    //an older tool sends no hello
+    m_helloTimer.setSingleShot(true);
+    m_helloTimer.setInterval(kHelloTimeout);
+    connect(&m_helloTimer, &QTimer::timeout, this, [=]{startSending(m_options.format == SEND_CBOR);});
+
+    m_sendTimer.setInterval(qMax(0, int(1000.0 / qMax(m_options.rate, 0.001))));
+    connect(&m_sendTimer, SIGNAL(timeout()), this, SLOT(sendNext()));
+}
+
+bool AnalyticsSender::start()
+{
+    if(!loadEvents())
+        return false;
+
+    if(m_options.listen)
+    {
+        m_server = new QTcpServer(this);
+        connect(m_server, SIGNAL(newConnection()), this, SLOT(newConnection()));
+
+        if(!m_server->listen(QHostAddress::Any, quint16(m_options.port)))
+        {
+            qDebug() << "Could not listen on port" << m_options.port << ":" << m_server->errorString();
+            return false;
+        }
+
+        qDebug() << "Waiting for the tool on port" << m_options.port;
+    }
+    else
+    {
+        QTcpSocket *socket = new QTcpSocket(this);
+        attachSocket(socket);
+        connect(socket, SIGNAL(connected()), this, SLOT(connected()));
+        socket->connectToHost(m_options.host, quint16(m_options.port));
+    }
+
+    return true;
+}
+
+bool AnalyticsSender::loadEvents()
+{
+    QFile file(m_options.file);
+
+    if(!file.open(QIODevice::ReadOnly))
+    {
+        qDebug() << "Could not open" << m_options.file;
+        return false;
+    }
+
+    QByteArray data = file.readAll();
+
+    AnalyticsVerbTable verbs;
+    AnalyticsEventParser parser(verbs);
+    AnalyticsEvent event;
+
+    parser.setData(data);
+
+    while(parser.next(event))
+        m_events.append(event);
+
+    if(parser.hasError() || m_events.isEmpty())
+    {
+        qDebug() << "No events could be read from" << m_options.file;
+        return false;
+    }
+
+    qint64 jsonBytes = 0;
+    qint64 cborBytes = 0;
+
+    foreach (const AnalyticsEvent &loaded, m_events)
+    {
+        jsonBytes += loaded.toJson().size();
+        cborBytes += AnalyticsCbor::encodeEvent(loaded).size();
+    }
+
+    qDebug() << "Loaded" << m_events.size() << "events," << jsonBytes << "bytes as JSON," << cborBytes << "bytes as CBOR";
+
+    return true;
+}
+
+void AnalyticsSender::newConnection()
+{
+    QTcpSocket *socket = m_server->nextPendingConnection();
+
+    if(m_socket)
+    {
+        qDebug() << "Already sending to the tool, refusing another connection";
+        socket->disconnectFromHost();
+        socket->deleteLater();
+        return;
+    }
+
+    attachSocket(socket);
+    connected();
+}
+
+void AnalyticsSender::attachSocket(QTcpSocket *socket)
+{
+    m_socket = socket;
+    m_framer.reset();
+
+    connect(m_socket, SIGNAL(disconnected()), this, SLOT(disconnected()));
+    connect(m_socket, SIGNAL(readyRead()), this, SLOT(readyRead()));
+}
+
+void AnalyticsSender::connected()
+{
+    qDebug() << "Connected to" << m_socket->peerAddress().toString();
+
+    m_sending = false;
+    m_sentOnConnection = 0;
+
+    //the hello says where to resume, even if the format is fixed
+    m_helloTimer.start();
+}
+
+void AnalyticsSender::disconnected()
+{
+    qDebug() << "Tool disconnected, last acknowledged event" << m_lastAck;
+
+    m_helloTimer.stop();
+    m_sendTimer.stop();
+
+    m_socket->deleteLater();
+    m_socket = nullptr;
+
+    if(!m_options.listen)
+        finished(0);
+}
+
+void AnalyticsSender::readyRead()
+{
+    m_framer.readFrom(m_socket);
+
+    QByteArray frame;
+    while(m_framer.nextFrame(frame))
+    {
+        bool offersBinary;
+        qint64 resumeAfter;
+
+        if(AnalyticsProtocol::readAck(frame, m_lastAck))
+            continue;
+
+        if(!m_sending && AnalyticsProtocol::readHello(frame, offersBinary, resumeAfter))
+        {
+            m_helloTimer.stop();
+
+            //no resume point means the tool started a new session
+            if(resumeAfter >= 0 && m_options.numberEvents)
+                qDebug() << "Tool resumes after event" << resumeAfter;
+
+            m_nextSequence = m_options.numberEvents ? qMax<qint64>(resumeAfter, 0) + 1 : 1;
+
+            startSending(m_options.format == SEND_CBOR || (m_options.format == SEND_AUTO && offersBinary));
+        }
+    }
+}
+
+void AnalyticsSender::startSending(bool binary)
+{
+    if(m_sending || !m_socket)
+        return;
+
+    m_sending = true;
+    m_binary = binary;
+
+    qDebug() << "Sending" << (binary ? "CBOR" : "JSON") << "events at" << m_options.rate << "per second from event" << m_nextSequence;
+
+    if(m_binary)
+        m_socket->write(AnalyticsProtocol::streamPreamble());
+
+    m_sendTimer.start();
+}
+
+void AnalyticsSender::sendNext()
+{
+    if(!m_socket)
+        return;
+
+    if(m_nextSequence > m_events.size() && !m_options.loop)
+    {
+        qDebug() << "All events sent";
+        m_sendTimer.stop();
+        m_socket->disconnectFromHost();
+        return;
+    }
+
+    if(m_options.dropAfter > 0 && m_sentOnConnection >= m_options.dropAfter)
+    {
+        qDebug() << "Dropping the connection after" << m_sentOnConnection << "events";
+        m_sendTimer.stop();
+        m_socket->abort();
+        return;
+    }
+
+    //a copy, the numbering goes on when looping
+    AnalyticsEvent event = m_events[int((m_nextSequence - 1) % m_events.size())];
+
+    event.sequence = m_options.numberEvents ? m_nextSequence : -1;
+
+    if(m_binary)
+        writeFrame(AnalyticsCbor::encodeEvent(event), FRAMING_LENGTH_PREFIXED);
+    else
+        writeFrame(event.toJson(), m_options.framing);
+
+    ++m_nextSequence;
+    ++m_sentOnConnection;
+}
+
+void AnalyticsSender::writeFrame(const QByteArray &payload, FramingMode framing)
+{
+    m_socket->write(AnalyticsProtocol::frame(payload, framing));
+}
@@ -0,0 +1,96 @@
+#ifndef ANALYTICSSENDER_H
+#define ANALYTICSSENDER_H
+
+#include <QObject>
+#include <QList>
+#include <QByteArray>
+#include <QString>
+#include <QTimer>
+
+#include "analyticsframer.h"
+#include "analyticsevent.h"
+
+class QTcpServer;
+class QTcpSocket;
+
+enum SenderFormat
+{
+    SEND_AUTO,      //CBOR if the tool offers it in its hello, JSON otherwise
+    SEND_JSON,
+    SEND_CBOR
+};
+
+struct SenderOptions
+{
+    SenderOptions()
+        : listen(true)
+        , port(0)
+        , rate(10)
+        , format(SEND_AUTO)
+        , framing(FRAMING_NEWLINE)
+        , loop(false)
+        , numberEvents(true)
+        , dropAfter(0)
+    {}
+
+    bool listen;        //wait for the tool to connect, like the games do
+    QString host;       //tool to connect to when it is listening for players
+    int port;
+    QString file;       //log file saved by the tool
+    double rate;        //events per second
+    SenderFormat format;
+    FramingMode framing;
+    bool loop;
+    bool numberEvents;  //send "seq" so the tool can resume, off behaves like an older game
+    int dropAfter;      //close the connection after this many events to test reconnecting, 0 never
+};
+
+///
+/// \brief Stand-in for a game: sends the events of a log file to the tool at a fixed rate.
+///
+/// Speaks the same handshake as the tool, so it can be used to check both the JSON and the
+/// binary (CBOR) event streams, and resumes after the event the tool names when it reconnects.
+///
+class AnalyticsSender : public QObject
+{
+    Q_OBJECT
+public:
+    explicit AnalyticsSender(const SenderOptions &options, QObject *parent = 0);
+
+    bool start();
+
+signals:
+    void finished(int exitCode);
+
+private slots:
+    void newConnection();
+    void connected();
+    void disconnected();
+    void readyRead();
+    void sendNext();
+
+private:
+    bool loadEvents();
+    void attachSocket(QTcpSocket *socket);
+    void startSending(bool binary);
+    void writeFrame(const QByteArray &payload, FramingMode framing);
+
+    SenderOptions m_options;
+
+    QList<AnalyticsEvent> m_events;
+
+    QTcpServer *m_server;
+    QTcpSocket *m_socket;
+    AnalyticsFramer m_framer;
+
+    QTimer m_helloTimer;    //how long to wait for the tool's hello before carrying on without one
+    QTimer m_sendTimer;
+
+    bool m_sending;
+    bool m_binary;
+    qint64 m_nextSequence;  //kept across connections, numbering starts at 1
+    qint64 m_lastAck;
+    int m_sentOnConnection;
+};
+
+#endif // ANALYTICSSENDER_H
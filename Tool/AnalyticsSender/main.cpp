@@ -0,0 +1,75 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDebug>
+
+#include "analyticssender.h"
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("AnalyticsSender");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Sends the events of an analytics log file to the tool, like a game would.");
+    parser.addHelpOption();
+    parser.addPositionalArgument("file", "Log file saved by the tool (JSON array of events).");
+
+    QCommandLineOption listenOption("listen", "Wait for the tool to connect on <port>.", "port");
+    QCommandLineOption connectOption("connect", "Connect to a tool listening for players at <host:port>.", "host:port");
+    QCommandLineOption rateOption("rate", "Events per second (default 10).", "rate", "10");
+    QCommandLineOption formatOption("format", "auto, json or cbor (default auto, uses CBOR if the tool offers it).", "format", "auto");
+    QCommandLineOption framingOption("framing", "newline or length, for JSON events (default newline).", "framing", "newline");
+    QCommandLineOption loopOption("loop", "Start again from the first event once all have been sent.");
+    QCommandLineOption noSequenceOption("no-sequence", "Don't number the events, like an older game (no resume after a reconnect).");
+    QCommandLineOption dropOption("drop-after", "Drop the connection after every <count> events, to test reconnecting.", "count", "0");
+
+    parser.addOptions({listenOption, connectOption, rateOption, formatOption, framingOption, loopOption, noSequenceOption, dropOption});
+    parser.process(app);
+
+    if(parser.positionalArguments().size() != 1 || parser.isSet(listenOption) == parser.isSet(connectOption))
+        parser.showHelp(1);
+
+    SenderOptions options;
+    options.file = parser.positionalArguments().first();
+    options.rate = parser.value(rateOption).toDouble();
+    options.loop = parser.isSet(loopOption);
+    options.numberEvents = !parser.isSet(noSequenceOption);
+    options.dropAfter = parser.value(dropOption).toInt();
+
+    if(parser.isSet(connectOption))
+    {
+        QString address = parser.value(connectOption);
+        int separator = address.lastIndexOf(':');
+
+        options.listen = false;
+        options.host = address.left(separator);
+        options.port = address.mid(separator + 1).toInt();
+    }
+    else
+        options.port = parser.value(listenOption).toInt();
+
+    QString format = parser.value(formatOption);
+
+    if(format == "json")
+        options.format = SEND_JSON;
+    else
+        if(format == "cbor")
+            options.format = SEND_CBOR;
+
+    if(parser.value(framingOption) == "length")
+        options.framing = FRAMING_LENGTH_PREFIXED;
+
+    if(options.port <= 0 || options.rate <= 0)
+    {
+        qDebug() << "Port and rate must be greater than 0";
+        return 1;
+    }
+
+    AnalyticsSender sender(options);
+    QObject::connect(&sender, &AnalyticsSender::finished, &app, &QCoreApplication::exit);
+
+    if(!sender.start())
+        return 1;
+
+    return app.exec();
+}
@@ -35,6 +35,20 @@ unix {
     QMAKE_CXX = ccache g++
 }
 
+# zlib is required, for compressing the analytics logs. It is found with pkg-config where there
+# is one, otherwise pass ZLIB_DIR=<directory with include and lib> to qmake if it is not on the paths
+CONFIG += link_pkgconfig
+packagesExist(zlib) {
+    PKGCONFIG += zlib
+} else {
+    !isEmpty(ZLIB_DIR) {
+        INCLUDEPATH += $$ZLIB_DIR/include
+        LIBS += -L$$ZLIB_DIR/lib
+    }
+    win32: LIBS += -lzlib
+    else: LIBS += -lz
+}
+
 TARGET = ZodiacGraph_Showcase
 TEMPLATE = app
 
@@ -74,12 +88,38 @@ SOURCES += main.cpp\
     analyticslogwindow.cpp \
     linkerwindow.cpp \
     analyticssocket.cpp \
+    analyticsframer.cpp \
+    analyticsconnectdialog.cpp \
+    analyticssession.cpp \
+    analyticsverbs.cpp \
+    analyticsevent.cpp \
+    analyticstimestamp.cpp \
+    analyticsingestworker.cpp \
+    analyticsserver.cpp \
+    analyticssessionsummary.cpp \
+    analyticsupdatecoalescer.cpp \
+    analyticscbor.cpp \
+    analyticsprotocol.cpp \
+    analyticslatencyprobe.cpp \
+    analyticslogwriter.cpp \
+    analyticssegmentedlog.cpp \
+    analyticslogcompression.cpp \
+    analyticslogmodel.cpp \
+    analyticslogindex.cpp \
+    analyticslogfilterbar.cpp \
+    analyticslogreader.cpp \
+    analyticsreplaytimeline.cpp \
+    analyticsbatchrescorer.cpp \
+    analyticscolumnarlog.cpp \
     analyticshandler.cpp \
     curatoranalyticseditor.cpp \
     analyticsproperties.cpp \
     narrativefilesorter.cpp \
     lostness.cpp \
-    lostnessgraph.cpp
+    lostnessgraph.cpp \
+    lostnessseries.cpp \
+    spatialgraph.cpp \
+    spatialdistancetable.cpp
 
 HEADERS  += mainwindow.h \
     collapsible.h \
@@ -117,12 +157,39 @@ HEADERS  += mainwindow.h \
     analyticslogwindow.h \
     linkerwindow.h \
     analyticssocket.h \
+    analyticsframer.h \
+    analyticsconnectdialog.h \
+    analyticsdelta.h \
+    analyticssession.h \
+    analyticsverbs.h \
+    analyticsevent.h \
+    analyticstimestamp.h \
+    analyticsingestworker.h \
+    analyticsserver.h \
+    analyticssessionsummary.h \
+    analyticsupdatecoalescer.h \
+    analyticscbor.h \
+    analyticsprotocol.h \
+    analyticslatencyprobe.h \
+    analyticslogwriter.h \
+    analyticssegmentedlog.h \
+    analyticslogcompression.h \
+    analyticslogmodel.h \
+    analyticslogindex.h \
+    analyticslogfilterbar.h \
+    analyticslogreader.h \
+    analyticsreplaytimeline.h \
+    analyticsbatchrescorer.h \
+    analyticscolumnarlog.h \
     analyticshandler.h \
     curatoranalyticseditor.h \
     analyticsproperties.h \
     narrativefilesorter.h \
     lostness.h \
-    lostnessgraph.h
+    lostnessgraph.h \
+    lostnessseries.h \
+    spatialgraph.h \
+    spatialdistancetable.h
 
 RESOURCES += \
     res/icons.qrc
@@ -0,0 +1,440 @@
+#include "analyticsbatchrescorer.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QRunnable>
+#include <QThreadPool>
+#include <QThread>
+#include <QAtomicInt>
+#include <QTextStream>
+#include <QMap>
+#include <QHash>
+#include <QPair>
+#include <QDebug>
+
+#include "curatoranalyticseditor.h"
+#include "analyticslogreader.h"
+#include "analyticssegmentedlog.h"
+#include "analyticscolumnarlog.h"
+
+static const int kWriteBatch = 2000;    //events re-scored before they are written out
+
+static const QString kName_Summary = "summary.csv";
+
+class AnalyticsBatchRescorer::Task : public QRunnable
+{
+public:
+    Task(const AnalyticsBatchRescorer &rescorer, const QString &logFile, const QString &outputFile, LogResult *result, QAtomicInt *numDone, int numLogs)
+        : m_rescorer(rescorer)
+        , m_logFile(logFile)
+        , m_outputFile(outputFile)
+        , m_result(result)
+        , m_numDone(numDone)
+        , m_numLogs(numLogs)
+    {}
+
+    void run() override
+    {
+        //each task has its own slot, so nothing is shared but the read-only graph and labels
+        *m_result = m_rescorer.rescore(m_logFile, m_outputFile);
+
+        int numDone = m_numDone->fetchAndAddRelaxed(1) + 1;
+
+        if(m_result->error.isEmpty())
+            qDebug().noquote() << QString("[%1/%2]").arg(numDone).arg(m_numLogs) << m_logFile << "-" << m_result->numEvents << "events";
+        else
+            qDebug().noquote() << QString("[%1/%2]").arg(numDone).arg(m_numLogs) << m_logFile << "-" << m_result->error;
+    }
+
+private:
+    const AnalyticsBatchRescorer &m_rescorer;
+    QString m_logFile;
+    QString m_outputFile;
+    LogResult *m_result;
+    QAtomicInt *m_numDone;
+    int m_numLogs;
+};
+
+AnalyticsBatchRescorer::AnalyticsBatchRescorer()
+    : m_lostness(new Lostness)
+    , m_columnarExport(false)
+{
+    m_config.lostnessHandler = m_lostness;
+}
+
+bool AnalyticsBatchRescorer::loadSpatialGraph(const QString &fileName, QString &error)
+{
+    return m_lostness->loadEdges(fileName, error);
+}
+
+bool AnalyticsBatchRescorer::loadCuratorLabels(const QString &fileName, QString &error)
+{
+    if(!CuratorAnalyticsEditor::readCuratorLabels(fileName, m_config.curatorLabels, error))
+        return false;
+
+    if(m_config.curatorLabels.isEmpty())
+    {
+        error = "No curator labels found in the file.";
+        return false;
+    }
+
+    return true;
+}
+
+QStringList AnalyticsBatchRescorer::findLogs(const QString &directory)
+{
+    QDir dir(directory);
+    QStringList logs;
+
+    foreach (const QFileInfo &file, dir.entryInfoList(QStringList() << "*.json", QDir::Files, QDir::Name))
+        logs.append(file.filePath());
+
+    //a segmented log is opened through any of its segments, journals are replays that never finished
+    foreach (const QFileInfo &subDirectory, dir.entryInfoList(QDir::Dirs | QDir::NoDotAndDotDot, QDir::Name))
+    {
+        if(subDirectory.fileName().endsWith(".journal"))
+            continue;
+
+        QStringList segments = AnalyticsSegmentedLog::segmentFiles(subDirectory.filePath());
+
+        if(!segments.isEmpty())
+            logs.append(segments.first());
+    }
+
+    return logs;
+}
+
+QString AnalyticsBatchRescorer::outputNameOf(const QString &logFile)
+{
+    //segmented logs are saved as a JSON array named after their directory, as when replayed in the tool
+    if(AnalyticsSegmentedLog::isSegmentFile(logFile))
+        return QFileInfo(QFileInfo(logFile).path()).fileName() + ".json";
+
+    return QFileInfo(logFile).fileName();
+}
+
+int AnalyticsBatchRescorer::run(const QString &logDirectory, const QString &outputDirectory)
+{
+    if(!QDir(logDirectory).exists())
+    {
+        qDebug() << "Log directory" << logDirectory << "not found";
+        return -1;
+    }
+
+    if(QFileInfo(logDirectory).canonicalFilePath() == QFileInfo(outputDirectory).canonicalFilePath())
+    {
+        qDebug() << "The output directory must not be the log directory, the logs would be overwritten";
+        return -1;
+    }
+
+    if(!QDir().mkpath(outputDirectory))
+    {
+        qDebug() << "Could not create" << outputDirectory;
+        return -1;
+    }
+
+    QStringList logs = findLogs(logDirectory);
+
+    if(logs.isEmpty())
+    {
+        qDebug() << "No logs found in" << logDirectory;
+        return -1;
+    }
+
+    QVector<LogResult> results(logs.size());
+    QAtomicInt numDone(0);
+    QThreadPool pool;
+    QDir output(outputDirectory);
+
+    pool.setMaxThreadCount(qMax(1, QThread::idealThreadCount()));
+
+    for(int i = 0; i < logs.size(); ++i)
+        pool.start(new Task(*this, logs[i], output.filePath(outputNameOf(logs[i])), &results[i], &numDone, logs.size()));
+
+    pool.waitForDone();
+
+    int numFailed = 0;
+
+    foreach (const LogResult &result, results)
+        if(!result.error.isEmpty())
+            ++numFailed;
+
+    if(!writeSummary(output.filePath(kName_Summary), results))
+        return -1;
+
+    return numFailed;
+}
+
+AnalyticsBatchRescorer::LogResult AnalyticsBatchRescorer::rescore(const QString &logFile, const QString &outputFile) const
+{
+    LogResult result;
+    result.logFile = logFile;
+
+    AnalyticsSession session;
+    session.configure(m_config);
+    session.setFirstNode(m_startNode);
+
+    AnalyticsLogReader reader(m_config.verbs);
+
+    if(!reader.open(logFile))
+    {
+        result.error = "could not be opened";
+        return result;
+    }
+
+    QFile output(outputFile);
+
+    if(!output.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text))
+    {
+        result.error = "could not write " + outputFile;
+        return result;
+    }
+
+    //written the same way as a log saved by the tool
+    AnalyticsDelta delta;
+    AnalyticsEvent event;
+    bool first = true;
+
+    //the columns are built from the re-scored events, not the ones read
+    AnalyticsColumnarWriter columns;
+    AnalyticsEventParser parser(m_config.verbs);
+    AnalyticsEvent rescoredEvent;
+    QString columnFile = AnalyticsColumnarLog::fileNameFor(outputFile);
+
+    output.write("[\n");
+
+    while(true)
+    {
+        bool more = reader.next(event);
+
+        if(more)
+        {
+            session.replayEvent(event, true, delta);
+            ++result.numEvents;
+        }
+
+        if(delta.logEvents.size() >= kWriteBatch || !more)
+        {
+            foreach (const QByteArray &logEvent, delta.logEvents)
+            {
+                if(!first)
+                    output.write(",\n");
+
+                output.write(logEvent);
+                first = false;
+
+                if(m_columnarExport)
+                {
+                    parser.setData(logEvent);
+
+                    if(parser.next(rescoredEvent))
+                        columns.append(rescoredEvent);
+                }
+            }
+
+            result.summary.apply(delta);
+            delta = AnalyticsDelta();
+        }
+
+        if(!more)
+            break;
+    }
+
+    output.write(first ? "]\n" : "\n]\n");
+
+    if(reader.hasError())
+        result.error = "malformed after " + QString::number(result.numEvents) + " events";
+    else
+        if(output.error() != QFile::NoError)
+            result.error = "could not write " + outputFile;
+
+    if(result.error.isEmpty() && m_columnarExport && !columns.write(columnFile))
+        result.error = "could not write " + columnFile;
+
+    //a partly re-scored log must not be mistaken for a whole one
+    if(!result.error.isEmpty())
+    {
+        output.remove();
+        QFile::remove(columnFile);
+    }
+
+    return result;
+}
+
+static QString csvField(const QString &value)
+{
+    if(!value.contains(',') && !value.contains('"') && !value.contains('\n'))
+        return value;
+
+    return "\"" + QString(value).replace("\"", "\"\"") + "\"";
+}
+
+static QString csvNumber(float value, bool valid)
+{
+    return valid ? QString::number(value) : QString();
+}
+
+namespace
+{
+    struct LostnessTotal
+    {
+        LostnessTotal() : count(0), sum(0), min(0), max(0) {}
+
+        void add(double lostness)
+        {
+            min = count == 0 ? lostness : qMin(min, lostness);
+            max = count == 0 ? lostness : qMax(max, lostness);
+            sum += lostness;
+            ++count;
+        }
+
+        void add(const LostnessTotal &other)
+        {
+            if(other.count == 0)
+                return;
+
+            min = count == 0 ? other.min : qMin(min, other.min);
+            max = count == 0 ? other.max : qMax(max, other.max);
+            sum += other.sum;
+            count += other.count;
+        }
+
+        qint64 count;
+        double sum;
+        double min;
+        double max;
+    };
+}
+
+bool AnalyticsBatchRescorer::aggregate(const QString &columnDirectory, const QString &csvFile)
+{
+    using namespace AnalyticsColumnarLog;
+
+    QDir dir(columnDirectory);
+    QFileInfoList files = dir.entryInfoList(QStringList() << "*.ssdcol", QDir::Files, QDir::Name);
+
+    if(files.isEmpty())
+    {
+        qDebug() << "No columnar logs found in" << columnDirectory;
+        return false;
+    }
+
+    QMap<QPair<QString, QString>, LostnessTotal> totals;   //by curator label and objective
+    int numSkipped = 0;
+
+    foreach (const QFileInfo &file, files)
+    {
+        AnalyticsColumnarReader reader;
+
+        if(!reader.open(file.filePath()))
+        {
+            ++numSkipped;
+            continue;
+        }
+
+        //sessions that never found an objective are skipped on their stats alone
+        if(reader.getStats(COLUMN_CURATOR_LABEL).numValid == 0 || reader.getStats(COLUMN_LOSTNESS).numValid == 0)
+            continue;
+
+        const qint32 *curatorLabels = reader.getInt32Column(COLUMN_CURATOR_LABEL);
+        const qint32 *objects = reader.getInt32Column(COLUMN_OBJECT);
+        const float *lostness = reader.getFloatColumn(COLUMN_LOSTNESS);
+
+        if(!curatorLabels || !objects || !lostness)
+        {
+            ++numSkipped;
+            continue;
+        }
+
+        //totalled by code first, only the few distinct pairs are looked up as strings
+        QHash<quint64, LostnessTotal> fileTotals;
+        qint64 numRows = reader.getNumRows();
+
+        for(qint64 i = 0; i < numRows; ++i)
+            if(curatorLabels[i] >= 0 && lostness[i] >= 0)
+                fileTotals[(quint64(quint32(curatorLabels[i])) << 32) | quint32(objects[i])].add(lostness[i]);
+
+        QStringList curatorLabelNames = reader.getDictionary(COLUMN_CURATOR_LABEL);
+        QStringList objectNames = reader.getDictionary(COLUMN_OBJECT);
+
+        for(QHash<quint64, LostnessTotal>::const_iterator it = fileTotals.constBegin(); it != fileTotals.constEnd(); ++it)
+        {
+            int curatorLabel = int(it.key() >> 32);
+            int object = int(it.key() & 0xffffffff);
+
+            if(curatorLabel < curatorLabelNames.size() && object < objectNames.size())
+                totals[qMakePair(curatorLabelNames[curatorLabel], objectNames[object])].add(it.value());
+        }
+    }
+
+    if(numSkipped > 0)
+        qDebug() << numSkipped << "columnar logs could not be read";
+
+    QFile output(csvFile);
+
+    if(!output.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text))
+    {
+        qDebug() << "Could not write" << csvFile;
+        return false;
+    }
+
+    QTextStream out(&output);
+
+    out << "curator label,objective,found,mean lostness,min lostness,max lostness\n";
+
+    for(QMap<QPair<QString, QString>, LostnessTotal>::const_iterator it = totals.constBegin(); it != totals.constEnd(); ++it)
+    {
+        const LostnessTotal &total = it.value();
+
+        out << csvField(it.key().first) << "," << csvField(it.key().second) << "," << total.count << ","
+            << total.sum / total.count << "," << total.min << "," << total.max << "\n";
+    }
+
+    out.flush();
+
+    return output.error() == QFile::NoError;
+}
+
+bool AnalyticsBatchRescorer::writeSummary(const QString &fileName, const QVector<LogResult> &results) const
+{
+    QFile file(fileName);
+
+    if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text))
+    {
+        qDebug() << "Could not write" << fileName;
+        return false;
+    }
+
+    QTextStream out(&file);
+
+    out << "log,events,game progress,game lostness";
+
+    foreach (const CuratorLabelDefinition &curatorLabel, m_config.curatorLabels)
+        out << "," << csvField(curatorLabel.id + " progress") << "," << csvField(curatorLabel.id + " lostness");
+
+    out << ",error\n";
+
+    foreach (const LogResult &result, results)
+    {
+        const AnalyticsSessionSummary &summary = result.summary;
+
+        out << csvField(result.logFile) << "," << result.numEvents << ","
+            << csvNumber(summary.gameProgress, summary.hasGameValues) << "," << csvNumber(summary.localLostness, summary.hasGameValues);
+
+        //lostness below zero couldn't be calculated, left empty like a label that was never reached
+        foreach (const CuratorLabelDefinition &curatorLabel, m_config.curatorLabels)
+        {
+            float lostness = summary.curatorLabelLostness.value(curatorLabel.id, -1);
+
+            out << "," << csvNumber(summary.curatorLabelProgress.value(curatorLabel.id), summary.curatorLabelProgress.contains(curatorLabel.id))
+                << "," << csvNumber(lostness, lostness >= 0);
+        }
+
+        out << "," << csvField(result.error) << "\n";
+    }
+
+    out.flush();
+
+    return file.error() == QFile::NoError;
+}
@@ -0,0 +1,71 @@
+#ifndef ANALYTICSBATCHRESCORER_H
+#define ANALYTICSBATCHRESCORER_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include "analyticssession.h"
+#include "analyticssessionsummary.h"
+#include "lostness.h"
+
+///
+/// \brief Re-scores a directory of saved logs without the GUI, one log per core at a time.
+///
+/// Every log is replayed through its own AnalyticsSession with the lostness worked out by the
+/// tool, the same as loading a log and choosing to update its lostness values. The re-scored logs
+/// are written to the output directory together with summary.csv, one row per log, and can also
+/// be exported as columnar logs for aggregate() to query.
+///
+class AnalyticsBatchRescorer
+{
+public:
+    AnalyticsBatchRescorer();
+
+    bool loadSpatialGraph(const QString &fileName, QString &error);
+    bool loadCuratorLabels(const QString &fileName, QString &error);
+    void setVerbs(const AnalyticsVerbTable &verbs){m_config.verbs = verbs;}
+    void setStartNode(const QString &node){m_startNode = node;}
+    void setColumnarExport(bool enabled){m_columnarExport = enabled;}
+    void setGraphCacheDirectory(const QString &directory){m_lostness->setCacheDirectory(directory);}
+
+    ///
+    /// \brief Re-score every log in the directory, returns the number that failed or -1 if nothing could be done
+    ///
+    int run(const QString &logDirectory, const QString &outputDirectory);
+
+    ///
+    /// \brief JSON log files and segmented log directories directly inside the directory
+    ///
+    static QStringList findLogs(const QString &directory);
+
+    ///
+    /// \brief Average lostness of every objective of every curator label over the columnar logs in a directory, written as CSV
+    ///
+    static bool aggregate(const QString &columnDirectory, const QString &csvFile);
+
+private:
+    struct LogResult
+    {
+        LogResult() : numEvents(0) {}
+
+        QString logFile;
+        qint64 numEvents;
+        AnalyticsSessionSummary summary;
+        QString error;
+    };
+
+    class Task;
+
+    LogResult rescore(const QString &logFile, const QString &outputFile) const;
+    bool writeSummary(const QString &fileName, const QVector<LogResult> &results) const;
+
+    static QString outputNameOf(const QString &logFile);
+
+    QSharedPointer<Lostness> m_lostness;
+    AnalyticsSessionConfig m_config;
+    QString m_startNode;
+    bool m_columnarExport;
+};
+
+#endif // ANALYTICSBATCHRESCORER_H
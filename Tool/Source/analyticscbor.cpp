@@ -0,0 +1,341 @@
+#include "analyticscbor.h"
+
+#include <QCborStreamReader>
+#include <QCborStreamWriter>
+#include <QCborValue>
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QDebug>
+
+#include "analyticsverbs.h"
+
+static bool readString(QCborStreamReader &reader, QString &value)
+{
+    if(!reader.isString())
+        return false;
+
+    value.clear();
+
+    //strings can be split into chunks by the sender
+    QCborStreamReader::StringResult<QString> chunk = reader.readString();
+
+    while(chunk.status == QCborStreamReader::Ok)
+    {
+        value += chunk.data;
+        chunk = reader.readString();
+    }
+
+    return chunk.status == QCborStreamReader::EndOfString;
+}
+
+static bool readNumber(QCborStreamReader &reader, double &value)
+{
+    if(reader.isInteger())
+        value = double(reader.toInteger());
+    else
+        if(reader.isDouble())
+            value = reader.toDouble();
+        else
+            if(reader.isFloat())
+                value = reader.toFloat();
+            else
+                if(reader.isFloat16())
+                    value = float(reader.toFloat16());
+                else
+                    return false;
+
+    return reader.next();
+}
+
+static QByteArray toJsonText(const QCborValue &value)
+{
+    //QJsonDocument only writes arrays and objects, so wrap the value and strip the brackets again
+    QByteArray json = QJsonDocument(QJsonArray() << value.toJsonValue()).toJson(QJsonDocument::Compact);
+    return json.mid(1, json.size() - 2);
+}
+
+static QCborValue fromJsonText(const QByteArray &json)
+{
+    QByteArray wrapped;
+    wrapped.reserve(json.size() + 2);
+    wrapped += '[';
+    wrapped += json;
+    wrapped += ']';
+
+    QJsonArray array = QJsonDocument::fromJson(wrapped).array();
+    return array.isEmpty() ? QCborValue() : QCborValue::fromJsonValue(array.first());
+}
+
+static void writeNumber(QCborStreamWriter &writer, double value)
+{
+    //whole numbers (ids, counts) take fewer bytes as integers
+    if(value == double(qint64(value)) && qAbs(value) < 9007199254740992.0)
+        writer.append(qint64(value));
+    else
+        writer.append(value);
+}
+
+static bool decodeResult(const QByteArray &frame, QCborStreamReader &reader, AnalyticsEvent &event)
+{
+    if(reader.isString())
+    {
+        event.resultType = AnalyticsEvent::RESULT_STRING;
+        return readString(reader, event.resultString);
+    }
+
+    qint64 begin = reader.currentOffset();
+
+    if(reader.isMap())
+    {
+        //try the flat map of strings and numbers the games send
+        event.resultType = AnalyticsEvent::RESULT_FIELDS;
+
+        if(!reader.enterContainer())
+            return false;
+
+        bool flat = true;
+
+        while(reader.hasNext())
+        {
+            AnalyticsResultField field;
+
+            if(!readString(reader, field.key))
+            {
+                flat = false;
+                break;
+            }
+
+            if(reader.isString())
+            {
+                field.isString = true;
+                if(!readString(reader, field.string))
+                    return false;
+            }
+            else
+                if(!readNumber(reader, field.number))
+                {
+                    flat = false;
+                    break;
+                }
+
+            event.resultFields.append(field);
+        }
+
+        if(flat)
+            return reader.leaveContainer();
+
+        //skip the rest of the map, it is decoded again below
+        while(reader.hasNext())
+            if(!reader.next())
+                return false;
+
+        if(!reader.leaveContainer())
+            return false;
+
+        event.resultFields.clear();
+
+        QCborStreamReader generic(QByteArray::fromRawData(frame.constData() + begin, frame.size() - int(begin)));
+        QCborValue value = QCborValue::fromCbor(generic);
+
+        event.resultType = AnalyticsEvent::RESULT_GENERIC;
+        event.resultJson = toJsonText(value);
+        event.genericResult = value.toJsonValue().toObject();
+
+        return generic.lastError() == QCborError::NoError;
+    }
+
+    //unknown payload, convert to JSON for the log
+    QCborValue value = QCborValue::fromCbor(reader);
+
+    event.resultType = AnalyticsEvent::RESULT_GENERIC;
+    event.resultJson = toJsonText(value);
+
+    return reader.lastError() == QCborError::NoError;
+}
+
+bool AnalyticsCbor::decodeEvent(const QByteArray &frame, const AnalyticsVerbTable &verbs, AnalyticsEvent &event)
+{
+    event.clear();
+
+    QCborStreamReader reader(frame);
+
+    if(!reader.isMap() || !reader.enterContainer())
+        return false;
+
+    while(reader.hasNext())
+    {
+        if(reader.isUnsignedInteger())
+        {
+            quint64 key = reader.toUnsignedInteger();
+
+            if(!reader.next())
+                return false;
+
+            switch(key)
+            {
+            case CBOR_KEY_ACTOR:
+                if(!readString(reader, event.actor))
+                    return false;
+                event.fields |= AnalyticsEvent::FIELD_ACTOR;
+                break;
+            case CBOR_KEY_VERB:
+                if(!readString(reader, event.verb))
+                    return false;
+                event.verbId = verbs.getId(event.verb);
+                event.fields |= AnalyticsEvent::FIELD_VERB;
+                break;
+            case CBOR_KEY_OBJECT:
+                if(!readString(reader, event.object))
+                    return false;
+                event.fields |= AnalyticsEvent::FIELD_OBJECT;
+                break;
+            case CBOR_KEY_TIMESTAMP:
+                if(reader.isInteger())
+                {
+                    //already decoded by the game, the ISO string is only built if the event is logged
+                    event.time.msecs = reader.toInteger();
+                    event.time.valid = true;
+                    if(!reader.next())
+                        return false;
+                }
+                else
+                {
+                    if(!readString(reader, event.timestamp))
+                        return false;
+                    event.time = AnalyticsTimestamp::fromIsoString(event.timestamp);
+                }
+                event.fields |= AnalyticsEvent::FIELD_TIMESTAMP;
+                break;
+            case CBOR_KEY_RESULT:
+                if(!decodeResult(frame, reader, event))
+                    return false;
+                break;
+            case CBOR_KEY_LOSTNESS:
+                if(!readNumber(reader, event.lostness))
+                    return false;
+                event.hasLostness = true;
+                break;
+            case CBOR_KEY_SEQUENCE:
+                if(!reader.isInteger())
+                    return false;
+                event.sequence = reader.toInteger();
+                if(!reader.next())
+                    return false;
+                break;
+            default:
+                if(!reader.next())  //key from a newer game build
+                    return false;
+            }
+        }
+        else
+        {
+            //keys the tool doesn't use are kept for the log
+            QString key;
+            if(!readString(reader, key))
+                return false;
+
+            QCborValue value = QCborValue::fromCbor(reader);
+
+            if(reader.lastError() != QCborError::NoError)
+                return false;
+
+            QByteArray keyJson = toJsonText(QCborValue(key));
+            event.extraFields.append(qMakePair(keyJson.mid(1, keyJson.size() - 2), toJsonText(value)));
+        }
+    }
+
+    return reader.leaveContainer() && reader.lastError() == QCborError::NoError;
+}
+
+QByteArray AnalyticsCbor::encodeEvent(const AnalyticsEvent &event)
+{
+    QByteArray out;
+    QCborStreamWriter writer(&out);
+
+    writer.startMap();
+
+    if(event.fields & AnalyticsEvent::FIELD_ACTOR)
+    {
+        writer.append(qint64(CBOR_KEY_ACTOR));
+        writer.append(event.actor);
+    }
+
+    if(event.fields & AnalyticsEvent::FIELD_VERB)
+    {
+        writer.append(qint64(CBOR_KEY_VERB));
+        writer.append(event.verb);
+    }
+
+    if(event.fields & AnalyticsEvent::FIELD_OBJECT)
+    {
+        writer.append(qint64(CBOR_KEY_OBJECT));
+        writer.append(event.object);
+    }
+
+    if(event.fields & AnalyticsEvent::FIELD_TIMESTAMP)
+    {
+        writer.append(qint64(CBOR_KEY_TIMESTAMP));
+
+        //an integer can't keep a local time or UTC offset, send those as they were
+        if(event.time.valid && event.time.timeSpec == Qt::UTC)
+            writer.append(event.time.msecs);
+        else
+            writer.append(event.timestamp);
+    }
+
+    if(event.resultType != AnalyticsEvent::RESULT_NONE)
+    {
+        writer.append(qint64(CBOR_KEY_RESULT));
+
+        if(event.resultType == AnalyticsEvent::RESULT_STRING)
+            writer.append(event.resultString);
+        else
+            if(event.resultType == AnalyticsEvent::RESULT_FIELDS)
+            {
+                writer.startMap(event.resultFields.size());
+
+                foreach (const AnalyticsResultField &field, event.resultFields)
+                {
+                    writer.append(field.key);
+
+                    if(field.isString)
+                        writer.append(field.string);
+                    else
+                        writeNumber(writer, field.number);
+                }
+
+                writer.endMap();
+            }
+            else
+                fromJsonText(event.resultJson).toCbor(writer);
+    }
+
+    if(event.hasLostness)
+    {
+        writer.append(qint64(CBOR_KEY_LOSTNESS));
+        writer.append(event.lostness);
+    }
+
+    if(event.sequence >= 0)
+    {
+        writer.append(qint64(CBOR_KEY_SEQUENCE));
+        writer.append(event.sequence);
+    }
+
+    for(int i = 0; i < event.extraFields.size(); ++i)
+    {
+        //raw keys are JSON string contents, let the JSON parser undo any escapes
+        QByteArray quotedKey;
+        quotedKey += '"';
+        quotedKey += event.extraFields[i].first;
+        quotedKey += '"';
+
+        writer.append(fromJsonText(quotedKey).toString());
+        fromJsonText(event.extraFields[i].second).toCbor(writer);
+    }
+
+    writer.endMap();
+
+    return out;
+}
@@ -0,0 +1,40 @@
+#ifndef ANALYTICSCBOR_H
+#define ANALYTICSCBOR_H
+
+#include <QByteArray>
+
+#include "analyticsevent.h"
+
+class AnalyticsVerbTable;
+
+///
+/// \brief Integer keys of the fixed xAPI fields in a binary event, any other key is sent as a text string
+///
+enum CborEventKey
+{
+    CBOR_KEY_ACTOR = 0,
+    CBOR_KEY_VERB = 1,
+    CBOR_KEY_OBJECT = 2,
+    CBOR_KEY_TIMESTAMP = 3,     //milliseconds since the epoch (UTC), or the ISO string as sent by older encoders
+    CBOR_KEY_RESULT = 4,
+    CBOR_KEY_LOSTNESS = 5,
+    CBOR_KEY_SEQUENCE = 6
+};
+
+///
+/// \brief Compact binary (CBOR) encoding of analytics events.
+///
+/// Only used once the game has chosen the binary format, see AnalyticsProtocol for the handshake.
+///
+class AnalyticsCbor
+{
+public:
+    ///
+    /// \brief Decode one binary event, returns false if the frame is not a well-formed event map
+    ///
+    static bool decodeEvent(const QByteArray &frame, const AnalyticsVerbTable &verbs, AnalyticsEvent &event);
+
+    static QByteArray encodeEvent(const AnalyticsEvent &event);
+};
+
+#endif // ANALYTICSCBOR_H
@@ -0,0 +1,374 @@
+#include "analyticscolumnarlog.h"
+
+#include <QDataStream>
+#include <QFileInfo>
+#include <QDir>
+#include <QDebug>
+
+static const quint32 kMagic = 0x53534443;   //"SSDC", the last 4 bytes of the file
+static const quint32 kVersion = 1;
+static const int kTrailerSize = 12;         //footer offset and magic
+static const int kAlignment = 8;            //every block starts on this, so the mapped columns can be read as arrays
+
+static const QString kFileSuffix = ".ssdcol";
+
+//column data is written in the byte order of the machine, a reader on another byte order refuses the file
+static const quint8 kLittleEndian = Q_BYTE_ORDER == Q_LITTLE_ENDIAN ? 1 : 0;
+
+using namespace AnalyticsColumnarLog;
+
+AnalyticsColumnarLog::Type AnalyticsColumnarLog::typeOf(Column column)
+{
+    switch(column)
+    {
+    case COLUMN_TIME:
+        return TYPE_INT64;
+    case COLUMN_LOSTNESS:
+        return TYPE_FLOAT32;
+    default:
+        return TYPE_INT32;
+    }
+}
+
+bool AnalyticsColumnarLog::isDictionaryEncoded(Column column)
+{
+    return column == COLUMN_ACTOR || column == COLUMN_VERB || column == COLUMN_OBJECT || column == COLUMN_CURATOR_LABEL;
+}
+
+QString AnalyticsColumnarLog::fileNameFor(const QString &logFile)
+{
+    QFileInfo info(logFile);
+    return QDir(info.path()).filePath(info.completeBaseName() + kFileSuffix);
+}
+
+static qint64 sizeOfType(quint32 type)
+{
+    return type == TYPE_INT64 ? 8 : 4;
+}
+
+static bool writePadded(QFile &file, const QByteArray &data, qint64 &position)
+{
+    qint64 padding = (kAlignment - data.size() % kAlignment) % kAlignment;
+
+    if(file.write(data) != data.size() || file.write(QByteArray(int(padding), '\0')) != padding)
+        return false;
+
+    position += data.size() + padding;
+    return true;
+}
+
+AnalyticsColumnarWriter::AnalyticsColumnarWriter()
+    : m_numRows(0)
+{
+}
+
+void AnalyticsColumnarWriter::clear()
+{
+    for(int i = 0; i < COLUMN_COUNT; ++i)
+        m_columns[i] = ColumnBuffer();
+
+    m_numRows = 0;
+}
+
+void AnalyticsColumnarWriter::append(const AnalyticsEvent &event)
+{
+    appendInt64(COLUMN_TIME, event.time.valid ? event.time.msecs : 0, event.time.valid);
+    appendString(COLUMN_ACTOR, event.actor);
+    appendString(COLUMN_VERB, event.verb);
+    appendString(COLUMN_OBJECT, event.object);
+
+    QString curatorLabel;
+
+    if(event.getResultString(QLatin1String("curatorLabel"), curatorLabel))
+        appendString(COLUMN_CURATOR_LABEL, curatorLabel);
+    else
+        appendInt32(COLUMN_CURATOR_LABEL, -1, false);
+
+    double r, s, n;
+    bool hasR = event.getResultNumber(QLatin1String("r"), r);
+    bool hasS = event.getResultNumber(QLatin1String("s"), s);
+    bool hasN = event.getResultNumber(QLatin1String("n"), n);
+
+    appendInt32(COLUMN_R, hasR ? qint32(r) : -1, hasR);
+    appendInt32(COLUMN_S, hasS ? qint32(s) : -1, hasS);
+    appendInt32(COLUMN_N, hasN ? qint32(n) : -1, hasN);
+
+    //lostness of a completed task is a field of the event, that of a found objective is in the result
+    double lostness = -1;
+
+    if(event.hasLostness)
+        lostness = event.lostness;
+    else
+        event.getResultNumber(QLatin1String("lostness"), lostness);
+
+    appendFloat(COLUMN_LOSTNESS, float(lostness), lostness >= 0);
+
+    ++m_numRows;
+}
+
+void AnalyticsColumnarWriter::appendInt64(Column column, qint64 value, bool valid)
+{
+    m_columns[column].data.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    updateStats(column, double(value), valid);
+}
+
+void AnalyticsColumnarWriter::appendInt32(Column column, qint32 value, bool valid)
+{
+    m_columns[column].data.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    updateStats(column, value, valid);
+}
+
+void AnalyticsColumnarWriter::appendFloat(Column column, float value, bool valid)
+{
+    m_columns[column].data.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    updateStats(column, value, valid);
+}
+
+void AnalyticsColumnarWriter::appendString(Column column, const QString &value)
+{
+    ColumnBuffer &buffer = m_columns[column];
+    QHash<QString, qint32>::const_iterator it = buffer.codes.constFind(value);
+    qint32 code;
+
+    if(it != buffer.codes.constEnd())
+        code = it.value();
+    else
+    {
+        code = buffer.dictionary.size();
+        buffer.codes.insert(value, code);
+        buffer.dictionary.append(value);
+    }
+
+    appendInt32(column, code, true);
+}
+
+void AnalyticsColumnarWriter::updateStats(Column column, double value, bool valid)
+{
+    if(!valid)
+        return;
+
+    ColumnStats &stats = m_columns[column].stats;
+
+    if(stats.numValid == 0)
+    {
+        stats.min = value;
+        stats.max = value;
+    }
+    else
+    {
+        stats.min = qMin(stats.min, value);
+        stats.max = qMax(stats.max, value);
+    }
+
+    ++stats.numValid;
+}
+
+bool AnalyticsColumnarWriter::write(const QString &fileName) const
+{
+    QFile file(fileName);
+
+    if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        qDebug() << "Could not write" << fileName;
+        return false;
+    }
+
+    //column blocks, then dictionaries, then the footer describing them
+    qint64 position = 0;
+    qint64 offsets[COLUMN_COUNT];
+    qint64 dictionaryOffsets[COLUMN_COUNT];
+    qint64 dictionarySizes[COLUMN_COUNT];
+
+    for(int i = 0; i < COLUMN_COUNT; ++i)
+    {
+        offsets[i] = position;
+
+        if(!writePadded(file, m_columns[i].data, position))
+            return false;
+    }
+
+    for(int i = 0; i < COLUMN_COUNT; ++i)
+    {
+        dictionaryOffsets[i] = 0;
+        dictionarySizes[i] = 0;
+
+        if(!isDictionaryEncoded(Column(i)))
+            continue;
+
+        QByteArray dictionary;
+        QDataStream stream(&dictionary, QIODevice::WriteOnly);
+        stream << m_columns[i].dictionary;
+
+        dictionaryOffsets[i] = position;
+        dictionarySizes[i] = dictionary.size();
+
+        if(!writePadded(file, dictionary, position))
+            return false;
+    }
+
+    QByteArray footer;
+    QDataStream stream(&footer, QIODevice::WriteOnly);
+
+    stream << kVersion << kLittleEndian << m_numRows << quint32(COLUMN_COUNT);
+
+    for(int i = 0; i < COLUMN_COUNT; ++i)
+    {
+        const ColumnStats &stats = m_columns[i].stats;
+
+        stream << quint32(i) << quint32(typeOf(Column(i))) << offsets[i] << qint64(m_columns[i].data.size())
+               << dictionaryOffsets[i] << dictionarySizes[i] << stats.numValid << stats.min << stats.max;
+    }
+
+    stream << position << kMagic;
+
+    return file.write(footer) == footer.size() && file.error() == QFile::NoError;
+}
+
+AnalyticsColumnarReader::AnalyticsColumnarReader()
+    : m_map(nullptr)
+    , m_numRows(0)
+{
+}
+
+AnalyticsColumnarReader::~AnalyticsColumnarReader()
+{
+    close();
+}
+
+bool AnalyticsColumnarReader::open(const QString &fileName)
+{
+    close();
+
+    m_file.setFileName(fileName);
+
+    if(!m_file.open(QIODevice::ReadOnly))
+    {
+        qDebug() << "Could not open" << fileName;
+        return false;
+    }
+
+    if(m_file.size() < kTrailerSize)
+    {
+        qDebug() << fileName << "is not a columnar log";
+        close();
+        return false;
+    }
+
+    m_map = m_file.map(0, m_file.size());
+
+    if(!m_map || !readFooter())
+    {
+        qDebug() << fileName << "could not be read as a columnar log";
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+void AnalyticsColumnarReader::close()
+{
+    if(m_map)
+        m_file.unmap(m_map);
+
+    m_map = nullptr;
+    m_file.close();
+
+    m_numRows = 0;
+
+    for(int i = 0; i < COLUMN_COUNT; ++i)
+        m_columns[i] = ColumnEntry();
+}
+
+bool AnalyticsColumnarReader::readFooter()
+{
+    qint64 size = m_file.size();
+    qint64 footerOffset;
+    quint32 magic;
+
+    QDataStream trailer(QByteArray::fromRawData(reinterpret_cast<const char*>(m_map + size - kTrailerSize), kTrailerSize));
+    trailer >> footerOffset >> magic;
+
+    if(magic != kMagic || footerOffset < 0 || footerOffset > size - kTrailerSize)
+        return false;
+
+    QDataStream stream(QByteArray::fromRawData(reinterpret_cast<const char*>(m_map + footerOffset), int(size - kTrailerSize - footerOffset)));
+    quint32 version, numColumns;
+    quint8 littleEndian;
+
+    stream >> version >> littleEndian >> m_numRows >> numColumns;
+
+    if(stream.status() != QDataStream::Ok || version != kVersion || m_numRows < 0)
+        return false;
+
+    if(littleEndian != kLittleEndian)
+    {
+        qDebug() << "The columnar log was written on a machine with another byte order";
+        return false;
+    }
+
+    for(quint32 i = 0; i < numColumns; ++i)
+    {
+        quint32 id;
+        ColumnEntry entry;
+
+        stream >> id >> entry.type >> entry.offset >> entry.size >> entry.dictionaryOffset >> entry.dictionarySize
+               >> entry.stats.numValid >> entry.stats.min >> entry.stats.max;
+
+        if(stream.status() != QDataStream::Ok)
+            return false;
+
+        //columns added by later versions are skipped
+        if(id >= COLUMN_COUNT)
+            continue;
+
+        if(entry.type != quint32(typeOf(Column(id))) || entry.offset % kAlignment != 0 || entry.offset < 0 || entry.offset + entry.size > footerOffset
+                || entry.size != m_numRows * sizeOfType(entry.type)
+                || entry.dictionaryOffset < 0 || entry.dictionarySize < 0 || entry.dictionaryOffset + entry.dictionarySize > footerOffset)
+            return false;
+
+        entry.present = true;
+        m_columns[id] = entry;
+    }
+
+    return true;
+}
+
+const uchar *AnalyticsColumnarReader::columnData(Column column, Type type) const
+{
+    const ColumnEntry &entry = m_columns[column];
+
+    if(!m_map || !entry.present || entry.type != quint32(type))
+        return nullptr;
+
+    return m_map + entry.offset;
+}
+
+const qint64 *AnalyticsColumnarReader::getInt64Column(Column column) const
+{
+    return reinterpret_cast<const qint64*>(columnData(column, TYPE_INT64));
+}
+
+const qint32 *AnalyticsColumnarReader::getInt32Column(Column column) const
+{
+    return reinterpret_cast<const qint32*>(columnData(column, TYPE_INT32));
+}
+
+const float *AnalyticsColumnarReader::getFloatColumn(Column column) const
+{
+    return reinterpret_cast<const float*>(columnData(column, TYPE_FLOAT32));
+}
+
+QStringList AnalyticsColumnarReader::getDictionary(Column column) const
+{
+    QStringList dictionary;
+    const ColumnEntry &entry = m_columns[column];
+
+    if(!m_map || !entry.present || entry.dictionarySize == 0)
+        return dictionary;
+
+    QDataStream stream(QByteArray::fromRawData(reinterpret_cast<const char*>(m_map + entry.dictionaryOffset), int(entry.dictionarySize)));
+    stream >> dictionary;
+
+    return dictionary;
+}
@@ -0,0 +1,147 @@
+#ifndef ANALYTICSCOLUMNARLOG_H
+#define ANALYTICSCOLUMNARLOG_H
+
+#include <QString>
+#include <QStringList>
+#include <QByteArray>
+#include <QHash>
+#include <QFile>
+
+#include "analyticsevent.h"
+
+///
+/// \brief Columns of a session exported for analysis across many sessions.
+///
+/// A ".ssdcol" file holds the events of one session column by column instead of as JSON, so a
+/// query over hundreds of sessions only reads the columns it needs, straight from a mapped file.
+/// Strings are dictionary encoded, each column keeps the number of rows that have a value and
+/// the smallest and largest of them, which lets a query skip files without touching their data.
+///
+namespace AnalyticsColumnarLog
+{
+    enum Column
+    {
+        COLUMN_TIME,            //msecs since the epoch, 0 without a valid timestamp
+        COLUMN_ACTOR,           //dictionary codes
+        COLUMN_VERB,
+        COLUMN_OBJECT,
+        COLUMN_CURATOR_LABEL,   //-1 unless the result names a curator label
+        COLUMN_R,               //-1 unless the result has the value
+        COLUMN_S,
+        COLUMN_N,
+        COLUMN_LOSTNESS,        //below zero if there is none or it couldn't be calculated
+        COLUMN_COUNT
+    };
+
+    enum Type
+    {
+        TYPE_INT64,
+        TYPE_INT32,
+        TYPE_FLOAT32
+    };
+
+    struct ColumnStats
+    {
+        ColumnStats() : numValid(0), min(0), max(0) {}
+
+        qint64 numValid;    //rows that have a value, min and max are only set if there are any
+        double min;
+        double max;
+    };
+
+    Type typeOf(Column column);
+    bool isDictionaryEncoded(Column column);
+
+    ///
+    /// \brief The export of a log file, next to it with the ".ssdcol" suffix
+    ///
+    QString fileNameFor(const QString &logFile);
+}
+
+///
+/// \brief Builds the columns of a session in memory and writes them out as one file
+///
+class AnalyticsColumnarWriter
+{
+public:
+    AnalyticsColumnarWriter();
+
+    void append(const AnalyticsEvent &event);
+    bool write(const QString &fileName) const;
+    void clear();
+
+    qint64 getNumRows() const {return m_numRows;}
+
+private:
+    struct ColumnBuffer
+    {
+        QByteArray data;
+        AnalyticsColumnarLog::ColumnStats stats;
+        QHash<QString, qint32> codes;
+        QStringList dictionary;
+    };
+
+    void appendInt64(AnalyticsColumnarLog::Column column, qint64 value, bool valid);
+    void appendInt32(AnalyticsColumnarLog::Column column, qint32 value, bool valid);
+    void appendFloat(AnalyticsColumnarLog::Column column, float value, bool valid);
+    void appendString(AnalyticsColumnarLog::Column column, const QString &value);
+    void updateStats(AnalyticsColumnarLog::Column column, double value, bool valid);
+
+    ColumnBuffer m_columns[AnalyticsColumnarLog::COLUMN_COUNT];
+    qint64 m_numRows;
+};
+
+///
+/// \brief Maps a ".ssdcol" file and hands out its columns as plain arrays.
+///
+/// Only the footer is read when opening, a column is paged in by the OS once it is scanned.
+/// The arrays stay valid until the reader is closed.
+///
+class AnalyticsColumnarReader
+{
+public:
+    AnalyticsColumnarReader();
+    ~AnalyticsColumnarReader();
+
+    bool open(const QString &fileName);
+    void close();
+
+    qint64 getNumRows() const {return m_numRows;}
+    const AnalyticsColumnarLog::ColumnStats &getStats(AnalyticsColumnarLog::Column column) const {return m_columns[column].stats;}
+
+    ///
+    /// \brief Values of a column, nullptr if the file has no such column of that type
+    ///
+    const qint64 *getInt64Column(AnalyticsColumnarLog::Column column) const;
+    const qint32 *getInt32Column(AnalyticsColumnarLog::Column column) const;
+    const float *getFloatColumn(AnalyticsColumnarLog::Column column) const;
+
+    ///
+    /// \brief Strings of a dictionary encoded column, indexed by code, decoded each time it is asked for
+    ///
+    QStringList getDictionary(AnalyticsColumnarLog::Column column) const;
+
+private:
+    struct ColumnEntry
+    {
+        ColumnEntry() : present(false), type(0), offset(0), size(0), dictionaryOffset(0), dictionarySize(0) {}
+
+        bool present;
+        quint32 type;
+        qint64 offset;
+        qint64 size;
+        qint64 dictionaryOffset;
+        qint64 dictionarySize;
+        AnalyticsColumnarLog::ColumnStats stats;
+    };
+
+    bool readFooter();
+    const uchar *columnData(AnalyticsColumnarLog::Column column, AnalyticsColumnarLog::Type type) const;
+
+    QFile m_file;
+    uchar *m_map;
+    qint64 m_numRows;
+    ColumnEntry m_columns[AnalyticsColumnarLog::COLUMN_COUNT];
+};
+
+#endif // ANALYTICSCOLUMNARLOG_H
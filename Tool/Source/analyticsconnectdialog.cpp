@@ -0,0 +1,95 @@
+#include "analyticsconnectdialog.h"
+
+#include <QLabel>
+#include <QLineEdit>
+#include <QPushButton>
+#include <QGridLayout>
+#include <QMessageBox>
+#include <QComboBox>
+#include <QCheckBox>
+
+enum ConnectMode
+{
+    CONNECT_TO_GAME,
+    LISTEN_FOR_GAMES
+};
+
+AnalyticsConnectDialog::AnalyticsConnectDialog(QWidget *parent)
+    : QDialog(parent)
+    , m_modeField(new QComboBox())
+    , m_ipField(new QLineEdit())
+    , m_portField(new QLineEdit())
+    , m_framingField(new QComboBox())
+    , m_binaryField(new QCheckBox("Offer binary (CBOR) events"))
+{
+    QLabel *modeLabel = new QLabel("Mode: ");
+    QLabel *ipLabel = new QLabel("IP: ");
+    QLabel *portLabel = new QLabel("Port: ");
+    QLabel *framingLabel = new QLabel("Framing: ");
+
+    m_modeField->addItem("Connect to game", CONNECT_TO_GAME);
+    m_modeField->addItem("Listen for games", LISTEN_FOR_GAMES);
+
+    //the address is only needed when connecting out
+    connect(m_modeField, static_cast<void(QComboBox::*)(int)>(&QComboBox::currentIndexChanged),
+            [=]{m_ipField->setEnabled(m_modeField->currentData().toInt() == CONNECT_TO_GAME);});
+
+    m_framingField->addItem("Newline-delimited", FRAMING_NEWLINE);
+    m_framingField->addItem("Length-prefixed", FRAMING_LENGTH_PREFIXED);
+
+    //games that don't support it ignore the offer and keep sending JSON
+    m_binaryField->setChecked(true);
+
+    QPushButton *connectBtn = new QPushButton("Connect");
+    QPushButton *cancelBtn = new QPushButton("Cancel");
+
+    connect(connectBtn, &QPushButton::released, [=]{onConnectPressed();});
+
+    connect(cancelBtn, &QPushButton::released, [=]{this->hide();});
+
+    QGridLayout *mainLayout = new QGridLayout;
+    mainLayout->addWidget(modeLabel, 0, 0);
+    mainLayout->addWidget(m_modeField, 0, 1);
+    mainLayout->addWidget(ipLabel, 1, 0);
+    mainLayout->addWidget(m_ipField, 1, 1);
+    mainLayout->addWidget(portLabel, 2, 0);
+    mainLayout->addWidget(m_portField, 2, 1);
+    mainLayout->addWidget(framingLabel, 3, 0);
+    mainLayout->addWidget(m_framingField, 3, 1);
+    mainLayout->addWidget(m_binaryField, 4, 1);
+    mainLayout->addWidget(connectBtn);
+    mainLayout->addWidget(cancelBtn);
+    setLayout(mainLayout);
+
+    setWindowTitle(tr("Connect to Server"));
+}
+
+void AnalyticsConnectDialog::onConnectPressed()
+{
+    QString address = m_ipField->text();
+    int port = m_portField->text().toInt();
+    bool listen = m_modeField->currentData().toInt() == LISTEN_FOR_GAMES;
+
+    if(address == "" && !listen)
+    {
+        QMessageBox messageBox;
+        messageBox.critical(0,"Error","Address cannot be empty.");
+        messageBox.setFixedSize(500,200);
+    }
+    else
+        if(port == 0)
+        {
+            QMessageBox messageBox;
+            messageBox.critical(0,"Error","Port is invalid.");
+            messageBox.setFixedSize(500,200);
+        }
+    else
+        {
+            this->hide();
+
+            if(listen)
+                listenRequested(port, m_framingField->currentData().toInt(), m_binaryField->isChecked());
+            else
+                connectRequested(address, port, m_framingField->currentData().toInt(), m_binaryField->isChecked());
+        }
+}
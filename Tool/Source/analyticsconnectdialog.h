@@ -0,0 +1,39 @@
+#ifndef ANALYTICSCONNECTDIALOG_H
+#define ANALYTICSCONNECTDIALOG_H
+
+#include <QDialog>
+
+#include "analyticsframer.h"
+
+class QLineEdit;
+class QComboBox;
+class QCheckBox;
+
+///
+/// \brief Asks for the address of the game to connect to, or the port to listen for players on.
+///
+/// The connections themselves are made by the ingest workers.
+///
+class AnalyticsConnectDialog : public QDialog
+{
+    Q_OBJECT
+public:
+    explicit AnalyticsConnectDialog(QWidget *parent = 0);
+
+    void showWindow(){show();}
+
+signals:
+    void connectRequested(QString address, int port, int framing, bool offerBinary);
+    void listenRequested(int port, int framing, bool offerBinary);
+
+private:
+    void onConnectPressed();
+
+    QComboBox *m_modeField;
+    QLineEdit *m_ipField;
+    QLineEdit *m_portField;
+    QComboBox *m_framingField;
+    QCheckBox *m_binaryField;
+};
+
+#endif // ANALYTICSCONNECTDIALOG_H
@@ -0,0 +1,107 @@
+#ifndef ANALYTICSDELTA_H
+#define ANALYTICSDELTA_H
+
+#include <QString>
+#include <QStringList>
+#include <QHash>
+#include <QList>
+#include <QVector>
+#include <QPointF>
+#include <QByteArray>
+#include <QSharedPointer>
+#include <QMetaType>
+
+#include "analyticstimestamp.h"
+
+struct ObjectiveLostnessUpdate
+{
+    ObjectiveLostnessUpdate(){}
+    ObjectiveLostnessUpdate(QString curatorLabel, QString objective, float lostness) : curatorLabel(curatorLabel), objective(objective), lostness(lostness)
+    {}
+    QString curatorLabel;
+    QString objective;
+    float lostness;
+};
+
+///
+/// \brief Line for the log window, the time is only formatted when the line is shown
+///
+struct AnalyticsLogLine
+{
+    ///
+    /// \brief Parts of the event a line was written for, which the log window can be filtered by
+    ///
+    enum Field
+    {
+        FIELD_ACTOR,
+        FIELD_VERB,
+        FIELD_OBJECT,
+        FIELD_CURATOR_LABEL,
+        FIELD_COUNT
+    };
+
+    AnalyticsLogLine() : player(0) {}
+    AnalyticsLogLine(QString text, AnalyticsTimestamp time = AnalyticsTimestamp(), int player = 0) : text(text), time(time), player(player)
+    {}
+
+    QString toString() const
+    {
+        if(player > 0)
+            return "[Player " + QString::number(player) + "] " + text + time.toString();
+
+        return text + time.toString();
+    }
+
+    QString text;
+    AnalyticsTimestamp time;
+    int player;     //shown in front of the line when several players are connected, 0 for none
+    QString fields[FIELD_COUNT];    //empty for lines that aren't about an event, or an event without that part
+};
+
+///
+/// \brief Everything the GUI has to change after one batch of analytics events.
+///
+/// Built up by the ingest worker and handed over read-only, so values that are simply overwritten
+/// (lostness, progress) only keep the latest value of the batch.
+///
+struct AnalyticsDelta
+{
+    AnalyticsDelta()
+        : sessionId(0)
+        , receivedAt(0)
+        , gameValuesChanged(false)
+        , localLostness(0)
+        , gameProgress(0)
+    {}
+
+    bool isEmpty() const
+    {
+        return startedCuratorLabels.isEmpty() && unlockedNodes.isEmpty() && curatorLabelLostness.isEmpty() && curatorLabelProgress.isEmpty() &&
+                objectiveLostness.isEmpty() && !gameValuesChanged && lostnessPoints.isEmpty() && logLines.isEmpty() && logEvents.isEmpty();
+    }
+
+    int sessionId;  //player the changes belong to
+    qint64 receivedAt;  //AnalyticsLatencyProbe time the first message of the batch was read, 0 if not measured
+
+    QStringList startedCuratorLabels;
+    QStringList unlockedNodes;
+
+    QHash<QString, float> curatorLabelLostness;
+    QHash<QString, float> curatorLabelProgress;
+    QList<ObjectiveLostnessUpdate> objectiveLostness;
+
+    bool gameValuesChanged;
+    float localLostness;
+    float gameProgress;
+
+    QVector<QPointF> lostnessPoints;    //seconds since session start, lostness
+
+    QList<AnalyticsLogLine> logLines;
+    QList<QByteArray> logEvents;    //compact JSON of each event, as written to the log file
+};
+
+typedef QSharedPointer<const AnalyticsDelta> AnalyticsDeltaPtr;
+
+Q_DECLARE_METATYPE(AnalyticsDeltaPtr)
+
+#endif // ANALYTICSDELTA_H
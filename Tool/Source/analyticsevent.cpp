@@ -0,0 +1,775 @@
+#include "analyticsevent.h"
+
+#include <QDebug>
+#include <QJsonDocument>
+#include <QLocale>
+#include <cstring>
+
+#include "analyticsverbs.h"
+
+static const int kMaxNestingDepth = 256;
+
+static inline bool isWhitespace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+static inline bool isNumberStart(char c)
+{
+    return c == '-' || (c >= '0' && c <= '9');
+}
+
+static inline bool keyEquals(const char *key, int length, const char *name)
+{
+    return int(strlen(name)) == length && memcmp(key, name, length) == 0;
+}
+
+static int hexValue(char c)
+{
+    if(c >= '0' && c <= '9')
+        return c - '0';
+    if(c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    if(c >= 'A' && c <= 'F')
+        return c - 'A' + 10;
+    return -1;
+}
+
+static QString decodeString(const char *begin, int length, bool escaped)
+{
+    if(!escaped)
+        return QString::fromUtf8(begin, length);
+
+    //slow path, copy the runs between escapes
+    QString value;
+    value.reserve(length);
+
+    const char *end = begin + length;
+    const char *run = begin;
+    const char *pos = begin;
+
+    while(pos < end)
+    {
+        if(*pos != '\\')
+        {
+            ++pos;
+            continue;
+        }
+
+        value += QString::fromUtf8(run, int(pos - run));
+        ++pos;
+
+        if(pos >= end)
+            break;
+
+        switch(*pos)
+        {
+        case 'b': value += QChar('\b'); break;
+        case 'f': value += QChar('\f'); break;
+        case 'n': value += QChar('\n'); break;
+        case 'r': value += QChar('\r'); break;
+        case 't': value += QChar('\t'); break;
+        case 'u':
+        {
+            ushort unit = 0;
+            for(int i = 1; i <= 4 && pos + i < end; ++i)
+                unit = (unit << 4) | ushort(qMax(hexValue(pos[i]), 0));
+
+            value += QChar(unit);   //surrogate pairs arrive as two escapes and are joined here
+            pos += 4;
+            break;
+        }
+        default: value += QChar(*pos); break;   //quote, backslash and slash
+        }
+
+        ++pos;
+        run = pos;
+    }
+
+    if(run < end)
+        value += QString::fromUtf8(run, int(end - run));
+
+    return value;
+}
+
+static void writeString(QByteArray &out, const QString &value)
+{
+    QByteArray utf8 = value.toUtf8();
+
+    out += '"';
+
+    for(int i = 0; i < utf8.size(); ++i)
+    {
+        char c = utf8[i];
+
+        switch(c)
+        {
+        case '"': out += "\\\""; break;
+        case '\\': out += "\\\\"; break;
+        case '\b': out += "\\b"; break;
+        case '\f': out += "\\f"; break;
+        case '\n': out += "\\n"; break;
+        case '\r': out += "\\r"; break;
+        case '\t': out += "\\t"; break;
+        default:
+            if(uchar(c) < 0x20)
+            {
+                out += "\\u00";
+                out += QByteArray::number(uchar(c), 16).rightJustified(2, '0');
+            }
+            else
+                out += c;
+        }
+    }
+
+    out += '"';
+}
+
+static void writeNumber(QByteArray &out, double value)
+{
+    out += QByteArray::number(value, 'g', QLocale::FloatingPointShortest);
+}
+
+void AnalyticsEvent::clear()
+{
+    fields = 0;
+    actor.clear();
+    verbId = AnalyticsVerbTable::kUnknownVerb;
+    verb.clear();
+    object.clear();
+    timestamp.clear();
+    time = AnalyticsTimestamp();
+    hasLostness = false;
+    lostness = 0;
+    sequence = -1;
+    resultType = RESULT_NONE;
+    resultString.clear();
+    resultFields.clear();
+    resultJson.clear();
+    genericResult = QJsonObject();
+    extraFields.clear();
+}
+
+bool AnalyticsEvent::getResultString(QLatin1String key, QString &value) const
+{
+    if(resultType == RESULT_FIELDS)
+    {
+        foreach (const AnalyticsResultField &field, resultFields)
+            if(field.key == key)
+            {
+                if(!field.isString)
+                    return false;
+
+                value = field.string;
+                return true;
+            }
+    }
+    else
+        if(resultType == RESULT_GENERIC && genericResult.contains(key))
+        {
+            value = genericResult[key].toString();
+            return true;
+        }
+
+    return false;
+}
+
+bool AnalyticsEvent::getResultNumber(QLatin1String key, double &value) const
+{
+    if(resultType == RESULT_FIELDS)
+    {
+        foreach (const AnalyticsResultField &field, resultFields)
+            if(field.key == key)
+            {
+                value = field.isString ? 0 : field.number;
+                return true;
+            }
+    }
+    else
+        if(resultType == RESULT_GENERIC && genericResult.contains(key))
+        {
+            value = genericResult[key].toDouble();
+            return true;
+        }
+
+    return false;
+}
+
+QByteArray AnalyticsEvent::toJson() const
+{
+    //keys in the same order QJsonDocument used to write them
+    QByteArray out;
+    out.reserve(128 + resultJson.size());
+
+    out += '{';
+
+    if(fields & FIELD_ACTOR)
+    {
+        out += "\"actor\":";
+        writeString(out, actor);
+        out += ',';
+    }
+
+    if(hasLostness)
+    {
+        out += "\"lostness\":";
+        writeNumber(out, lostness);
+        out += ',';
+    }
+
+    if(fields & FIELD_OBJECT)
+    {
+        out += "\"object\":";
+        writeString(out, object);
+        out += ',';
+    }
+
+    if(resultType != RESULT_NONE)
+    {
+        out += "\"result\":";
+
+        if(resultType == RESULT_STRING)
+            writeString(out, resultString);
+        else
+            if(resultType == RESULT_FIELDS)
+            {
+                out += '{';
+
+                for(int i = 0; i < resultFields.size(); ++i)
+                {
+                    if(i > 0)
+                        out += ',';
+
+                    writeString(out, resultFields[i].key);
+                    out += ':';
+
+                    if(resultFields[i].isString)
+                        writeString(out, resultFields[i].string);
+                    else
+                        writeNumber(out, resultFields[i].number);
+                }
+
+                out += '}';
+            }
+            else
+                out += resultJson;
+
+        out += ',';
+    }
+
+    if(sequence >= 0)
+    {
+        out += "\"seq\":";
+        out += QByteArray::number(sequence);
+        out += ',';
+    }
+
+    if(fields & FIELD_TIMESTAMP)
+    {
+        out += "\"timestamp\":";
+        writeString(out, timestamp.isEmpty() ? time.toIsoString() : timestamp);    //binary events only carry the decoded time
+        out += ',';
+    }
+
+    if(fields & FIELD_VERB)
+    {
+        out += "\"verb\":";
+        writeString(out, verb);
+        out += ',';
+    }
+
+    for(int i = 0; i < extraFields.size(); ++i)
+    {
+        out += '"';
+        out += extraFields[i].first;
+        out += "\":";
+        out += extraFields[i].second;
+        out += ',';
+    }
+
+    if(out.endsWith(','))
+        out.chop(1);
+
+    out += '}';
+
+    return out;
+}
+
+AnalyticsEventParser::AnalyticsEventParser(const AnalyticsVerbTable &verbs)
+    : m_verbs(verbs)
+    , m_begin(nullptr)
+    , m_pos(nullptr)
+    , m_end(nullptr)
+    , m_inArray(false)
+    , m_finished(true)
+    , m_error(false)
+{
+
+}
+
+void AnalyticsEventParser::setData(const QByteArray &data)
+{
+    m_begin = data.constData();
+    m_pos = m_begin;
+    m_end = m_pos + data.size();
+    m_inArray = false;
+    m_finished = false;
+    m_error = false;
+
+    skipWhitespace();
+
+    if(m_pos < m_end && *m_pos == '[')
+    {
+        m_inArray = true;
+        ++m_pos;
+    }
+    else
+        if(m_pos >= m_end || *m_pos != '{')
+            fail();
+}
+
+void AnalyticsEventParser::setPosition(qint64 position)
+{
+    m_pos = m_begin + qBound(qint64(0), position, qint64(m_end - m_begin));
+    m_finished = false;
+    m_error = false;
+}
+
+bool AnalyticsEventParser::next(AnalyticsEvent &event)
+{
+    while(!m_finished)
+    {
+        skipWhitespace();
+
+        if(m_pos >= m_end)
+            return fail();
+
+        if(m_inArray)
+        {
+            if(*m_pos == ']')
+            {
+                m_finished = true;
+                return false;
+            }
+
+            if(*m_pos == ',')
+            {
+                ++m_pos;
+                skipWhitespace();
+
+                if(m_pos >= m_end)
+                    return fail();
+            }
+
+            if(*m_pos != '{')
+            {
+                qDebug() << "Problem with JSON string";    //not an event, carry on with the next one
+                if(!skipValue())
+                    return fail();
+                continue;
+            }
+        }
+        else
+            m_finished = true;  //a single event
+
+        event.clear();
+
+        if(!parseEvent(event))
+            return fail();
+
+        return true;
+    }
+
+    return false;
+}
+
+bool AnalyticsEventParser::parseEvent(AnalyticsEvent &event)
+{
+    ++m_pos;    //opening brace
+
+    skipWhitespace();
+    if(m_pos < m_end && *m_pos == '}')
+    {
+        ++m_pos;
+        return true;
+    }
+
+    while(m_pos < m_end)
+    {
+        const char *key;
+        int keyLength;
+        bool keyEscaped;
+
+        skipWhitespace();
+        if(!scanString(key, keyLength, keyEscaped))
+            return false;
+
+        skipWhitespace();
+        if(m_pos >= m_end || *m_pos != ':')
+            return false;
+        ++m_pos;
+        skipWhitespace();
+
+        if(m_pos >= m_end)
+            return false;
+
+        bool isString = *m_pos == '"';
+
+        if(keyEquals(key, keyLength, "actor"))
+        {
+            event.fields |= AnalyticsEvent::FIELD_ACTOR;
+            if(!(isString ? parseString(event.actor) : skipValue()))
+                return false;
+        }
+        else
+            if(keyEquals(key, keyLength, "verb"))
+            {
+                event.fields |= AnalyticsEvent::FIELD_VERB;
+
+                const char *verb;
+                int verbLength;
+                bool verbEscaped;
+
+                if(!isString)
+                {
+                    if(!skipValue())
+                        return false;
+                }
+                else
+                    if(!scanString(verb, verbLength, verbEscaped))
+                        return false;
+                    else
+                        if(!verbEscaped)
+                        {
+                            //known verbs share the table's string, no decoding needed
+                            event.verbId = m_verbs.getId(verb, verbLength);
+                            event.verb = event.verbId != AnalyticsVerbTable::kUnknownVerb ? m_verbs.getName(event.verbId) : QString::fromUtf8(verb, verbLength);
+                        }
+                        else
+                        {
+                            event.verb = decodeString(verb, verbLength, true);
+                            event.verbId = m_verbs.getId(event.verb);
+                        }
+            }
+            else
+                if(keyEquals(key, keyLength, "object"))
+                {
+                    event.fields |= AnalyticsEvent::FIELD_OBJECT;
+                    if(!(isString ? parseString(event.object) : skipValue()))
+                        return false;
+                }
+                else
+                    if(keyEquals(key, keyLength, "timestamp"))
+                    {
+                        event.fields |= AnalyticsEvent::FIELD_TIMESTAMP;
+
+                        const char *timestamp;
+                        int timestampLength;
+                        bool timestampEscaped;
+
+                        if(!isString)
+                        {
+                            if(!skipValue())
+                                return false;
+                        }
+                        else
+                            if(!scanString(timestamp, timestampLength, timestampEscaped))
+                                return false;
+                            else
+                            {
+                                //decoded here once, everything after works with the epoch time
+                                event.timestamp = decodeString(timestamp, timestampLength, timestampEscaped);
+                                event.time = timestampEscaped ? AnalyticsTimestamp::fromIsoString(event.timestamp) : AnalyticsTimestamp::fromIsoString(timestamp, timestampLength);
+                            }
+                    }
+                    else
+                        if(keyEquals(key, keyLength, "result"))
+                        {
+                            if(!parseResult(event))
+                                return false;
+                        }
+                        else
+                            if(keyEquals(key, keyLength, "lostness"))
+                            {
+                                event.hasLostness = true;
+                                if(!(isNumberStart(*m_pos) ? parseNumber(event.lostness) : skipValue()))
+                                    return false;
+                            }
+                            else
+                                if(keyEquals(key, keyLength, "seq") && isNumberStart(*m_pos))
+                                {
+                                    double sequence;
+                                    if(!parseNumber(sequence))
+                                        return false;
+                                    event.sequence = qint64(sequence);
+                                }
+                                else
+                                {
+                                    //not used by the tool, keep the JSON text for the log
+                                    const char *value = m_pos;
+                                    if(!skipValue())
+                                        return false;
+
+                                    event.extraFields.append(qMakePair(QByteArray(key, keyLength), QByteArray(value, int(m_pos - value))));
+                                }
+
+        skipWhitespace();
+
+        if(m_pos >= m_end)
+            return false;
+
+        if(*m_pos == '}')
+        {
+            ++m_pos;
+            return true;
+        }
+
+        if(*m_pos != ',')
+            return false;
+
+        ++m_pos;
+    }
+
+    return false;
+}
+
+bool AnalyticsEventParser::parseResult(AnalyticsEvent &event)
+{
+    const char *begin = m_pos;
+
+    if(*m_pos == '"')
+    {
+        event.resultType = AnalyticsEvent::RESULT_STRING;
+        return parseString(event.resultString);
+    }
+
+    if(*m_pos == '{')
+    {
+        //try the flat object of strings and numbers the games send
+        event.resultType = AnalyticsEvent::RESULT_FIELDS;
+        ++m_pos;
+        skipWhitespace();
+
+        bool flat = true;
+
+        if(m_pos < m_end && *m_pos == '}')
+        {
+            ++m_pos;
+            return true;
+        }
+
+        while(m_pos < m_end && flat)
+        {
+            const char *key;
+            int keyLength;
+            bool keyEscaped;
+
+            skipWhitespace();
+            if(!scanString(key, keyLength, keyEscaped))
+                return false;
+
+            skipWhitespace();
+            if(m_pos >= m_end || *m_pos != ':')
+                return false;
+            ++m_pos;
+            skipWhitespace();
+
+            if(m_pos >= m_end)
+                return false;
+
+            AnalyticsResultField field;
+            field.key = decodeString(key, keyLength, keyEscaped);
+
+            if(*m_pos == '"')
+            {
+                field.isString = true;
+                if(!parseString(field.string))
+                    return false;
+            }
+            else
+                if(isNumberStart(*m_pos))
+                {
+                    if(!parseNumber(field.number))
+                        return false;
+                }
+                else
+                {
+                    flat = false;
+                    break;
+                }
+
+            event.resultFields.append(field);
+
+            skipWhitespace();
+
+            if(m_pos < m_end && *m_pos == '}')
+            {
+                ++m_pos;
+                return true;
+            }
+
+            if(m_pos >= m_end || *m_pos != ',')
+                return false;
+
+            ++m_pos;
+        }
+
+        if(flat)
+            return false;
+
+        event.resultFields.clear();
+    }
+
+    //unknown payload, fall back to the DOM
+    m_pos = begin;
+    if(!skipValue())
+        return false;
+
+    event.resultType = AnalyticsEvent::RESULT_GENERIC;
+    event.resultJson = QByteArray(begin, int(m_pos - begin));
+
+    if(*begin == '{')
+        event.genericResult = QJsonDocument::fromJson(event.resultJson).object();
+
+    return true;
+}
+
+bool AnalyticsEventParser::scanString(const char *&begin, int &length, bool &escaped)
+{
+    if(m_pos >= m_end || *m_pos != '"')
+        return false;
+
+    begin = ++m_pos;
+    escaped = false;
+
+    while(m_pos < m_end)
+    {
+        const char *quote = static_cast<const char*>(memchr(m_pos, '"', m_end - m_pos));
+
+        if(!quote)
+            break;
+
+        //count the backslashes in front of the quote to see if it is escaped
+        const char *backslash = quote;
+        while(backslash > begin && *(backslash - 1) == '\\')
+            --backslash;
+
+        m_pos = quote + 1;
+
+        if((quote - backslash) % 2 == 0)
+        {
+            length = int(quote - begin);
+
+            if(!escaped)
+                escaped = memchr(begin, '\\', length) != nullptr;
+
+            return true;
+        }
+
+        escaped = true;
+    }
+
+    m_pos = m_end;
+    return false;
+}
+
+bool AnalyticsEventParser::parseString(QString &value)
+{
+    const char *begin;
+    int length;
+    bool escaped;
+
+    if(!scanString(begin, length, escaped))
+        return false;
+
+    value = decodeString(begin, length, escaped);
+    return true;
+}
+
+bool AnalyticsEventParser::parseNumber(double &value)
+{
+    const char *begin = m_pos;
+
+    while(m_pos < m_end && (*m_pos == '-' || *m_pos == '+' || *m_pos == '.' || *m_pos == 'e' || *m_pos == 'E' || (*m_pos >= '0' && *m_pos <= '9')))
+        ++m_pos;
+
+    bool ok;
+    value = QByteArray(begin, int(m_pos - begin)).toDouble(&ok);
+
+    return ok;
+}
+
+bool AnalyticsEventParser::skipValue()
+{
+    if(m_pos >= m_end)
+        return false;
+
+    if(*m_pos == '"')
+    {
+        const char *begin;
+        int length;
+        bool escaped;
+        return scanString(begin, length, escaped);
+    }
+
+    if(*m_pos == '{' || *m_pos == '[')
+    {
+        int depth = 0;
+
+        while(m_pos < m_end)
+        {
+            char c = *m_pos;
+
+            if(c == '"')
+            {
+                const char *begin;
+                int length;
+                bool escaped;
+
+                if(!scanString(begin, length, escaped))
+                    return false;
+
+                continue;
+            }
+
+            if(c == '{' || c == '[')
+            {
+                if(++depth > kMaxNestingDepth)
+                    return false;
+            }
+            else
+                if(c == '}' || c == ']')
+                {
+                    if(--depth == 0)
+                    {
+                        ++m_pos;
+                        return true;
+                    }
+                }
+
+            ++m_pos;
+        }
+
+        return false;
+    }
+
+    //number, true, false or null
+    const char *begin = m_pos;
+    while(m_pos < m_end && *m_pos != ',' && *m_pos != '}' && *m_pos != ']' && !isWhitespace(*m_pos))
+        ++m_pos;
+
+    return m_pos > begin;
+}
+
+void AnalyticsEventParser::skipWhitespace()
+{
+    while(m_pos < m_end && isWhitespace(*m_pos))
+        ++m_pos;
+}
+
+bool AnalyticsEventParser::fail()
+{
+    m_error = true;
+    m_finished = true;
+    return false;
+}
@@ -0,0 +1,147 @@
+#ifndef ANALYTICSEVENT_H
+#define ANALYTICSEVENT_H
+
+#include <QString>
+#include <QByteArray>
+#include <QVector>
+#include <QList>
+#include <QPair>
+#include <QLatin1String>
+#include <QJsonObject>
+
+#include "analyticstimestamp.h"
+
+class AnalyticsVerbTable;
+
+///
+/// \brief One key of a flat result object, only strings and numbers are kept like this
+///
+struct AnalyticsResultField
+{
+    AnalyticsResultField() : isString(false), number(0) {}
+    AnalyticsResultField(QString key, QString string) : key(key), isString(true), string(string), number(0) {}
+    AnalyticsResultField(QString key, double number) : key(key), isString(false), number(number) {}
+
+    QString key;
+    bool isString;
+    QString string;
+    double number;
+};
+
+///
+/// \brief An xAPI statement sent by the game (actor, verb, object, timestamp and optional result)
+///
+struct AnalyticsEvent
+{
+    enum Field
+    {
+        FIELD_ACTOR = 1,
+        FIELD_VERB = 2,
+        FIELD_OBJECT = 4,
+        FIELD_TIMESTAMP = 8
+    };
+
+    enum ResultType
+    {
+        RESULT_NONE,
+        RESULT_STRING,      //"result": "unlock"
+        RESULT_FIELDS,      //flat object of strings and numbers, decoded into resultFields
+        RESULT_GENERIC      //anything else, kept as JSON text and only built into a QJsonObject if it is an object
+    };
+
+    AnalyticsEvent() {clear();}
+
+    void clear();
+
+    bool isComplete() const {return fields == (FIELD_ACTOR | FIELD_VERB | FIELD_OBJECT | FIELD_TIMESTAMP);}
+
+    ///
+    /// \brief Look up a string or number of the result object, whichever way it was decoded
+    ///
+    bool getResultString(QLatin1String key, QString &value) const;
+    bool getResultNumber(QLatin1String key, double &value) const;
+
+    ///
+    /// \brief Compact JSON of the event, as written to the log file
+    ///
+    QByteArray toJson() const;
+
+    int fields;
+
+    QString actor;
+    int verbId;
+    QString verb;
+    QString object;
+    QString timestamp;
+    AnalyticsTimestamp time;    //timestamp decoded while parsing
+
+    bool hasLostness;
+    double lostness;
+
+    qint64 sequence;    //numbered by games that can resend events after a reconnect, -1 if not
+
+    ResultType resultType;
+    QString resultString;
+    QVector<AnalyticsResultField> resultFields;
+    QByteArray resultJson;
+    QJsonObject genericResult;
+
+    QList<QPair<QByteArray, QByteArray>> extraFields;  //raw key and value of keys the tool doesn't use, written back to the log as they were
+};
+
+///
+/// \brief Decodes the events of a message straight into AnalyticsEvents, without building a QJsonDocument.
+///
+/// A message is either one event object or an array of them (a log file). The parser only knows
+/// the xAPI schema used by the games, other values are skipped over or copied as raw JSON text.
+/// Verbs are interned while parsing.
+///
+class AnalyticsEventParser
+{
+public:
+    AnalyticsEventParser(const AnalyticsVerbTable &verbs);
+
+    ///
+    /// \brief Start parsing a message, the data must stay valid until parsing is finished
+    ///
+    void setData(const QByteArray &data);
+
+    ///
+    /// \brief Decode the next event, returns false once there are none left or the message is malformed
+    ///
+    bool next(AnalyticsEvent &event);
+
+    bool hasError() const {return m_error;}
+
+    ///
+    /// \brief Bytes of the data parsed so far
+    ///
+    qint64 getPosition() const {return m_pos - m_begin;}
+
+    ///
+    /// \brief Carry on from a position returned by getPosition(), in the same data
+    ///
+    void setPosition(qint64 position);
+
+private:
+    bool parseEvent(AnalyticsEvent &event);
+    bool parseResult(AnalyticsEvent &event);
+
+    bool scanString(const char *&begin, int &length, bool &escaped);
+    bool parseString(QString &value);
+    bool parseNumber(double &value);
+    bool skipValue();
+    void skipWhitespace();
+    bool fail();
+
+    const AnalyticsVerbTable &m_verbs;
+
+    const char *m_begin;
+    const char *m_pos;
+    const char *m_end;
+    bool m_inArray;
+    bool m_finished;
+    bool m_error;
+};
+
+#endif // ANALYTICSEVENT_H
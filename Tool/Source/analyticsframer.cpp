@@ -0,0 +1,177 @@
+#include "analyticsframer.h"
+
+#include <QDebug>
+#include <QtEndian>
+#include <cstring>
+
+static const int kInitialCapacity = 64 * 1024;
+static const int kMaxFrameSize = 16 * 1024 * 1024;   //anything bigger is treated as a corrupt stream
+static const int kLengthPrefixSize = 4;
+
+AnalyticsFramer::AnalyticsFramer(FramingMode mode)
+    : m_mode(mode)
+    , m_begin(0)
+    , m_end(0)
+    , m_scanned(0)
+    , m_droppedBytes(0)
+{
+    m_buffer.resize(kInitialCapacity);
+}
+
+void AnalyticsFramer::setMode(FramingMode mode, bool keepBuffered)
+{
+    if(m_mode == mode)
+        return;
+
+    m_mode = mode;
+    m_scanned = m_begin;
+
+    if(!keepBuffered)
+        reset();    //bytes framed the old way can't be interpreted the new way
+}
+
+qint64 AnalyticsFramer::readFrom(QIODevice *device)
+{
+    qint64 total = 0;
+    qint64 available = device->bytesAvailable();
+
+    while(available > 0)
+    {
+        reserveSpace(int(qMin<qint64>(available, kMaxFrameSize)));
+
+        qint64 read = device->read(m_buffer.data() + m_end, m_buffer.size() - m_end);
+
+        if(read <= 0)
+            break;
+
+        m_end += int(read);
+        total += read;
+        available = device->bytesAvailable();
+    }
+
+    return total;
+}
+
+void AnalyticsFramer::append(const char *data, int size)
+{
+    if(size <= 0)
+        return;
+
+    reserveSpace(size);
+    memcpy(m_buffer.data() + m_end, data, size);
+    m_end += size;
+}
+
+bool AnalyticsFramer::nextFrame(QByteArray &frame)
+{
+    const char *buffer = m_buffer.constData();
+
+    if(m_mode == FRAMING_LENGTH_PREFIXED)
+    {
+        if(m_end - m_begin < kLengthPrefixSize)
+            return false;
+
+        quint32 length = qFromBigEndian<quint32>(reinterpret_cast<const uchar*>(buffer + m_begin));
+
+        if(length > quint32(kMaxFrameSize))
+        {
+            qDebug() << "Frame length" << length << "exceeds limit, dropping buffered data";
+            dropBuffered();
+            return false;
+        }
+
+        if(quint32(m_end - m_begin - kLengthPrefixSize) < length)
+            return false;   //wait for the rest of the frame
+
+        frame = QByteArray::fromRawData(buffer + m_begin + kLengthPrefixSize, int(length));
+        m_begin += kLengthPrefixSize + int(length);
+        m_scanned = m_begin;
+        return true;
+    }
+
+    //newline-delimited, skip blank lines between events
+    while(m_scanned < m_end)
+    {
+        const char *newline = static_cast<const char*>(memchr(buffer + m_scanned, '\n', m_end - m_scanned));
+
+        if(!newline)
+            break;
+
+        int frameEnd = int(newline - buffer);
+        int length = frameEnd - m_begin;
+
+        if(length > 0 && buffer[frameEnd - 1] == '\r')
+            --length;
+
+        const char *start = buffer + m_begin;
+        m_begin = frameEnd + 1;
+        m_scanned = m_begin;
+
+        if(length > 0)
+        {
+            frame = QByteArray::fromRawData(start, length);
+            return true;
+        }
+    }
+
+    m_scanned = m_end;
+
+    if(m_end - m_begin > kMaxFrameSize)
+    {
+        qDebug() << "No frame delimiter found in" << (m_end - m_begin) << "bytes, dropping buffered data";
+        dropBuffered();
+    }
+
+    return false;
+}
+
+QByteArray AnalyticsFramer::peek(int size) const
+{
+    return QByteArray::fromRawData(m_buffer.constData() + m_begin, qMin(size, m_end - m_begin));
+}
+
+void AnalyticsFramer::skip(int size)
+{
+    m_begin += qMin(size, m_end - m_begin);
+    m_scanned = qMax(m_scanned, m_begin);
+}
+
+void AnalyticsFramer::reset()
+{
+    m_begin = 0;
+    m_end = 0;
+    m_scanned = 0;
+}
+
+void AnalyticsFramer::reserveSpace(int size)
+{
+    if(m_begin == m_end)
+    {
+        //everything consumed, start again at the front of the buffer
+        m_begin = 0;
+        m_end = 0;
+        m_scanned = 0;
+    }
+
+    if(m_buffer.size() - m_end >= size)
+        return;
+
+    if(m_begin > 0)
+    {
+        //move the partial frame to the front instead of growing
+        int unread = m_end - m_begin;
+        memmove(m_buffer.data(), m_buffer.constData() + m_begin, unread);
+        m_scanned -= m_begin;
+        m_begin = 0;
+        m_end = unread;
+    }
+
+    if(m_buffer.size() - m_end < size)
+        m_buffer.resize(qMax(m_buffer.size() * 2, m_end + size));
+}
+
+void AnalyticsFramer::dropBuffered()
+{
+    m_droppedBytes += m_end - m_begin;
+    reset();
+}
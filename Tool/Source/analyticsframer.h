@@ -0,0 +1,84 @@
+#ifndef ANALYTICSFRAMER_H
+#define ANALYTICSFRAMER_H
+
+#include <QByteArray>
+#include <QIODevice>
+
+enum FramingMode
+{
+    FRAMING_NEWLINE,
+    FRAMING_LENGTH_PREFIXED
+};
+
+enum PayloadFormat
+{
+    PAYLOAD_JSON,
+    PAYLOAD_CBOR    //negotiated, always length-prefixed
+};
+
+///
+/// \brief Splits the byte stream sent by the game into complete event messages.
+///
+/// Bytes are read straight into a receive buffer that is reused for the whole connection.
+/// Frames are handed out as QByteArray::fromRawData() slices of that buffer, so a frame is only
+/// valid until the next call to readFrom(), append() or reset().
+///
+class AnalyticsFramer
+{
+public:
+    AnalyticsFramer(FramingMode mode = FRAMING_NEWLINE);
+
+    ///
+    /// \brief Change how frames are split, keepBuffered is for switching mode right after a stream preamble
+    ///
+    void setMode(FramingMode mode, bool keepBuffered = false);
+    FramingMode getMode() const {return m_mode;}
+
+    ///
+    /// \brief Read everything currently available on the device into the receive buffer
+    ///
+    qint64 readFrom(QIODevice *device);
+
+    ///
+    /// \brief Copy bytes into the receive buffer (for sources that are not a QIODevice)
+    ///
+    void append(const char *data, int size);
+
+    ///
+    /// \brief Get the next complete frame, returns false if more bytes are needed
+    ///
+    bool nextFrame(QByteArray &frame);
+
+    ///
+    /// \brief Look at up to size unread bytes without consuming them (same lifetime as a frame)
+    ///
+    QByteArray peek(int size) const;
+
+    ///
+    /// \brief Consume size unread bytes that are not part of a frame
+    ///
+    void skip(int size);
+
+    ///
+    /// \brief Drop all buffered bytes, the buffer memory is kept for reuse
+    ///
+    void reset();
+
+    int bufferedBytes() const {return m_end - m_begin;}
+    int droppedBytes() const {return m_droppedBytes;}
+
+private:
+    void reserveSpace(int size);
+    void dropBuffered();
+
+    FramingMode m_mode;
+
+    QByteArray m_buffer;    //size() is the capacity, only [m_begin, m_end) holds unread bytes
+    int m_begin;
+    int m_end;
+    int m_scanned;          //newline search resumes from here so partial frames are not rescanned
+
+    int m_droppedBytes;
+};
+
+#endif // ANALYTICSFRAMER_H
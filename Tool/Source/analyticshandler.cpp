@@ -1,47 +1,59 @@
 #include "analyticshandler.h"
 
-//json value names
-static const QString kName_Actor = "actor";
-static const QString kName_Verb = "verb";
-static const QString kName_Object = "object";
-static const QString kName_Result = "result";
-static const QString kName_With = " with ";
-static const QString kName_WithResults = " with results: ";
-static const QString kName_Difficulty = "difficulty";
-static const QString kName_preLostness = "preEpisodeLostness";
-static const QString kName_WithLostness = " with lostness value: ";
-static const QString kName_At = " at ";
-static const QString kName_Timestamp = "timestamp";
-static const QString kName_Lostness = "lostness";
-
-//verbs
-static const QString kName_Attempted = "attempted";
-static const QString kName_Unlock = "unlock";
-static const QString kName_Fail = "fail";
-static const QString kName_Unlocked = "unlocked";
-static const QString kName_Started = "started";
-static const QString kName_Completed = "completed";
-static const QString kName_JumpedTo = "jumped to";
-static const QString kName_PickedUp = "picked up";
-static const QString kName_Examined = "examined";
-static const QString kName_Found = "found";
+#include <QSettings>
+#include <QApplication>
+#include <QFileInfo>
+#include <QProgressDialog>
+
+#include "analyticslatencyprobe.h"
+#include "analyticslogreader.h"
+#include "analyticslogcompression.h"
+
+static const int kClientSession = 0;    //connection made from the tool, or a loaded log file
+static const int kAllSessions = -1;
+
+static const QString kName_VerbFile = "analyticsverbs.json";
+
+static const int kReplayProgressSteps = 1000;
 
 AnalyticsHandler::AnalyticsHandler(AnalyticsLogWindow *logger, QAction *connectAction, QAction *disconnectAction, QAction *editLostnessAction, QAction *loadAction, QAction *clearAction, QAction *lostnessGraphAction, QObject *parent)
-    : m_curatorAnalyticsEditor(new CuratorAnalyticsEditor(qobject_cast<QWidget*>(parent)))
-    , m_lostnessGraphDialog(new LostnessGraph(qobject_cast<QWidget*>(parent)))
-    , m_tcpSocket(new AnalyticsSocket(qobject_cast<QWidget*>(parent)))
+    : QObject(parent)
+    , m_connectDialog(new AnalyticsConnectDialog(qobject_cast<QWidget*>(parent)))
     , m_logWindow(logger)
+    , m_curatorAnalyticsEditor(new CuratorAnalyticsEditor(qobject_cast<QWidget*>(parent)))
+    , m_lostnessGraphDialog(new LostnessGraph(qobject_cast<QWidget*>(parent)))
+    , m_server(new AnalyticsServer(this))
+    , m_serverFraming(FRAMING_NEWLINE)
+    , m_serverOfferBinary(true)
+    , m_nextSessionId(kClientSession + 1)
+    , m_selectedSession(kClientSession)
+    , m_updateCoalescer(new AnalyticsUpdateCoalescer(this))
     , m_connectAction(connectAction)
     , m_disconnectAction(disconnectAction)
     , m_editLostnessAction(editLostnessAction)
     , m_loadLogFileAction(loadAction)
     , m_clearAnalyticsAction(clearAction)
     , m_lostnessGraphAction(lostnessGraphAction)
+    , m_pProperties(nullptr)
     , m_analyticsEnabled(false)
-    , QObject(parent)
+    , m_exportAfterReplay(false)
+    , m_replayProgress(nullptr)
 {
+    qRegisterMetaType<AnalyticsDeltaPtr>();
+    qRegisterMetaType<AnalyticsSessionConfig>();
+
+    m_verbTable.loadFromFile(kName_VerbFile);    //the default verbs are kept if there is no file
+
+    //how often the dashboard is redrawn while events are arriving
+    QSettings settings(QSettings::IniFormat, QSettings::UserScope, qApp->organizationName(), qApp->applicationName());
+    settings.beginGroup("analytics");
+    m_updateCoalescer->setInterval(settings.value("updateInterval", m_updateCoalescer->getInterval()).toInt());
+    settings.endGroup();
+
+    connect(m_updateCoalescer, &AnalyticsUpdateCoalescer::flushed, this, &AnalyticsHandler::applyUpdates);
+
     connect(m_connectAction, &QAction::triggered, [=]{connectToServer();});
-    connect(m_disconnectAction, &QAction::triggered, [=]{m_tcpSocket->disconnectFromServer();});
+    connect(m_disconnectAction, &QAction::triggered, [=]{disconnectAll();});
     connect(m_editLostnessAction, &QAction::triggered, [=]{m_curatorAnalyticsEditor->showWindow();});
     connect(m_loadLogFileAction, &QAction::triggered, [=]{loadAnalyticsLog();});
     connect(m_clearAnalyticsAction, &QAction::triggered, [=]{clearAll();});
@@ -52,26 +64,72 @@ AnalyticsHandler::AnalyticsHandler(AnalyticsLogWindow *logger, QAction *connectA
     m_loadLogFileAction->setEnabled(false);
     m_clearAnalyticsAction->setEnabled(false);
 
-    connect(m_tcpSocket, SIGNAL(connectedCallback()), this, SLOT(connected()));
-    connect(m_tcpSocket, SIGNAL(disconnectedCallback()), this, SLOT(disconnected()));
-    connect(m_tcpSocket, SIGNAL(readMessage(QString)), this, SLOT(readMessageFromServer(QString)));
+    connect(m_connectDialog, &AnalyticsConnectDialog::connectRequested, [=](QString address, int port, int framing, bool offerBinary){connectToGame(address, port, framing, offerBinary);});
+    connect(m_connectDialog, &AnalyticsConnectDialog::listenRequested, [=](int port, int framing, bool offerBinary){listenForGames(port, framing, offerBinary);});
+    connect(m_server, &AnalyticsServer::clientConnected, [=](qlonglong socketDescriptor){clientConnected(socketDescriptor);});
+
+    //everything from the sockets to the lostness calculation runs on the ingest threads, one per core
+    int numWorkers = qMax(1, QThread::idealThreadCount());
+
+    for(int i = 0; i < numWorkers; ++i)
+    {
+        QThread *thread = new QThread(this);
+        AnalyticsIngestWorker *worker = new AnalyticsIngestWorker();
+
+        worker->moveToThread(thread);
+        connect(thread, &QThread::finished, worker, &QObject::deleteLater);
+
+        connect(this, &AnalyticsHandler::configureSession, worker, &AnalyticsIngestWorker::configure);
+        connect(this, &AnalyticsHandler::setSessionOptions, worker, &AnalyticsIngestWorker::setSessionOptions);
+        connect(this, &AnalyticsHandler::requestDisconnect, worker, &AnalyticsIngestWorker::disconnectAll);
+        connect(this, &AnalyticsHandler::requestReset, worker, &AnalyticsIngestWorker::resetAll);
+
+        connect(worker, &AnalyticsIngestWorker::connected, this, &AnalyticsHandler::connected);
+        connect(worker, &AnalyticsIngestWorker::disconnected, this, &AnalyticsHandler::disconnected);
+        connect(worker, &AnalyticsIngestWorker::connectionError, this, &AnalyticsHandler::connectionError);
+        connect(worker, &AnalyticsIngestWorker::connectionInterrupted, this, &AnalyticsHandler::connectionInterrupted);
+        connect(worker, &AnalyticsIngestWorker::reconnected, this, &AnalyticsHandler::reconnected);
+        connect(worker, &AnalyticsIngestWorker::deltaReady, this, &AnalyticsHandler::applyDelta);
+        connect(worker, &AnalyticsIngestWorker::replayFinished, this, &AnalyticsHandler::replayFinished);
+        connect(worker, &AnalyticsIngestWorker::replayProgress, this, &AnalyticsHandler::replayProgress);
+        connect(worker, &AnalyticsIngestWorker::replayStopped, this, &AnalyticsHandler::replayStopped);
+        connect(worker, &AnalyticsIngestWorker::replayTimelineReady, this, &AnalyticsHandler::replayTimelineReady);
+        connect(worker, &AnalyticsIngestWorker::replaySeeked, this, &AnalyticsHandler::replaySeeked);
+
+        thread->start();
+
+        m_ingestThreads.append(thread);
+        m_ingestWorkers.append(worker);
+    }
 
     connect(m_curatorAnalyticsEditor, SIGNAL(finished(int)), this, SLOT(showCuratorLabels()));
+}
+
+AnalyticsHandler::~AnalyticsHandler()
+{
+    foreach (QThread *thread, m_ingestThreads)
+        thread->quit();
 
-    m_lostness_actions.insert(kName_JumpedTo);
-    m_lostness_actions.insert(kName_PickedUp);
-    //m_lostness_actions.insert(kName_Examined);
+    foreach (QThread *thread, m_ingestThreads)
+        thread->wait();
 }
 
 void AnalyticsHandler::setAnalyticsProperties(AnalyticsProperties *properties)
 {
     m_pProperties = properties;
+
+    connect(m_pProperties, &AnalyticsProperties::sessionSelected, this, [=](int sessionId){selectSession(sessionId);});
+
+    //only a loaded log file can be replayed
+    connect(m_pProperties, &AnalyticsProperties::replayTimeSelected, this, [=](qint64 msecs){
+        QMetaObject::invokeMethod(workerForSession(kClientSession), "seekReplay", Qt::QueuedConnection, Q_ARG(qint64, msecs));
+    });
 }
 
 void AnalyticsHandler::connectToServer()
 {
     //ask user if they want to clear data before connecting again
-    if(!m_logWindow->toPlainText().isEmpty())
+    if(m_logWindow->hasLines())
     {
         QMessageBox msgBox;
         msgBox.setWindowTitle("Previous Analytics Present");
@@ -84,22 +142,112 @@ void AnalyticsHandler::connectToServer()
             clearAll();
     }
 
-    m_tcpSocket->SetUpSocket();
+    //taken now as the worker can't read widgets
+    setSessionOptions(m_curatorAnalyticsEditor->getSpecifiedStartNode(), m_curatorAnalyticsEditor->getUseLostnessInTool());
+
+    m_connectDialog->showWindow();
+}
+
+void AnalyticsHandler::connectToGame(QString address, int port, int framing, bool offerBinary)
+{
+    QMetaObject::invokeMethod(workerForSession(kClientSession), "connectToServer", Qt::QueuedConnection,
+                              Q_ARG(int, kClientSession), Q_ARG(QString, address), Q_ARG(int, port), Q_ARG(int, framing), Q_ARG(bool, offerBinary));
+}
+
+void AnalyticsHandler::listenForGames(int port, int framing, bool offerBinary)
+{
+    if(!m_server->listen(QHostAddress::Any, port))
+    {
+        QMessageBox messageBox;
+        messageBox.critical(0,"Error",m_server->errorString());
+        messageBox.setFixedSize(500,200);
+        m_connectDialog->showWindow();
+        return;
+    }
+
+    m_serverFraming = framing;
+    m_serverOfferBinary = offerBinary;
+
+    m_connectAction->setEnabled(false);
+    m_disconnectAction->setEnabled(true);
+    m_clearAnalyticsAction->setEnabled(false);
+    m_pProperties->ListeningForPlayers(port);
+    m_pProperties->showSessionSelector(true);
+
+    if(m_sessions.isEmpty())
+        selectSession(kAllSessions);
+}
+
+void AnalyticsHandler::clientConnected(qlonglong socketDescriptor)
+{
+    int sessionId = m_nextSessionId++;
+
+    //the socket is created by the worker so it lives on the worker's thread
+    QMetaObject::invokeMethod(workerForSession(sessionId), "acceptClient", Qt::QueuedConnection,
+                              Q_ARG(int, sessionId), Q_ARG(qlonglong, socketDescriptor), Q_ARG(int, m_serverFraming), Q_ARG(bool, m_serverOfferBinary));
+}
+
+void AnalyticsHandler::disconnectAll()
+{
+    if(m_server->isListening())
+    {
+        m_server->close();
+
+        m_connectAction->setEnabled(true);
+        m_disconnectAction->setEnabled(false);
+        m_clearAnalyticsAction->setEnabled(true);
+        m_pProperties->DisconnectedFromServer();
+    }
+
+    requestDisconnect();
 }
 
-void AnalyticsHandler::connected()
+void AnalyticsHandler::connected(int sessionId, QString address)
 {
+    AnalyticsSessionSummary &session = m_sessions[sessionId];
+    session.connected = true;
+
+    if(sessionId != kClientSession)
+    {
+        //players come and go while listening, so no message boxes
+        session.name = "Player " + QString::number(sessionId) + " (" + address + ")";
+
+        m_logWindow->initialiseLogFile("", sessionId);
+        m_updateCoalescer->addLogLine(session.name + " connected");
+        m_pProperties->addSession(sessionId, session.name);
+        return;
+    }
+
+    session.name = address;
+
+    m_pProperties->hideReplayTimeline();    //the worker drops it once live events arrive
+
+    QMessageBox messageBox;
+    messageBox.information(0, "Connected", "Connected to: " + address);
+    messageBox.setFixedSize(500,200);
+
     m_logWindow->initialiseLogFile();
     m_connectAction->setEnabled(false);
     m_disconnectAction->setEnabled(true);
     m_clearAnalyticsAction->setEnabled(false);
-    m_pProperties->ConnectedtoServer(m_tcpSocket->getAddressAndPort());
-    m_curatorAnalyticsEditor->setFirstNodeToStartNode();
+    m_pProperties->ConnectedtoServer(address);
 }
 
-void AnalyticsHandler::disconnected()
+void AnalyticsHandler::disconnected(int sessionId)
 {
-    m_logWindow->exportToFile();
+    m_sessions[sessionId].connected = false;
+    m_logWindow->exportToFile(sessionId);
+
+    if(sessionId != kClientSession)
+    {
+        m_updateCoalescer->addLogLine(m_sessions[sessionId].name + " disconnected");
+        return;
+    }
+
+    QMessageBox messageBox;
+    messageBox.information(0, "Disconnected", "Disconnected from server");
+    messageBox.setFixedSize(500,200);
+
     m_connectAction->setEnabled(true);
     m_disconnectAction->setEnabled(false);
     m_clearAnalyticsAction->setEnabled(true);
@@ -107,13 +255,51 @@ void AnalyticsHandler::disconnected()
     m_pProperties->DisconnectedFromServer();
 }
 
+void AnalyticsHandler::connectionError(int sessionId, QString error)
+{
+    if(sessionId != kClientSession)
+    {
+        m_updateCoalescer->addLogLine("Player " + QString::number(sessionId) + " error: " + error);
+        return;
+    }
+
+    QMessageBox messageBox;
+    messageBox.critical(0,"Error",error);
+    messageBox.setFixedSize(500,200);
+    m_connectDialog->showWindow();
+}
+
+void AnalyticsHandler::connectionInterrupted(int sessionId, QString reason, int retryInMs)
+{
+    //the session stays open while the socket reconnects, so no message boxes and no export
+    const AnalyticsSessionSummary &session = m_sessions[sessionId];
+
+    m_updateCoalescer->addLogLine(session.name + ": " + reason + ", reconnecting in " + QString::number(retryInMs / 1000.0) + "s");
+
+    if(sessionId == kClientSession)
+        m_pProperties->ReconnectingToServer(session.name);
+}
+
+void AnalyticsHandler::reconnected(int sessionId)
+{
+    const AnalyticsSessionSummary &session = m_sessions[sessionId];
+
+    m_updateCoalescer->addLogLine(session.name + " reconnected");
+
+    if(sessionId == kClientSession)
+        m_pProperties->ConnectedtoServer(session.name);
+}
+
 void AnalyticsHandler::startAnalyticsMode()
 {
     checkForGraphs();
 
     if(m_curatorAnalyticsEditor->checkIfAnalyticsLoaded()) //wait for this to be completed before running the next function
         if(m_pProperties)   //show curator labels
+        {
             m_pProperties->StartAnalyticsMode(m_curatorAnalyticsEditor->getCuratorLabels());
+            applySessionConfig();
+        }
 
 
     zodiac::Node::setAnalyticsMode(true);
@@ -137,377 +323,223 @@ void AnalyticsHandler::stopAnalyticsMode()
     m_analyticsEnabled = false;
 }
 
+AnalyticsSessionConfig AnalyticsHandler::getSessionConfig()
+{
+    AnalyticsSessionConfig config = m_curatorAnalyticsEditor->getSessionConfig();
+    config.verbs = m_verbTable;
+    return config;
+}
+
+void AnalyticsHandler::applySessionConfig()
+{
+    AnalyticsSessionConfig config = getSessionConfig();
+
+    //logs repeat the labels, objectives and node ids of the tasks, so they are compressed with them
+    m_logWindow->setLogDictionary(AnalyticsLogCompression::buildDictionary(config));
+    configureSession(config);
+}
+
 void AnalyticsHandler::showCuratorLabels()
 {
     if(!m_analyticsEnabled)
         return; //callback from curator label editor if called when analytics is starting
 
     if(m_pProperties)   //show curator labels
+    {
         m_pProperties->StartAnalyticsMode(m_curatorAnalyticsEditor->getCuratorLabels());
+        applySessionConfig();
+    }
 }
 
-void AnalyticsHandler::readMessageFromServer(QString message)
+void AnalyticsHandler::applyDelta(AnalyticsDeltaPtr delta)
 {
-    handleMessage(message, m_curatorAnalyticsEditor->getUseLostnessInTool());
-}
+    int sessionId = delta->sessionId;
 
-void AnalyticsHandler::handleMessage(QString message, bool updateValues, bool loadLogFile)
-{
-    //check if the JSON data is correct
-    QJsonDocument jsonDoc = QJsonDocument::fromJson(message.toUtf8());
+    AnalyticsLatencyProbe::record(AnalyticsLatencyProbe::STAGE_HANDOFF, delta->receivedAt);
 
-    if(jsonDoc.isNull() || jsonDoc.isEmpty())
-    {
-        qDebug() << "Problem with JSON string";
-        return;
-    }
+    m_sessions[sessionId].apply(*delta);
 
-    if(jsonDoc.isArray())
-    {
-        QJsonArray jsonArray = jsonDoc.array();
-        foreach(QJsonValue jsonVal, jsonArray)
-        {
-            if(jsonVal.isObject())
-            {
-                if(!(jsonVal.toObject()[kName_Verb].toString() == kName_Found && updateValues))    //ignore a found action sent by the game if tool is calculating lostness
-                    handleObject(jsonVal.toObject(), updateValues, loadLogFile);
-            }
-            else
-            {
-                qDebug() << "Problem with JSON string";
-            }
-        }
-    }
+    if(m_selectedSession == sessionId)
+        m_updateCoalescer->addDelta(*delta, true);
     else
-        if(jsonDoc.isObject())
+        if(m_selectedSession == kAllSessions)
         {
-            if(!(jsonDoc.object()[kName_Verb].toString() == kName_Found && updateValues))    //ignore a found action sent by the game if tool is calculating lostness
-                handleObject(jsonDoc.object(), updateValues, loadLogFile);
+            AnalyticsDelta aggregate;
+            aggregateSessions(aggregate);
+            aggregate.receivedAt = delta->receivedAt;
+            m_updateCoalescer->addDelta(aggregate, false);
         }
-        else
-        {
-            qDebug() << "Problem with JSON string";
-        }
-}
-
-void AnalyticsHandler::handleObject(QJsonObject jsonObj, bool updateValues, bool loadLogFile)
-{
-    if(!jsonObj.contains(kName_Actor) || !jsonObj.contains(kName_Verb) || !jsonObj.contains(kName_Object) || !jsonObj.contains(kName_Timestamp))
-    {
-        qDebug() << "Problem with JSON object";
-        return;
-    }
-
-    //log the start time if first action
-    if(m_logWindow->isEmpty())
-        m_startTime = QDateTime::fromString(jsonObj[kName_Timestamp].toString(), Qt::ISODate);
 
-    if(!m_curatorAnalyticsEditor->isEmpty())    //don't need any of this if no tasks to log
+    //the log shows every player, the exported files are kept apart
+    if(m_selectedSession == sessionId || m_selectedSession == kAllSessions)
     {
-        if(jsonObj[kName_Verb].toString() == kName_Started) //add new task to active list and set as started in properties
+        foreach (const AnalyticsLogLine &line, delta->logLines)
         {
-            m_activeTasks.push_back(jsonObj[kName_Object].toString());
-            m_pProperties->setCuratorLabelStarted(jsonObj[kName_Object].toString(), true);
-            //handle difficulty in results
-        }
-        else
-            if(jsonObj[kName_Verb].toString() == kName_Completed)   //task completed, get lostness value, remove from the list and update properties
+            if(sessionId != kClientSession)
             {
-                if(updateValues)
-                {
-                    //float lostness = m_curatorAnalyticsEditor->getLostnessofCuratorLabel(jsonObj[kName_Object].toString());
-                    float lostness = m_curatorAnalyticsEditor->getLostnessofCuratorLabelFromObjectives(jsonObj[kName_Object].toString());
-
-                    if(lostness >= 0)
-                        jsonObj[kName_Lostness] = lostness;
-
-                    m_pProperties->updateLostnessOfCuratorLabel(jsonObj[kName_Object].toString(), lostness);
-
-                    m_pProperties->updateLocalLostness(m_curatorAnalyticsEditor->getLocalLostness());
-                    m_pProperties->updateFullGameProgress(m_curatorAnalyticsEditor->getGameProgress());
-                    m_pProperties->updateProgressOfCuratorLabel(jsonObj[kName_Object].toString(), m_curatorAnalyticsEditor->getCuratorLabelProgress(jsonObj[kName_Object].toString()));
-                }
-                else
-                {
-                    if(jsonObj.contains(kName_Lostness))
-                        m_pProperties->updateLostnessOfCuratorLabel(jsonObj[kName_Object].toString(), jsonObj[kName_Lostness].toDouble());
-                    else
-                    {
-                        float lostness = m_curatorAnalyticsEditor->getLostnessofCuratorLabelFromObjectives(jsonObj[kName_Object].toString());
-
-                        if(lostness >= 0)
-                            jsonObj[kName_Lostness] = lostness;
-
-                        m_pProperties->updateLostnessOfCuratorLabel(jsonObj[kName_Object].toString(), lostness);
-                    }
-                }
-
-                m_activeTasks.removeAll(jsonObj[kName_Object].toString());
+                AnalyticsLogLine playerLine = line;
+                playerLine.player = sessionId;
+                m_updateCoalescer->addLogLine(playerLine);
             }
             else
-                if(m_lostness_actions.contains(jsonObj["verb"].toString()))
-                {
-                    m_curatorAnalyticsEditor->updatePath(jsonObj["object"].toString(), jsonObj["verb"].toString());
-
-                    foreach (QString task, m_activeTasks)   //update lostness and check progress
-                    {
-                        m_curatorAnalyticsEditor->nodeVisited(task, jsonObj["object"].toString(), jsonObj["verb"].toString());   //Update lostness values (S and N) for each curator label
-
-                        if(updateValues)    //update lostness
-                        {
-                            m_pProperties->updateLostnessOfCuratorLabel(task, m_curatorAnalyticsEditor->getLostnessofCuratorLabel(task));
-                        }
-                    }
-                }
-                else
-                    if(jsonObj[kName_Verb].toString() == kName_Attempted) //light up node in scene to show unlocked
-                    {
-                        if(jsonObj.contains(kName_Result))
-                        {
-                            bool unlock(false);
-                            if(jsonObj[kName_Result].isObject())
-                            {
-                                QJsonObject jsonResultsObj = jsonObj[kName_Result].toObject();
-                                if(jsonResultsObj.contains(kName_Result) && jsonResultsObj[kName_Result].toString() == kName_Unlock)
-                                    unlock = true;
-                            }
-                            else
-                            {
-                                if(jsonObj[kName_Result].isString() && jsonObj[kName_Result].toString() == kName_Unlock)
-                                    unlock = true;
-                            }
-                            if(unlock)
-                            {
-                                unlockNode(jsonObj[kName_Object].toString());
-
-                                //functionality needed for when tool detects objectives and lostness
-                                if(updateValues)   //update curator label progress
-                                    if(m_curatorAnalyticsEditor->possibleObjectiveFound(jsonObj[kName_Object].toString()))
-                                    {
-                                        //get variables needed for json output
-                                        QString objective = jsonObj[kName_Object].toString();
-                                        QString parent = m_curatorAnalyticsEditor->getParentId(jsonObj[kName_Object].toString());
-                                        int r, s, n;
-                                        QString startNode, endNode;
-                                        float lostness = m_curatorAnalyticsEditor->getLostnessofObjective(parent, objective, r, s, n, startNode, endNode);
-
-                                        //update lostness
-                                       //m_curatorAnalyticsEditor->objectiveFound(objectiveID, curatorID, r, s, n, lostness, startNode, endNode);
-
-                                        //send to properties
-                                        m_pProperties->updateLostnessOfObjective(parent, objective, lostness);
-                                        m_pProperties->updateLocalLostness(m_curatorAnalyticsEditor->getLocalLostness());
-                                        m_pProperties->updateFullGameProgress(m_curatorAnalyticsEditor->getGameProgress());
-                                        m_pProperties->updateProgressOfCuratorLabel(parent, m_curatorAnalyticsEditor->getCuratorLabelProgress(parent));
-
-                                        //send to graph
-                                        QDateTime currentTime = QDateTime::fromString(jsonObj[kName_Timestamp].toString(), Qt::ISODate);
-                                        m_lostnessGraphDialog->addPoint(m_startTime.secsTo(currentTime), lostness);
-
-                                        handleTextOutput(jsonObj, updateValues);    //send this out now before doing to found message immediately afterwards
-
-                                        //make found message
-                                        QJsonObject foundObject, resultObject;
-
-                                        resultObject["r"] = r;
-                                        resultObject["s"] = s;
-                                        resultObject["n"] = n;
-                                        resultObject[kName_Lostness] = lostness;
-                                        resultObject["startNode"] = startNode;
-                                        resultObject["endNode"] = endNode;
-                                        resultObject["curatorLabel"] = parent;
-
-                                        foundObject[kName_Actor] = jsonObj[kName_Actor];
-                                        foundObject[kName_Object] = jsonObj[kName_Object];
-                                        foundObject[kName_Verb] = kName_Found;
-                                        foundObject[kName_Result] = resultObject;
-
-                                        handleTextOutput(foundObject, true);
-                                    }
-                            }
-                        }
-                    }
-                    else
-                        if(jsonObj[kName_Verb].toString() == kName_Found)   //found an objective of a curator label
-                        {
-                            //do something with the curator label manager here
-                            //add lostness to the result, maybe even remove the other stuff when done?
-                            if(jsonObj.contains(kName_Result) && jsonObj[kName_Result].isObject()) //append list of results or only one result, if they are available
-                            {
-                                QJsonObject jsonResultsObj = jsonObj[kName_Result].toObject();
-                                QString startNode, endNode, curatorID, objectiveID = "";
-                                int r, s, n = 0;
-                                float lostness = 0.0f;
-                                objectiveID = jsonObj[kName_Object].toString();
-
-                                if(jsonResultsObj.contains("r"))
-                                    r = jsonResultsObj["r"].toInt();
-                                else
-                                    qDebug() << "R not found";
-
-                                if(jsonResultsObj.contains("s"))
-                                    s = jsonResultsObj["s"].toInt();
-                                else
-                                    qDebug() << "S not found";
-
-                                if(jsonResultsObj.contains("n"))
-                                    n = jsonResultsObj["n"].toInt();
-                                else
-                                    qDebug() << "N not found";
-
-                                if(jsonResultsObj.contains("lostness"))
-                                    lostness = jsonResultsObj["lostness"].toDouble();
-                                else
-                                    qDebug() << "Lostness not found";
-
-                                if(jsonResultsObj.contains("startNode"))
-                                    startNode = jsonResultsObj["startNode"].toString();
-                                else
-                                    qDebug() << "Start node not found";
-
-                                if(jsonResultsObj.contains("endNode"))
-                                    endNode = jsonResultsObj["endNode"].toString();
-                                else
-                                    qDebug() << "End node not found";
-
-                                if(jsonResultsObj.contains("curatorLabel"))
-                                    curatorID = jsonResultsObj["curatorLabel"].toString();
-                                else
-                                    qDebug() << "Curator Label not found";
-
-                                qDebug() << "obj: " << objectiveID << "cur: " << curatorID << "r: " << r << "s: " << s << "n: " << n << "lostness" << lostness;
-                                qDebug() << "start: " << startNode << "end: " << endNode;
-
-                                //update lostness
-                                m_curatorAnalyticsEditor->objectiveFound(objectiveID, curatorID, r, s, n, lostness, startNode, endNode);
-
-                                //display all related properties in the sidebar
-                                m_pProperties->updateLostnessOfObjective(curatorID, jsonObj[kName_Object].toString(), lostness);
-                                m_pProperties->updateLocalLostness(m_curatorAnalyticsEditor->getLocalLostness());
-                                m_pProperties->updateFullGameProgress(m_curatorAnalyticsEditor->getGameProgress());
-                                m_pProperties->updateProgressOfCuratorLabel(curatorID, m_curatorAnalyticsEditor->getCuratorLabelProgress(curatorID));
-
-                                //send lostness to graph
-                                QDateTime currentTime = QDateTime::fromString(jsonObj[kName_Timestamp].toString(), Qt::ISODate);
-                                m_lostnessGraphDialog->addPoint(m_startTime.secsTo(currentTime), lostness);
-                            }
-                        }
+                m_updateCoalescer->addLogLine(line);
+        }
     }
 
-    handleTextOutput(jsonObj, updateValues, loadLogFile);
+    foreach (const QByteArray &event, delta->logEvents)
+        m_logWindow->appendToLogFile(event, sessionId);
 }
 
-void AnalyticsHandler::handleTextOutput(QJsonObject &jsonObj, bool updateValues, bool loadLogFile)
+void AnalyticsHandler::applyUpdates(const AnalyticsUpdateBatch &batch)
 {
-    //formulate human-readable string for log window
-    QString sentence = jsonObj[kName_Actor].toString() + " " + jsonObj[kName_Verb].toString() + " " + jsonObj[kName_Object].toString();
+    //one relayout of the panel for the whole batch
+    m_pProperties->setUpdatesEnabled(false);
 
-    if(jsonObj.contains(kName_Result) && jsonObj[kName_Result].isObject()) //append list of results or only one result, if they are available
+    foreach (const QString &curatorLabel, batch.startedCuratorLabels)
     {
-        QJsonObject jsonResultsObj = jsonObj[kName_Result].toObject();
-
-        QJsonDocument doc(jsonResultsObj);
-        qDebug() << doc.toJson(QJsonDocument::Compact);
+        if(!m_shownCuratorLabels.contains(curatorLabel))
+        {
+            m_shownCuratorLabels.insert(curatorLabel);
+            m_pProperties->setCuratorLabelStarted(curatorLabel, true);
+        }
+    }
 
-        if(!jsonResultsObj.empty())
-            if(jsonResultsObj.count() == 1)
-            {
+    for(QHash<QPair<QString, QString>, float>::const_iterator objectiveIt = batch.objectiveLostness.constBegin(); objectiveIt != batch.objectiveLostness.constEnd(); ++objectiveIt)
+        m_pProperties->updateLostnessOfObjective(objectiveIt.key().first, objectiveIt.key().second, objectiveIt.value());
 
-                if(jsonResultsObj.begin().value().isString())
-                {
-                    sentence += kName_With + jsonResultsObj.begin().key() + " " + jsonResultsObj.begin().value().toString();
-                }
-                else
-                    if(jsonResultsObj.begin().value().isDouble())
-                        sentence += kName_With + jsonResultsObj.begin().key() + " " + QString::number(jsonResultsObj.begin().value().toDouble());
-            }
-            else
-            {
-                int i = 1;
+    for(QHash<QString, float>::const_iterator lostnessIt = batch.curatorLabelLostness.constBegin(); lostnessIt != batch.curatorLabelLostness.constEnd(); ++lostnessIt)
+        m_pProperties->updateLostnessOfCuratorLabel(lostnessIt.key(), lostnessIt.value());
 
-                sentence += kName_WithResults;
+    for(QHash<QString, float>::const_iterator progressIt = batch.curatorLabelProgress.constBegin(); progressIt != batch.curatorLabelProgress.constEnd(); ++progressIt)
+        m_pProperties->updateProgressOfCuratorLabel(progressIt.key(), progressIt.value());
 
-                foreach(const QString& key, jsonResultsObj.keys())
-                {
-                    if(i > 1)   //comma separate everything
-                        sentence += ", ";
+    if(batch.gameValuesChanged)
+    {
+        m_pProperties->updateLocalLostness(batch.localLostness);
+        m_pProperties->updateFullGameProgress(batch.gameProgress);
+    }
 
-                    sentence += key + " = ";
+    m_pProperties->setUpdatesEnabled(true);
 
-                    if(jsonResultsObj.value(key).isString())
-                        sentence += jsonResultsObj.value(key).toString();
-                    else
-                        if(jsonResultsObj.value(key).isDouble())
-                            sentence += QString::number(jsonResultsObj.value(key).toDouble());
+    if(!batch.startedCuratorLabels.isEmpty() || !batch.objectiveLostness.isEmpty() || !batch.curatorLabelLostness.isEmpty() || !batch.curatorLabelProgress.isEmpty())
+        AnalyticsLatencyProbe::record(AnalyticsLatencyProbe::STAGE_CURATOR_LABEL, batch.receivedAt);
 
-                    ++i;
-                }
-            }
+    QStringList nodes;
+    foreach (const QString &node, batch.unlockedNodes)
+    {
+        if(!m_shownUnlockedNodes.contains(node))
+        {
+            m_shownUnlockedNodes.insert(node);
+            nodes.append(node);
+        }
     }
 
-    if(jsonObj.contains(kName_Lostness))
+    if(!nodes.empty())
     {
-        //append lostness to string
-        sentence += kName_WithLostness;
-        sentence += QString::number(jsonObj[kName_Lostness].toDouble());
+        unlockNodes(nodes);     //direct connection, the nodes are coloured when this returns
+        AnalyticsLatencyProbe::record(AnalyticsLatencyProbe::STAGE_NODE_RECOLOR, batch.receivedAt);
     }
 
-    sentence += kName_At + QDateTime::fromString(jsonObj[kName_Timestamp].toString(), Qt::ISODate).toString("MMM dd, yyyy hh:mm:ss t");
+    //a line per player would be unreadable, the graph only follows a single player
+    m_lostnessGraphDialog->addPoints(batch.lostnessPoints);
 
-    //output string to window and full JSON message to file
-    m_logWindow->appendToWindow(sentence);
+    m_logWindow->appendToWindow(batch.logLines);
 
-    if(!(loadLogFile && !updateValues))
-        m_logWindow->appendToLogFile(jsonObj);
+    if(!batch.logLines.isEmpty())
+        AnalyticsLatencyProbe::record(AnalyticsLatencyProbe::STAGE_LOG_APPEND, batch.receivedAt);
 }
 
-void AnalyticsHandler::loadAnalyticsLog()
+void AnalyticsHandler::aggregateSessions(AnalyticsDelta &delta) const
 {
-    QFile file(QFileDialog::getOpenFileName(qobject_cast<QWidget*>(parent()),
-                                                     QObject::tr("Load Analytics File"), "",
-                                                     QObject::tr("JSON File (*.json);;All Files (*)")));
+    QList<const AnalyticsSessionSummary*> sessions;
+
+    for(QMap<int, AnalyticsSessionSummary>::const_iterator sessionIt = m_sessions.constBegin(); sessionIt != m_sessions.constEnd(); ++sessionIt)
+        sessions.append(&sessionIt.value());
+
+    AnalyticsSessionSummary::aggregate(sessions, delta);
+}
+
+void AnalyticsHandler::selectSession(int sessionId)
+{
+    m_selectedSession = sessionId;
+
+    //rebuild the view from scratch for the new selection
+    m_updateCoalescer->discard(false);
+    lockAllNodes();
+    m_pProperties->resetAllCuratorLabels();
+    m_lostnessGraphDialog->resetAll();
+    m_shownUnlockedNodes.clear();
+    m_shownCuratorLabels.clear();
 
-    if(!file.fileName().isEmpty()&& !file.fileName().isNull())
+    AnalyticsDelta delta;
+
+    if(sessionId == kAllSessions)
     {
-        if(file.open(QIODevice::ReadOnly | QIODevice::Text))
+        aggregateSessions(delta);
+        m_updateCoalescer->addDelta(delta, false);
+    }
+    else
+        if(m_sessions.contains(sessionId))
         {
-            QString docString = file.readAll();
-            QString fileName = file.fileName();
-            file.close();
+            m_sessions[sessionId].toDelta(delta);
+            m_updateCoalescer->addDelta(delta, true);
+        }
+}
 
-            QJsonDocument jsonDoc = QJsonDocument::fromJson(docString.toUtf8());
+void AnalyticsHandler::loadAnalyticsLog()
+{
+    QString fileName = QFileDialog::getOpenFileName(qobject_cast<QWidget*>(parent()),
+                                                     QObject::tr("Load Analytics File"), "",
+                                                     QObject::tr("JSON File (*.json);;Segmented Log (segment_*.ndjson);;All Files (*)"));
 
-            if(jsonDoc.isNull() || !jsonDoc.isArray() || jsonDoc.isEmpty())
-            {
-                QMessageBox messageBox;
-                messageBox.critical(0,"Error","File could not be loaded, please ensure that it is the correct format.");
-                messageBox.setFixedSize(500,200);
-                return;
-            }
+    if(!fileName.isEmpty()&& !fileName.isNull())
+    {
+        m_pProperties->hideReplayTimeline();
 
-            QMessageBox msgBox;
-            msgBox.setWindowTitle("Lostness Values");
-            msgBox.setText("Do you want to update the lostness values for the loaded log file?");
-            msgBox.setStandardButtons(QMessageBox::Yes);
-            msgBox.addButton(QMessageBox::No);
-            msgBox.setDefaultButton(QMessageBox::No);
+        //only the first event is read here, the worker streams the rest from the mapped file
+        AnalyticsLogReader reader(m_verbTable);
+        AnalyticsEvent firstEvent;
 
-            if(msgBox.exec() == QMessageBox::Yes)
-            {
-                m_logWindow->initialiseLogFile(fileName);
-                handleMessage(docString, true, true);
-                m_logWindow->exportToFile();    //save new file once message is handled
-            }
-            else
-                handleMessage(docString, false, true);
-        }
-        else
+        if(!reader.open(fileName) || !reader.next(firstEvent))
         {
             QMessageBox messageBox;
             messageBox.critical(0,"Error","File could not be loaded, please ensure that it is the correct format.");
             messageBox.setFixedSize(500,200);
             return;
         }
+
+        reader.close();
+
+        QMessageBox msgBox;
+        msgBox.setWindowTitle("Lostness Values");
+        msgBox.setText("Do you want to update the lostness values for the loaded log file?");
+        msgBox.setStandardButtons(QMessageBox::Yes);
+        msgBox.addButton(QMessageBox::No);
+        msgBox.setDefaultButton(QMessageBox::No);
+
+        bool updateValues = msgBox.exec() == QMessageBox::Yes;
+
+        if(updateValues)
+        {
+            m_logWindow->initialiseLogFile(fileName);
+            m_exportAfterReplay = true; //save new file once the worker has handled the whole log
+        }
+
+        //shown only if loading takes a while
+        m_replayProgress = new QProgressDialog("Loading " + QFileInfo(fileName).fileName() + "...", "Cancel", 0, kReplayProgressSteps, qobject_cast<QWidget*>(parent()));
+        m_replayProgress->setWindowTitle("Load Analytics File");
+        m_replayProgress->setWindowModality(Qt::WindowModal);
+        m_replayProgress->setMinimumDuration(500);
+        m_replayProgress->setValue(0);
+
+        connect(m_replayProgress, &QProgressDialog::canceled, this, [=]{
+            QMetaObject::invokeMethod(workerForSession(kClientSession), "cancelReplay", Qt::QueuedConnection);
+        });
+
+        m_loadLogFileAction->setEnabled(false);
+
+        QMetaObject::invokeMethod(workerForSession(kClientSession), "replayFile", Qt::QueuedConnection,
+                                  Q_ARG(int, kClientSession), Q_ARG(QString, fileName), Q_ARG(bool, updateValues));
     }
     else
     {
@@ -516,11 +548,113 @@ void AnalyticsHandler::loadAnalyticsLog()
     }
 }
 
+void AnalyticsHandler::replayProgress(int sessionId, qint64 bytesRead, qint64 totalBytes)
+{
+    if(m_replayProgress)
+    {
+        m_replayProgress->setValue(totalBytes > 0 ? int(bytesRead * kReplayProgressSteps / totalBytes) : 0);
+
+        if(m_replayProgress->wasCanceled())
+            return;
+    }
+
+    //the changes of the last chunk have been handed over, so the worker can read the next one
+    QMetaObject::invokeMethod(workerForSession(sessionId), "replayChunk", Qt::QueuedConnection);
+}
+
+void AnalyticsHandler::replayFinished(int sessionId)
+{
+    closeReplayProgress();
+
+    if(m_exportAfterReplay)
+    {
+        m_logWindow->exportToFile(sessionId);
+        m_exportAfterReplay = false;
+    }
+}
+
+void AnalyticsHandler::replayStopped(int sessionId, QString error)
+{
+    closeReplayProgress();
+    m_pProperties->hideReplayTimeline();
+
+    //a partly replayed log must not replace the one it came from
+    if(m_exportAfterReplay)
+    {
+        m_logWindow->discardLogFile(sessionId);
+        m_exportAfterReplay = false;
+    }
+
+    if(!error.isEmpty())
+    {
+        QMessageBox messageBox;
+        messageBox.critical(0,"Error",error);
+        messageBox.setFixedSize(500,200);
+    }
+}
+
+void AnalyticsHandler::replayTimelineReady(int sessionId, qint64 firstMsecs, qint64 lastMsecs)
+{
+    if(sessionId == kClientSession)
+        m_pProperties->showReplayTimeline(firstMsecs, lastMsecs);
+}
+
+void AnalyticsHandler::replaySeeked(AnalyticsDeltaPtr state)
+{
+    //the session is shown as it was at that time, not added to
+    AnalyticsSessionSummary &session = m_sessions[state->sessionId];
+    session.reset();
+    session.apply(*state);
+
+    m_updateCoalescer->discard(true);
+    m_logWindow->clearWindow();
+    selectSession(m_selectedSession);
+
+    foreach (const AnalyticsLogLine &line, state->logLines)
+        m_updateCoalescer->addLogLine(line);
+}
+
+void AnalyticsHandler::closeReplayProgress()
+{
+    if(m_replayProgress)
+    {
+        m_replayProgress->deleteLater();
+        m_replayProgress = nullptr;
+    }
+
+    m_loadLogFileAction->setEnabled(m_analyticsEnabled);
+}
+
 void AnalyticsHandler::clearAll()
 {
-    m_logWindow->setPlainText("");
-    lockAllNodes();
-    m_pProperties->resetAllCuratorLabels();
-    m_curatorAnalyticsEditor->resetAll();
-    m_lostnessGraphDialog->resetAll();
+    m_updateCoalescer->discard(true);
+    m_logWindow->clearWindow();
+    m_pProperties->hideReplayTimeline();
+    requestReset();
+
+    //players still connected keep their place in the selector
+    m_pProperties->clearSessions();
+
+    QMap<int, AnalyticsSessionSummary>::iterator sessionIt = m_sessions.begin();
+    while(sessionIt != m_sessions.end())
+    {
+        if(sessionIt.value().connected)
+        {
+            sessionIt.value().reset();
+
+            if(sessionIt.key() != kClientSession)
+                m_pProperties->addSession(sessionIt.key(), sessionIt.value().name);
+
+            ++sessionIt;
+        }
+        else
+            sessionIt = m_sessions.erase(sessionIt);
+    }
+
+    m_pProperties->showSessionSelector(m_server->isListening());
+
+    if(m_server->isListening())
+        selectSession(kAllSessions);
+    else
+        selectSession(kClientSession);
 }
@@ -2,8 +2,16 @@
 #define ANALYTICSHANDLER_H
 
 #include "analyticslogwindow.h"
-#include "analyticssocket.h"
+#include "analyticsconnectdialog.h"
+#include "analyticsingestworker.h"
+#include "analyticsserver.h"
+#include "analyticssessionsummary.h"
+#include "analyticsupdatecoalescer.h"
 #include <QObject>
+#include <QThread>
+#include <QMap>
+#include <QSet>
+#include <QProgressDialog>
 #include "zodiacgraph/node.h"
 #include "nodeproperties.h"
 #include "curatoranalyticseditor.h"
@@ -16,39 +24,84 @@ class AnalyticsHandler : public QObject
 
 public:
     AnalyticsHandler(AnalyticsLogWindow *logger, QAction *connectAction, QAction *disconnectAction, QAction *editLostnessAction, QAction *loadAction, QAction *clearAction, QAction *lostnessGraphAction, QObject *parent);
+    ~AnalyticsHandler();
 
     void setAnalyticsProperties(AnalyticsProperties *properties);
     void startAnalyticsMode();
     void stopAnalyticsMode();
 
 signals:
-    void unlockNode(QString name);
+    void unlockNodes(QStringList names);
     void lockAllNodes();
     void resetNodes();
     void closeNodeProperties();
     void checkForGraphs();
 
+    //requests handled by every ingest worker thread
+    void configureSession(AnalyticsSessionConfig config);
+    void setSessionOptions(QString startNode, bool useLostnessInTool);
+    void requestDisconnect();
+    void requestReset();
+
 public slots:
-    void connected();
-    void disconnected();
+    void connected(int sessionId, QString address);
+    void disconnected(int sessionId);
+    void connectionError(int sessionId, QString error);
+    void connectionInterrupted(int sessionId, QString reason, int retryInMs);
+    void reconnected(int sessionId);
     void connectToServer();
     void showCuratorLabels();
-    void readMessageFromServer(QString message);
+    void applyDelta(AnalyticsDeltaPtr delta);
+    void replayFinished(int sessionId);
+    void replayProgress(int sessionId, qint64 bytesRead, qint64 totalBytes);
+    void replayStopped(int sessionId, QString error);
+    void replayTimelineReady(int sessionId, qint64 firstMsecs, qint64 lastMsecs);
+    void replaySeeked(AnalyticsDeltaPtr state);
 
 private:
-    void handleMessage(QString message, bool updateValues = true, bool loadLogFile = false);
-    void handleObject(QJsonObject jsonObj, bool updateValues, bool loadLogFile);
-
-    void handleTextOutput(QJsonObject &jsonObj, bool updateValues, bool loadLogFile = false);
     void loadAnalyticsLog();
 
+    void closeReplayProgress();
+
     void clearAll();
 
-    AnalyticsSocket *m_tcpSocket;
+    AnalyticsSessionConfig getSessionConfig();
+    void applySessionConfig();
+
+    void connectToGame(QString address, int port, int framing, bool offerBinary);
+    void listenForGames(int port, int framing, bool offerBinary);
+    void clientConnected(qlonglong socketDescriptor);
+    void disconnectAll();
+
+    ///
+    /// \brief Workers are sharded by session id, a session always stays on the same thread
+    ///
+    AnalyticsIngestWorker *workerForSession(int sessionId){return m_ingestWorkers[sessionId % m_ingestWorkers.size()];}
+
+    void selectSession(int sessionId);
+    void applyUpdates(const AnalyticsUpdateBatch &batch);
+    void aggregateSessions(AnalyticsDelta &delta) const;
+
+    AnalyticsConnectDialog *m_connectDialog;
     AnalyticsLogWindow *m_logWindow;
     CuratorAnalyticsEditor *m_curatorAnalyticsEditor;
     LostnessGraph *m_lostnessGraphDialog;
 
+    QList<QThread*> m_ingestThreads;
+    QList<AnalyticsIngestWorker*> m_ingestWorkers;
+
+    AnalyticsServer *m_server;
+    int m_serverFraming;
+    bool m_serverOfferBinary;
+    int m_nextSessionId;
+
+    QMap<int, AnalyticsSessionSummary> m_sessions;
+    int m_selectedSession;              //-1 shows the average of all players
+    QSet<QString> m_shownUnlockedNodes; //what the current view has already been sent
+    QSet<QString> m_shownCuratorLabels;
+
+    AnalyticsUpdateCoalescer *m_updateCoalescer;
+
     QAction *m_connectAction;
     QAction *m_disconnectAction;
     QAction *m_editLostnessAction;
@@ -56,15 +109,13 @@ private:
     QAction *m_clearAnalyticsAction;
     QAction *m_lostnessGraphAction;
 
-    QList<QString> m_activeTasks;
-
     AnalyticsProperties *m_pProperties;
 
-    bool m_analyticsEnabled;
-
-    QSet<QString> m_lostness_actions;
+    AnalyticsVerbTable m_verbTable;
 
-    QDateTime m_startTime;
+    bool m_analyticsEnabled;
+    bool m_exportAfterReplay;
+    QProgressDialog *m_replayProgress;
 };
 
 #endif // ANALYTICSHANDLER_H
@@ -0,0 +1,341 @@
+#include "analyticsingestworker.h"
+
+#include "analyticssocket.h"
+#include "analyticslatencyprobe.h"
+#include "analyticslogreader.h"
+#include "analyticssegmentedlog.h"
+
+static const int kFrameInterval = 16;   //ms, roughly one display frame
+static const int kReplayChunk = 2000;   //events replayed before handing the changes to the GUI
+
+AnalyticsIngestWorker::AnalyticsIngestWorker(QObject *parent)
+    : QObject(parent)
+    , m_replaySession(0)
+    , m_replayUpdateValues(false)
+    , m_useLostnessInTool(false)
+    , m_flushTimer(new QTimer(this))
+{
+    m_flushTimer->setSingleShot(true);
+    m_flushTimer->setInterval(kFrameInterval);
+    connect(m_flushTimer, &QTimer::timeout, this, &AnalyticsIngestWorker::flush);
+}
+
+AnalyticsIngestWorker::~AnalyticsIngestWorker()
+{
+    qDeleteAll(m_sessions);
+}
+
+void AnalyticsIngestWorker::configure(AnalyticsSessionConfig config)
+{
+    m_config = config;
+    m_timeline.clear();     //checkpoints of the old curator labels can't be restored
+
+    foreach (IngestSession *session, m_sessions)
+        session->session.configure(m_config);
+}
+
+void AnalyticsIngestWorker::setSessionOptions(QString startNode, bool useLostnessInTool)
+{
+    m_startNode = startNode;
+    m_useLostnessInTool = useLostnessInTool;
+}
+
+void AnalyticsIngestWorker::connectToServer(int sessionId, QString address, int port, int framing, bool offerBinary)
+{
+    IngestSession *session = getSession(sessionId);
+
+    if(!session->socket)
+        session->socket = createSocket(sessionId);
+
+    session->socket->connectToServer(address, port, FramingMode(framing), offerBinary);
+}
+
+void AnalyticsIngestWorker::acceptClient(int sessionId, qlonglong socketDescriptor, int framing, bool offerBinary)
+{
+    IngestSession *session = getSession(sessionId);
+
+    if(!session->socket)
+        session->socket = createSocket(sessionId);
+
+    //events may be read as soon as the socket is taken over, so the session has to be ready first
+    session->session.setFirstNode(m_startNode);
+    session->session.resetStartTime();
+    session->session.resetSequence();
+
+    if(session->socket->acceptConnection(qintptr(socketDescriptor), FramingMode(framing), offerBinary))
+        connected(sessionId, session->socket->getAddressAndPort());
+}
+
+void AnalyticsIngestWorker::disconnectSession(int sessionId)
+{
+    if(m_sessions.contains(sessionId) && m_sessions[sessionId]->socket)
+        m_sessions[sessionId]->socket->disconnectFromServer();
+}
+
+void AnalyticsIngestWorker::disconnectAll()
+{
+    foreach (IngestSession *session, m_sessions)
+        if(session->socket)
+            session->socket->disconnectFromServer();
+}
+
+AnalyticsIngestWorker::IngestSession *AnalyticsIngestWorker::getSession(int sessionId)
+{
+    if(!m_sessions.contains(sessionId))
+    {
+        //every player gets their own copy of the curator labels
+        IngestSession *session = new IngestSession;
+        session->session.configure(m_config);
+        m_sessions.insert(sessionId, session);
+    }
+
+    return m_sessions[sessionId];
+}
+
+AnalyticsSocket *AnalyticsIngestWorker::createSocket(int sessionId)
+{
+    //created here so it belongs to this thread
+    AnalyticsSocket *socket = new AnalyticsSocket(this);
+
+    connect(socket, &AnalyticsSocket::connectedCallback, this, [=]{onSocketConnected(sessionId);});
+    connect(socket, &AnalyticsSocket::disconnectedCallback, this, [=]{onSocketDisconnected(sessionId);});
+    connect(socket, &AnalyticsSocket::errorCallback, this, [=](QString error){connectionError(sessionId, error);});
+    connect(socket, &AnalyticsSocket::connectionLost, this, [=](QString reason, int retryInMs){connectionInterrupted(sessionId, reason, retryInMs);});
+    connect(socket, &AnalyticsSocket::reconnectedCallback, this, [=]{reconnected(sessionId);});  //the session carries on where it was
+    connect(socket, &AnalyticsSocket::readMessage, this, [=](const QByteArray &message, PayloadFormat format){readMessage(sessionId, message, format);});
+
+    return socket;
+}
+
+void AnalyticsIngestWorker::onSocketConnected(int sessionId)
+{
+    IngestSession *session = getSession(sessionId);
+
+    session->session.setFirstNode(m_startNode);
+    session->session.resetStartTime();
+    session->session.resetSequence();
+
+    if(m_timeline.isActive() && m_timeline.getSessionId() == sessionId)
+        m_timeline.clear();     //live events would change the session under the checkpoints
+
+    connected(sessionId, session->socket->getAddressAndPort());
+}
+
+void AnalyticsIngestWorker::onSocketDisconnected(int sessionId)
+{
+    flushSession(sessionId, getSession(sessionId));    //GUI must have every event before it exports the log
+    disconnected(sessionId);
+}
+
+void AnalyticsIngestWorker::readMessage(int sessionId, const QByteArray &message, PayloadFormat format)
+{
+    IngestSession *session = getSession(sessionId);
+    AnalyticsDelta &delta = pendingDelta(sessionId, session);
+
+    if(AnalyticsLatencyProbe::isEnabled())
+    {
+        AnalyticsLatencyProbe::messageReceived();
+
+        if(delta.receivedAt == 0)
+            delta.receivedAt = AnalyticsLatencyProbe::now();
+    }
+
+    session->session.handleMessage(message, format, m_useLostnessInTool, false, delta);
+
+    if(session->session.getLastSequence() >= 0)
+        session->socket->acknowledge(session->session.getLastSequence());
+}
+
+void AnalyticsIngestWorker::replayFile(int sessionId, QString fileName, bool updateValues)
+{
+    if(m_replayReader)
+        stopReplay();
+
+    m_timeline.clear();
+    m_replayReader.reset(new AnalyticsLogReader(m_config.verbs));
+    m_replaySession = sessionId;
+    m_replayUpdateValues = updateValues;
+
+    if(!m_replayReader->open(fileName))
+    {
+        stopReplay();
+        replayStopped(sessionId, "File could not be loaded, please ensure that it is the correct format.");
+        return;
+    }
+
+    getSession(sessionId)->session.resetStartTime();
+
+    //a JSON log replayed with new values is saved over itself, so it couldn't be read again at the same positions
+    if(!updateValues || AnalyticsSegmentedLog::isSegmentFile(fileName))
+        m_timeline.start(sessionId, fileName, updateValues);
+
+    replayChunk();
+}
+
+void AnalyticsIngestWorker::replayChunk()
+{
+    if(!m_replayReader)
+        return;
+
+    IngestSession *session = getSession(m_replaySession);
+    AnalyticsEvent event;
+    int numEvents = 0;
+
+    if(m_timeline.needsCheckpoint())
+        m_timeline.addCheckpoint(m_replayReader->getBytesRead(), session->session.getState());
+
+    while(numEvents < kReplayChunk && m_replayReader->next(event))
+    {
+        session->session.replayEvent(event, m_replayUpdateValues, pendingDelta(m_replaySession, session));
+        m_timeline.eventReplayed(event);
+        ++numEvents;
+    }
+
+    if(m_timeline.isActive() && session->pending)
+        m_timeline.deltaReplayed(*session->pending);
+
+    flushSession(m_replaySession, session);
+
+    int sessionId = m_replaySession;
+
+    if(m_replayReader->hasError())
+    {
+        stopReplay();
+        m_timeline.clear();
+        replayStopped(sessionId, "Part of the file is not in the correct format, only the events before it were loaded.");
+    }
+    else
+        if(numEvents < kReplayChunk)
+        {
+            stopReplay();
+
+            if(m_timeline.isActive() && m_timeline.getLastMsecs() > m_timeline.getFirstMsecs())
+                replayTimelineReady(sessionId, m_timeline.getFirstMsecs(), m_timeline.getLastMsecs());
+
+            replayFinished(sessionId);
+        }
+        else
+            replayProgress(sessionId, m_replayReader->getBytesRead(), m_replayReader->getTotalBytes());
+}
+
+void AnalyticsIngestWorker::cancelReplay()
+{
+    if(!m_replayReader)
+        return;
+
+    int sessionId = m_replaySession;
+
+    stopReplay();
+    m_timeline.clear();
+    replayStopped(sessionId, QString());
+}
+
+void AnalyticsIngestWorker::seekReplay(qint64 msecs)
+{
+    const AnalyticsReplayCheckpoint *checkpoint = m_timeline.findCheckpoint(msecs);
+
+    if(m_replayReader || !checkpoint)
+        return;     //still replaying, or nothing to go back to
+
+    int sessionId = m_timeline.getSessionId();
+    IngestSession *session = getSession(sessionId);
+    AnalyticsLogReader reader(m_config.verbs);
+
+    if(!reader.open(m_timeline.getFileName()) || !reader.seek(checkpoint->position) || !session->session.setState(checkpoint->state))
+    {
+        m_timeline.clear();
+        replayStopped(sessionId, "The log file could not be read again, it may have been moved or changed.");
+        return;
+    }
+
+    //anything not yet handed over is from before the seek
+    flushSession(sessionId, session);
+
+    AnalyticsDelta changes;
+    AnalyticsEvent event;
+
+    while(reader.next(event))
+    {
+        if(event.time.valid && event.time.msecs > msecs)
+            break;
+
+        session->session.replayEvent(event, m_timeline.getUpdateValues(), changes);
+    }
+
+    AnalyticsSessionSummary summary = checkpoint->summary;
+    summary.apply(changes);
+
+    AnalyticsDelta *state = new AnalyticsDelta;
+    state->sessionId = sessionId;
+    summary.toDelta(*state);
+    state->logLines = changes.logLines;     //only the lines since the checkpoint, the log file has the rest
+
+    replaySeeked(AnalyticsDeltaPtr(state));
+}
+
+void AnalyticsIngestWorker::stopReplay()
+{
+    m_replayReader.reset();
+}
+
+void AnalyticsIngestWorker::resetAll()
+{
+    m_timeline.clear();
+
+    QHash<int, IngestSession*>::iterator sessionIt = m_sessions.begin();
+
+    while(sessionIt != m_sessions.end())
+    {
+        IngestSession *session = sessionIt.value();
+
+        if(!session->socket || !session->socket->isConnected())    //player has gone, nothing left to show
+        {
+            if(session->socket)
+                session->socket->deleteLater();
+
+            delete session;
+            sessionIt = m_sessions.erase(sessionIt);
+        }
+        else
+        {
+            session->pending.reset();
+            session->session.resetAll();
+            ++sessionIt;
+        }
+    }
+}
+
+AnalyticsDelta &AnalyticsIngestWorker::pendingDelta(int sessionId, IngestSession *session)
+{
+    if(!session->pending)
+    {
+        session->pending.reset(new AnalyticsDelta);
+        session->pending->sessionId = sessionId;
+    }
+
+    if(!m_flushTimer->isActive())
+        m_flushTimer->start();
+
+    return *session->pending;
+}
+
+void AnalyticsIngestWorker::flush()
+{
+    m_flushTimer->stop();
+
+    for(QHash<int, IngestSession*>::iterator sessionIt = m_sessions.begin(); sessionIt != m_sessions.end(); ++sessionIt)
+        flushSession(sessionIt.key(), sessionIt.value());
+}
+
+void AnalyticsIngestWorker::flushSession(int sessionId, IngestSession *session)
+{
+    Q_UNUSED(sessionId);
+
+    if(!session->pending)
+        return;
+
+    if(!session->pending->isEmpty())
+        deltaReady(AnalyticsDeltaPtr(session->pending.take()));
+    else
+        session->pending.reset();
+}
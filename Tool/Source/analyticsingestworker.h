@@ -0,0 +1,103 @@
+#ifndef ANALYTICSINGESTWORKER_H
+#define ANALYTICSINGESTWORKER_H
+
+#include <QObject>
+#include <QTimer>
+#include <QHash>
+#include <QScopedPointer>
+
+#include "analyticssession.h"
+#include "analyticsdelta.h"
+#include "analyticsframer.h"
+#include "analyticsreplaytimeline.h"
+
+class AnalyticsSocket;
+class AnalyticsLogReader;
+
+///
+/// \brief Runs the analytics pipeline of a shard of players on its own thread.
+///
+/// Owns the sockets, the JSON parsing and the curator/lostness state of every session assigned
+/// to it. The GUI only receives the changes as batched AnalyticsDeltas, at most once per display
+/// frame for each session.
+///
+class AnalyticsIngestWorker : public QObject
+{
+    Q_OBJECT
+public:
+    explicit AnalyticsIngestWorker(QObject *parent = 0);
+    ~AnalyticsIngestWorker();
+
+signals:
+    void connected(int sessionId, QString address);
+    void disconnected(int sessionId);
+    void connectionError(int sessionId, QString error);
+    void connectionInterrupted(int sessionId, QString reason, int retryInMs);
+    void reconnected(int sessionId);
+    void deltaReady(AnalyticsDeltaPtr delta);
+    void replayFinished(int sessionId);
+    void replayProgress(int sessionId, qint64 bytesRead, qint64 totalBytes);
+    void replayStopped(int sessionId, QString error);   //cancelled if there is no error
+    void replayTimelineReady(int sessionId, qint64 firstMsecs, qint64 lastMsecs);
+    void replaySeeked(AnalyticsDeltaPtr state);         //everything to show at the time, not just the changes
+
+public slots:
+    void configure(AnalyticsSessionConfig config);
+    void setSessionOptions(QString startNode, bool useLostnessInTool);
+    void connectToServer(int sessionId, QString address, int port, int framing, bool offerBinary);
+    void acceptClient(int sessionId, qlonglong socketDescriptor, int framing, bool offerBinary);
+    void disconnectSession(int sessionId);
+    void disconnectAll();
+    ///
+    /// \brief Replay a saved log in chunks, the next chunk is only read once replayChunk() is called again
+    ///
+    /// Waiting for the GUI to ask for each chunk keeps at most one chunk of changes in flight.
+    ///
+    void replayFile(int sessionId, QString fileName, bool updateValues);
+    void replayChunk();
+    void cancelReplay();
+    ///
+    /// \brief Show the replayed log as it was at a time, from the nearest checkpoint before it
+    ///
+    void seekReplay(qint64 msecs);
+    void resetAll();
+
+private slots:
+    void flush();
+
+private:
+    struct IngestSession
+    {
+        IngestSession() : socket(nullptr) {}
+
+        AnalyticsSocket *socket;
+        AnalyticsSession session;
+        QScopedPointer<AnalyticsDelta> pending;
+    };
+
+    IngestSession *getSession(int sessionId);
+    AnalyticsSocket *createSocket(int sessionId);
+    AnalyticsDelta &pendingDelta(int sessionId, IngestSession *session);
+
+    void readMessage(int sessionId, const QByteArray &message, PayloadFormat format);
+    void onSocketConnected(int sessionId);
+    void onSocketDisconnected(int sessionId);
+    void flushSession(int sessionId, IngestSession *session);
+
+    void stopReplay();
+
+    QHash<int, IngestSession*> m_sessions;
+    AnalyticsSessionConfig m_config;
+
+    QScopedPointer<AnalyticsLogReader> m_replayReader;
+    int m_replaySession;
+    bool m_replayUpdateValues;
+    AnalyticsReplayTimeline m_timeline;
+
+    QString m_startNode;
+    bool m_useLostnessInTool;
+
+    QTimer *m_flushTimer;
+};
+
+#endif // ANALYTICSINGESTWORKER_H
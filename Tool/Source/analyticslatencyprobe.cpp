@@ -0,0 +1,195 @@
+#include "analyticslatencyprobe.h"
+
+#include <QElapsedTimer>
+#include <QAtomicInt>
+#include <QCoreApplication>
+#include <QTimer>
+#include <QVector>
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QDebug>
+#include <algorithm>
+
+static const char *kStageNames[AnalyticsLatencyProbe::STAGE_COUNT] =
+{
+    "handoff",
+    "curator_label",
+    "node_recolor",
+    "log_append"
+};
+
+struct LatencySample
+{
+    qint64 at;          //ns on the probe clock
+    qint64 latency;     //ns
+};
+
+static QElapsedTimer s_clock;
+static QAtomicInt s_received;
+static QString s_reportFile;
+static int s_budgetMs = 100;
+
+static QVector<LatencySample> s_samples[AnalyticsLatencyProbe::STAGE_COUNT];
+static QVector<int> s_receivedPerSecond;
+static int s_lastReceived = 0;
+
+bool AnalyticsLatencyProbe::s_enabled = false;
+
+static double toMs(qint64 nsecs)
+{
+    return nsecs / 1000000.0;
+}
+
+static qint64 percentile(QVector<qint64> &latencies, double fraction)
+{
+    //nearest rank, sorts the values in place
+    if(latencies.isEmpty())
+        return 0;
+
+    std::sort(latencies.begin(), latencies.end());
+
+    int rank = qBound(0, int(fraction * latencies.size() + 0.999999) - 1, latencies.size() - 1);
+    return latencies[rank];
+}
+
+static QVector<qint64> latenciesInSecond(int stage, int second, int &next)
+{
+    //samples are recorded in time order, so each second carries on from where the last one stopped
+    QVector<qint64> latencies;
+    const QVector<LatencySample> &samples = s_samples[stage];
+    qint64 end = (qint64(second) + 1) * 1000000000;
+
+    for(; next < samples.size() && samples[next].at < end; ++next)
+        latencies.append(samples[next].latency);
+
+    return latencies;
+}
+
+void AnalyticsLatencyProbe::enable(const QString &reportFile, int budgetMs)
+{
+    s_reportFile = reportFile;
+    s_budgetMs = budgetMs;
+    s_clock.start();
+    s_enabled = true;
+
+    //messages are counted on the workers, the rate is sampled once a second
+    QTimer *sampler = new QTimer(QCoreApplication::instance());
+    sampler->setInterval(1000);
+    QObject::connect(sampler, &QTimer::timeout, []{
+        int received = s_received.load();
+        s_receivedPerSecond.append(received - s_lastReceived);
+        s_lastReceived = received;
+    });
+    sampler->start();
+
+    qDebug() << "Benchmark enabled, report will be written to" << reportFile;
+}
+
+qint64 AnalyticsLatencyProbe::now()
+{
+    return s_enabled ? s_clock.nsecsElapsed() : 0;
+}
+
+void AnalyticsLatencyProbe::messageReceived()
+{
+    s_received.fetchAndAddRelaxed(1);
+}
+
+void AnalyticsLatencyProbe::record(Stage stage, qint64 receivedAt)
+{
+    if(!s_enabled || receivedAt <= 0)
+        return;
+
+    LatencySample sample;
+    sample.at = now();
+    sample.latency = sample.at - receivedAt;
+
+    s_samples[stage].append(sample);
+}
+
+bool AnalyticsLatencyProbe::writeReport()
+{
+    if(!s_enabled)
+        return false;
+
+    QFile summary(s_reportFile);
+
+    if(!summary.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text))
+    {
+        qDebug() << "Could not write benchmark report" << s_reportFile;
+        return false;
+    }
+
+    summary.write("stage,samples,p50_ms,p90_ms,p99_ms,max_ms\n");
+
+    for(int stage = 0; stage < STAGE_COUNT; ++stage)
+    {
+        QVector<qint64> latencies;
+        latencies.reserve(s_samples[stage].size());
+
+        foreach (const LatencySample &sample, s_samples[stage])
+            latencies.append(sample.latency);
+
+        qint64 p50 = percentile(latencies, 0.5);
+        qint64 p90 = percentile(latencies, 0.9);
+        qint64 p99 = percentile(latencies, 0.99);
+        qint64 max = latencies.isEmpty() ? 0 : latencies.last();
+
+        summary.write(QString("%1,%2,%3,%4,%5,%6\n").arg(kStageNames[stage]).arg(latencies.size())
+                      .arg(toMs(p50), 0, 'f', 3).arg(toMs(p90), 0, 'f', 3).arg(toMs(p99), 0, 'f', 3).arg(toMs(max), 0, 'f', 3).toUtf8());
+    }
+
+    //per second: how many messages came in and the worst p99 of any stage
+    QFileInfo reportInfo(s_reportFile);
+    QFile timeline(reportInfo.dir().filePath(reportInfo.completeBaseName() + "_timeline.csv"));
+
+    if(!timeline.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text))
+    {
+        qDebug() << "Could not write benchmark timeline" << timeline.fileName();
+        return false;
+    }
+
+    timeline.write("second,messages");
+    for(int stage = 0; stage < STAGE_COUNT; ++stage)
+        timeline.write(QByteArray(",") + kStageNames[stage] + "_p99_ms");
+    timeline.write("\n");
+
+    int peak = 0;
+    int ceiling = 0;    //highest rate at which every stage stayed within the budget
+    int next[STAGE_COUNT] = {};     //first sample of each stage not yet in a second
+
+    for(int second = 0; second < s_receivedPerSecond.size(); ++second)
+    {
+        int messages = s_receivedPerSecond[second];
+        qint64 worst = -1;
+
+        timeline.write(QByteArray::number(second) + ',' + QByteArray::number(messages));
+
+        for(int stage = 0; stage < STAGE_COUNT; ++stage)
+        {
+            QVector<qint64> latencies = latenciesInSecond(stage, second, next[stage]);
+            qint64 p99 = percentile(latencies, 0.99);
+
+            if(!latencies.isEmpty())
+                worst = qMax(worst, p99);
+
+            timeline.write(',' + QByteArray::number(toMs(p99), 'f', 3));
+        }
+
+        timeline.write("\n");
+
+        peak = qMax(peak, messages);
+
+        if(worst >= 0 && toMs(worst) <= s_budgetMs)
+            ceiling = qMax(ceiling, messages);
+    }
+
+    summary.write(QString("messages_received,%1\n").arg(s_received.load()).toUtf8());
+    summary.write(QString("peak_messages_per_second,%1\n").arg(peak).toUtf8());
+    summary.write(QString("ceiling_messages_per_second_within_%1ms,%2\n").arg(s_budgetMs).arg(ceiling).toUtf8());
+
+    qDebug() << "Benchmark report written to" << s_reportFile;
+
+    return true;
+}
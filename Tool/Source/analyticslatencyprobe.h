@@ -0,0 +1,59 @@
+#ifndef ANALYTICSLATENCYPROBE_H
+#define ANALYTICSLATENCYPROBE_H
+
+#include <QString>
+#include <QtGlobal>
+
+///
+/// \brief Measures how long analytics events take from the socket to the dashboard, for the ingest benchmark.
+///
+/// Only active when the tool is started with "--benchmark <report.csv>". Messages are stamped when
+/// the ingest worker reads them, and the oldest stamp of every batch is compared with the time the
+/// batch reached each part of the dashboard. Percentiles and throughput are written when the tool exits.
+///
+class AnalyticsLatencyProbe
+{
+public:
+    enum Stage
+    {
+        STAGE_HANDOFF,          //delta received by the GUI thread
+        STAGE_CURATOR_LABEL,    //sidebar updated
+        STAGE_NODE_RECOLOR,     //unlocked nodes coloured in the graphs
+        STAGE_LOG_APPEND,       //lines added to the log window
+        STAGE_COUNT
+    };
+
+    ///
+    /// \brief Start measuring, must be called on the GUI thread before any connection is made
+    ///
+    /// budgetMs is the latency the throughput ceiling in the report has to stay within.
+    ///
+    static void enable(const QString &reportFile, int budgetMs = 100);
+
+    static bool isEnabled(){return s_enabled;}
+
+    ///
+    /// \brief Nanoseconds on the probe's clock, the same on every thread
+    ///
+    static qint64 now();
+
+    ///
+    /// \brief Count a message read from a socket, safe to call from the ingest workers
+    ///
+    static void messageReceived();
+
+    ///
+    /// \brief A batch with its oldest message received at receivedAt reached stage (GUI thread only)
+    ///
+    static void record(Stage stage, qint64 receivedAt);
+
+    ///
+    /// \brief Write the summary and the per-second timeline next to it, does nothing if not enabled
+    ///
+    static bool writeReport();
+
+private:
+    static bool s_enabled;
+};
+
+#endif // ANALYTICSLATENCYPROBE_H
@@ -0,0 +1,168 @@
+#include "analyticslogcompression.h"
+
+#include <QtEndian>
+#include <cstring>
+#include <zlib.h>
+
+#include "lostness.h"
+
+static const quint32 kFrameMagic = 0x5353445a;                 //"SSDZ"
+static const quint32 kMaxFrameBytes = 64 * 1024 * 1024;        //anything claiming to be bigger is corrupt
+static const int kMaxDictionaryBytes = 32 * 1024;              //zlib only looks back this far
+
+//keys in the order AnalyticsEvent::toJson writes them, with the result fields of a found objective in the order AnalyticsSession adds them
+static const char kEventTemplate[] =
+        "{\"actor\":\"\",\"lostness\":0.,\"object\":\"\",\"result\":\"unlock\"}"
+        "{\"actor\":\"\",\"object\":\"\",\"result\":{\"curatorLabel\":\"\",\"endNode\":\"\",\"lostness\":0.,\"n\":,\"r\":,\"s\":,\"startNode\":\"\"},"
+        "\"timestamp\":\"2000-01-01T00:00:00.000Z\",\"verb\":\"\"}\n";
+
+static void appendString(QByteArray &dictionary, const QString &value)
+{
+    dictionary += '"';
+    dictionary += value.toUtf8();
+    dictionary += "\",";
+}
+
+QByteArray AnalyticsLogCompression::buildDictionary(const AnalyticsSessionConfig &config)
+{
+    //zlib finds matches near the end of the dictionary most cheaply, so the strings every event has go last
+    QByteArray dictionary;
+
+    if(config.lostnessHandler)
+        foreach (const QString &node, config.lostnessHandler->getNodeNames())
+            appendString(dictionary, node);
+
+    foreach (const CuratorLabelDefinition &curatorLabel, config.curatorLabels)
+    {
+        dictionary += "\"curatorLabel\":";
+        appendString(dictionary, curatorLabel.id);
+
+        foreach (const QString &objective, curatorLabel.objectives)
+        {
+            dictionary += "\"object\":";
+            appendString(dictionary, objective);
+        }
+    }
+
+    for(int i = AnalyticsVerbTable::kUnknownVerb + 1; i < config.verbs.getNumVerbs(); ++i)
+    {
+        dictionary += "\"verb\":";
+        appendString(dictionary, config.verbs.getName(i));
+    }
+
+    dictionary += kEventTemplate;
+
+    //a graph too big to fit loses its first nodes
+    if(dictionary.size() > kMaxDictionaryBytes)
+        dictionary = dictionary.right(kMaxDictionaryBytes);
+
+    return dictionary;
+}
+
+QByteArray AnalyticsLogCompression::compressFrame(const QByteArray &data, const QByteArray &dictionary)
+{
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+
+    if(deflateInit(&stream, Z_DEFAULT_COMPRESSION) != Z_OK)
+        return QByteArray();
+
+    if(!dictionary.isEmpty() && deflateSetDictionary(&stream, reinterpret_cast<const Bytef*>(dictionary.constData()), uInt(dictionary.size())) != Z_OK)
+    {
+        deflateEnd(&stream);
+        return QByteArray();
+    }
+
+    QByteArray frame(kFrameHeaderSize + int(deflateBound(&stream, uLong(data.size()))), Qt::Uninitialized);
+
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.constData()));
+    stream.avail_in = uInt(data.size());
+    stream.next_out = reinterpret_cast<Bytef*>(frame.data() + kFrameHeaderSize);
+    stream.avail_out = uInt(frame.size() - kFrameHeaderSize);
+
+    int result = deflate(&stream, Z_FINISH);
+    quint32 compressedSize = quint32(stream.total_out);
+
+    deflateEnd(&stream);
+
+    if(result != Z_STREAM_END)
+        return QByteArray();
+
+    frame.resize(kFrameHeaderSize + int(compressedSize));
+
+    uchar *header = reinterpret_cast<uchar*>(frame.data());
+    qToBigEndian(kFrameMagic, header);
+    qToBigEndian(compressedSize, header + 4);
+    qToBigEndian(quint32(data.size()), header + 8);
+
+    return frame;
+}
+
+bool AnalyticsLogCompression::readFrameHeader(const char *header, quint32 &compressedSize, quint32 &uncompressedSize)
+{
+    const uchar *bytes = reinterpret_cast<const uchar*>(header);
+
+    if(qFromBigEndian<quint32>(bytes) != kFrameMagic)
+        return false;
+
+    compressedSize = qFromBigEndian<quint32>(bytes + 4);
+    uncompressedSize = qFromBigEndian<quint32>(bytes + 8);
+
+    return compressedSize <= kMaxFrameBytes && uncompressedSize <= kMaxFrameBytes;
+}
+
+bool AnalyticsLogCompression::decompressFrame(const char *data, quint32 size, char *out, quint32 outSize, const QByteArray &dictionary)
+{
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+
+    if(inflateInit(&stream) != Z_OK)
+        return false;
+
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+    stream.avail_in = uInt(size);
+    stream.next_out = reinterpret_cast<Bytef*>(out);
+    stream.avail_out = uInt(outSize);
+
+    int result = inflate(&stream, Z_FINISH);
+
+    //zlib checks the dictionary is the one the frame was written with
+    if(result == Z_NEED_DICT && inflateSetDictionary(&stream, reinterpret_cast<const Bytef*>(dictionary.constData()), uInt(dictionary.size())) == Z_OK)
+        result = inflate(&stream, Z_FINISH);
+
+    bool complete = result == Z_STREAM_END && stream.total_out == outSize;
+
+    inflateEnd(&stream);
+
+    return complete;
+}
+
+QByteArray AnalyticsLogCompression::decompressFrames(const QByteArray &data, const QByteArray &dictionary, qint64 *complete)
+{
+    QByteArray out;
+    qint64 position = 0;
+
+    while(position + kFrameHeaderSize <= data.size())
+    {
+        quint32 compressedSize, uncompressedSize;
+
+        if(!readFrameHeader(data.constData() + position, compressedSize, uncompressedSize) || position + kFrameHeaderSize + compressedSize > data.size())
+            break;
+
+        int before = out.size();
+        out.resize(before + int(uncompressedSize));
+
+        if(!decompressFrame(data.constData() + position + kFrameHeaderSize, compressedSize, out.data() + before, uncompressedSize, dictionary))
+        {
+            out.resize(before);
+            break;
+        }
+
+        position += kFrameHeaderSize + compressedSize;
+    }
+
+    if(complete)
+        *complete = position;
+
+    return out;
+}
@@ -0,0 +1,47 @@
+#ifndef ANALYTICSLOGCOMPRESSION_H
+#define ANALYTICSLOGCOMPRESSION_H
+
+#include <QByteArray>
+
+#include "analyticssession.h"
+
+///
+/// \brief zlib frames for session logs, primed with a dictionary of the strings logs keep repeating.
+///
+/// Every frame is a whole zlib stream behind a small header, so each one can be decompressed on
+/// its own and a crash can only tear the last frame of a file. The dictionary holds the JSON keys
+/// of an event, the verbs, the curator labels and objectives of the tasks and the node ids of the
+/// spatial graph, so even the first event of a frame is mostly references into it.
+///
+class AnalyticsLogCompression
+{
+public:
+    static const int kFrameHeaderSize = 12;     //magic, compressed and uncompressed size
+
+    ///
+    /// \brief Dictionary for the logs of sessions set up with the config, at most the 32KB zlib can use
+    ///
+    static QByteArray buildDictionary(const AnalyticsSessionConfig &config);
+
+    ///
+    /// \brief A whole frame, header included, empty if it could not be compressed
+    ///
+    static QByteArray compressFrame(const QByteArray &data, const QByteArray &dictionary);
+
+    ///
+    /// \brief Decompress the frames at the start of data, stopping at the first torn or corrupt one
+    ///
+    /// \param [out] complete  Bytes of data taken up by the frames that were decompressed.
+    ///
+    static QByteArray decompressFrames(const QByteArray &data, const QByteArray &dictionary, qint64 *complete = nullptr);
+
+    ///
+    /// \brief Read the header at the start of a frame, false if it isn't one
+    ///
+    static bool readFrameHeader(const char *header, quint32 &compressedSize, quint32 &uncompressedSize);
+
+private:
+    static bool decompressFrame(const char *data, quint32 size, char *out, quint32 outSize, const QByteArray &dictionary);
+};
+
+#endif // ANALYTICSLOGCOMPRESSION_H
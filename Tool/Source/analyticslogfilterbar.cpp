@@ -0,0 +1,82 @@
+#include "analyticslogfilterbar.h"
+
+#include <QHBoxLayout>
+
+AnalyticsLogFilterBar::AnalyticsLogFilterBar(QWidget *parent)
+    : QWidget(parent)
+    , m_matchLabel(new QLabel(this))
+    , m_clearBtn(new QPushButton("Clear", this))
+{
+    static const char *kPlaceholders[AnalyticsLogLine::FIELD_COUNT] = {"Actor", "Verb", "Object", "Curator label"};
+
+    QHBoxLayout *layout = new QHBoxLayout(this);
+    layout->setContentsMargins(2, 2, 2, 2);
+    layout->addWidget(new QLabel("Filter:", this));
+
+    for(int i = 0; i < AnalyticsLogLine::FIELD_COUNT; ++i)
+    {
+        m_fields[i] = new QLineEdit(this);
+        m_fields[i]->setPlaceholderText(kPlaceholders[i]);
+        m_fields[i]->setClearButtonEnabled(true);
+
+        //suggest every term containing what has been typed
+        m_terms[i] = new QStringListModel(this);
+        QCompleter *completer = new QCompleter(m_terms[i], this);
+        completer->setCaseSensitivity(Qt::CaseInsensitive);
+        completer->setFilterMode(Qt::MatchContains);
+        m_fields[i]->setCompleter(completer);
+
+        connect(m_fields[i], SIGNAL(textChanged(QString)), this, SLOT(onFieldChanged()));
+        layout->addWidget(m_fields[i], 1);
+    }
+
+    layout->addWidget(m_matchLabel);
+    layout->addWidget(m_clearBtn);
+
+    connect(m_clearBtn, SIGNAL(clicked()), this, SLOT(onClear()));
+
+    setNumMatches(0, 0);
+}
+
+AnalyticsLogFilter AnalyticsLogFilterBar::getFilter() const
+{
+    AnalyticsLogFilter filter;
+
+    for(int i = 0; i < AnalyticsLogLine::FIELD_COUNT; ++i)
+        filter.terms[i] = m_fields[i]->text().trimmed();
+
+    return filter;
+}
+
+void AnalyticsLogFilterBar::setTerms(AnalyticsLogLine::Field field, const QStringList &terms)
+{
+    if(m_terms[field]->stringList() != terms)
+        m_terms[field]->setStringList(terms);
+}
+
+void AnalyticsLogFilterBar::setNumMatches(int numMatches, int numLines)
+{
+    bool filtered = !getFilter().isEmpty();
+
+    m_matchLabel->setText(filtered ? QString("%1 of %2 lines").arg(numMatches).arg(numLines) : QString());
+    m_matchLabel->setVisible(filtered);
+    m_clearBtn->setEnabled(filtered);
+}
+
+void AnalyticsLogFilterBar::onFieldChanged()
+{
+    emit filterChanged(getFilter());
+}
+
+void AnalyticsLogFilterBar::onClear()
+{
+    //one filter change for all the fields
+    for(int i = 0; i < AnalyticsLogLine::FIELD_COUNT; ++i)
+    {
+        m_fields[i]->blockSignals(true);
+        m_fields[i]->clear();
+        m_fields[i]->blockSignals(false);
+    }
+
+    emit filterChanged(getFilter());
+}
@@ -0,0 +1,51 @@
+#ifndef ANALYTICSLOGFILTERBAR_H
+#define ANALYTICSLOGFILTERBAR_H
+
+#include <QWidget>
+#include <QLineEdit>
+#include <QCompleter>
+#include <QStringListModel>
+#include <QPushButton>
+#include <QLabel>
+
+#include "analyticslogindex.h"
+
+///
+/// \brief Row of fields above the log window, one per part of an event the log can be filtered by.
+///
+/// Each field suggests the terms the shown lines have. The filter changes as soon as a field does,
+/// a field that doesn't hold a whole term matches nothing until it does.
+///
+class AnalyticsLogFilterBar : public QWidget
+{
+    Q_OBJECT
+public:
+    explicit AnalyticsLogFilterBar(QWidget *parent = 0);
+
+    AnalyticsLogFilter getFilter() const;
+
+    ///
+    /// \brief Replace the suggestions of a field
+    ///
+    void setTerms(AnalyticsLogLine::Field field, const QStringList &terms);
+
+    ///
+    /// \brief Show how many lines match, or nothing when there is no filter
+    ///
+    void setNumMatches(int numMatches, int numLines);
+
+signals:
+    void filterChanged(AnalyticsLogFilter filter);
+
+private slots:
+    void onFieldChanged();
+    void onClear();
+
+private:
+    QLineEdit *m_fields[AnalyticsLogLine::FIELD_COUNT];
+    QStringListModel *m_terms[AnalyticsLogLine::FIELD_COUNT];
+    QLabel *m_matchLabel;
+    QPushButton *m_clearBtn;
+};
+
+#endif // ANALYTICSLOGFILTERBAR_H
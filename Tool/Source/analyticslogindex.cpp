@@ -0,0 +1,127 @@
+#include "analyticslogindex.h"
+
+#include <algorithm>
+
+bool AnalyticsLogFilter::isEmpty() const
+{
+    for(int i = 0; i < AnalyticsLogLine::FIELD_COUNT; ++i)
+        if(!terms[i].isEmpty())
+            return false;
+
+    return true;
+}
+
+bool AnalyticsLogFilter::matches(const AnalyticsLogLine &line) const
+{
+    for(int i = 0; i < AnalyticsLogLine::FIELD_COUNT; ++i)
+        if(!terms[i].isEmpty() && terms[i] != line.fields[i])
+            return false;
+
+    return true;
+}
+
+AnalyticsLogIndex::AnalyticsLogIndex()
+{
+
+}
+
+bool AnalyticsLogIndex::add(qint64 ordinal, const AnalyticsLogLine &line)
+{
+    bool newTerm = false;
+
+    for(int i = 0; i < AnalyticsLogLine::FIELD_COUNT; ++i)
+    {
+        if(line.fields[i].isEmpty())
+            continue;
+
+        QVector<qint64> &ordinals = m_postings[i][line.fields[i]];
+
+        newTerm = newTerm || ordinals.isEmpty();
+        ordinals.append(ordinal);
+    }
+
+    return newTerm;
+}
+
+void AnalyticsLogIndex::prune(qint64 firstOrdinal)
+{
+    for(int i = 0; i < AnalyticsLogLine::FIELD_COUNT; ++i)
+    {
+        QHash<QString, QVector<qint64>>::iterator postingIt = m_postings[i].begin();
+
+        while(postingIt != m_postings[i].end())
+        {
+            QVector<qint64> &ordinals = postingIt.value();
+            int numOld = int(std::lower_bound(ordinals.constBegin(), ordinals.constEnd(), firstOrdinal) - ordinals.constBegin());
+
+            ordinals.remove(0, numOld);
+
+            //terms that are no longer in any shown line aren't offered any more
+            if(ordinals.isEmpty())
+                postingIt = m_postings[i].erase(postingIt);
+            else
+                ++postingIt;
+        }
+    }
+}
+
+void AnalyticsLogIndex::clear()
+{
+    for(int i = 0; i < AnalyticsLogLine::FIELD_COUNT; ++i)
+        m_postings[i].clear();
+}
+
+QVector<qint64> AnalyticsLogIndex::find(const AnalyticsLogFilter &filter, qint64 firstOrdinal) const
+{
+    QVector<qint64> found;
+    QList<const QVector<qint64>*> lists;
+
+    for(int i = 0; i < AnalyticsLogLine::FIELD_COUNT; ++i)
+    {
+        if(filter.terms[i].isEmpty())
+            continue;
+
+        QHash<QString, QVector<qint64>>::const_iterator postingIt = m_postings[i].constFind(filter.terms[i]);
+
+        //a term that isn't in the log matches nothing
+        if(postingIt == m_postings[i].constEnd())
+            return found;
+
+        lists.append(&postingIt.value());
+    }
+
+    if(lists.isEmpty())
+        return found;
+
+    std::sort(lists.begin(), lists.end(), [](const QVector<qint64> *a, const QVector<qint64> *b){return a->size() < b->size();});
+
+    //cursors into the longer lists only ever move forward
+    QVector<QVector<qint64>::const_iterator> cursors;
+    for(int i = 1; i < lists.size(); ++i)
+        cursors.append(lists[i]->constBegin());
+
+    const QVector<qint64> &shortest = *lists.first();
+
+    for(QVector<qint64>::const_iterator it = std::lower_bound(shortest.constBegin(), shortest.constEnd(), firstOrdinal); it != shortest.constEnd(); ++it)
+    {
+        bool inAll = true;
+
+        for(int i = 0; i < cursors.size() && inAll; ++i)
+        {
+            cursors[i] = std::lower_bound(cursors[i], lists[i + 1]->constEnd(), *it);
+            inAll = cursors[i] != lists[i + 1]->constEnd() && *cursors[i] == *it;
+        }
+
+        if(inAll)
+            found.append(*it);
+    }
+
+    return found;
+}
+
+QStringList AnalyticsLogIndex::getTerms(AnalyticsLogLine::Field field) const
+{
+    QStringList terms = m_postings[field].keys();
+    terms.sort();
+    return terms;
+}
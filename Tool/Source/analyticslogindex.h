@@ -0,0 +1,60 @@
+#ifndef ANALYTICSLOGINDEX_H
+#define ANALYTICSLOGINDEX_H
+
+#include <QString>
+#include <QStringList>
+#include <QHash>
+#include <QVector>
+
+#include "analyticsdelta.h"
+
+///
+/// \brief Which lines of the log window to show, an empty term matches anything
+///
+struct AnalyticsLogFilter
+{
+    bool isEmpty() const;
+    bool matches(const AnalyticsLogLine &line) const;
+
+    QString terms[AnalyticsLogLine::FIELD_COUNT];   //matched exactly
+};
+
+///
+/// \brief Inverted index from the actor, verb, object and curator label of log lines to their ordinals.
+///
+/// Lines are numbered in the order they are added, so every posting list stays sorted just by
+/// appending to it. A filter is answered by walking its shortest list and looking the ordinals up
+/// in the others, so the cost depends on how rare the rarest term is, not on the size of the log.
+///
+class AnalyticsLogIndex
+{
+public:
+    AnalyticsLogIndex();
+
+    ///
+    /// \brief Index a line, returns true if it had a term no other line has
+    ///
+    bool add(qint64 ordinal, const AnalyticsLogLine &line);
+
+    ///
+    /// \brief Forget the lines before firstOrdinal, once they are no longer shown
+    ///
+    void prune(qint64 firstOrdinal);
+
+    void clear();
+
+    ///
+    /// \brief Ordinals of the lines from firstOrdinal on that match a filter which isn't empty, in order
+    ///
+    QVector<qint64> find(const AnalyticsLogFilter &filter, qint64 firstOrdinal) const;
+
+    ///
+    /// \brief Every term of a field that is in the index, sorted
+    ///
+    QStringList getTerms(AnalyticsLogLine::Field field) const;
+
+private:
+    QHash<QString, QVector<qint64>> m_postings[AnalyticsLogLine::FIELD_COUNT];
+};
+
+#endif // ANALYTICSLOGINDEX_H
@@ -0,0 +1,164 @@
+#include "analyticslogmodel.h"
+
+AnalyticsLogModel::AnalyticsLogModel(int capacity, QObject *parent)
+    : QAbstractListModel(parent)
+    , m_capacity(qMax(1, capacity))
+    , m_first(0)
+    , m_count(0)
+    , m_numDropped(0)
+    , m_prunedAt(0)
+    , m_filtering(false)
+    , m_filteredFirst(0)
+{
+
+}
+
+int AnalyticsLogModel::rowCount(const QModelIndex &parent) const
+{
+    if(parent.isValid())
+        return 0;
+
+    return m_filtering ? m_filtered.size() - m_filteredFirst : m_count;
+}
+
+QVariant AnalyticsLogModel::data(const QModelIndex &index, int role) const
+{
+    if(!index.isValid() || index.row() >= rowCount())
+        return QVariant();
+
+    //only rows being shown are ever formatted
+    if(role == Qt::DisplayRole)
+        return m_filtering ? lineOfOrdinal(m_filtered[m_filteredFirst + index.row()]).toString() : lineAt(index.row()).toString();
+
+    return QVariant();
+}
+
+void AnalyticsLogModel::append(const QList<AnalyticsLogLine> &lines)
+{
+    if(lines.isEmpty())
+        return;
+
+    //more than fit, only the newest are kept
+    int skip = qMax(0, lines.size() - m_capacity);
+    int numNew = lines.size() - skip;
+    int overflow = m_count + numNew - m_capacity;
+    bool pruned = false;
+
+    if(overflow > 0)
+    {
+        //the buffer only wraps around once it has been filled
+        m_lines.resize(m_capacity);
+
+        if(!m_filtering)
+            beginRemoveRows(QModelIndex(), 0, overflow - 1);
+
+        m_first = (m_first + overflow) % m_capacity;
+        m_count -= overflow;
+        m_numDropped += overflow;
+
+        if(!m_filtering)
+            endRemoveRows();
+        else
+            dropFiltered();
+
+        //about once per buffer of lines, so the index never holds much more than the buffer
+        if(m_numDropped - m_prunedAt >= m_capacity)
+        {
+            m_index.prune(m_numDropped);
+            m_prunedAt = m_numDropped;
+            pruned = true;
+        }
+    }
+
+    QVector<qint64> matching;
+    bool newTerms = pruned;
+
+    if(!m_filtering)
+        beginInsertRows(QModelIndex(), m_count, m_count + numNew - 1);
+
+    for(int i = skip; i < lines.size(); ++i)
+    {
+        int slot = (m_first + m_count) % m_capacity;
+        qint64 ordinal = m_numDropped + m_count;
+
+        if(slot == m_lines.size())
+            m_lines.append(lines[i]);
+        else
+            m_lines[slot] = lines[i];
+
+        if(m_index.add(ordinal, lines[i]))
+            newTerms = true;
+
+        if(m_filtering && m_filter.matches(lines[i]))
+            matching.append(ordinal);
+
+        ++m_count;
+    }
+
+    if(!m_filtering)
+        endInsertRows();
+    else
+        if(!matching.isEmpty())
+        {
+            int numRows = rowCount();
+
+            beginInsertRows(QModelIndex(), numRows, numRows + matching.size() - 1);
+            m_filtered += matching;
+            endInsertRows();
+        }
+
+    if(newTerms)
+        emit termsChanged();
+}
+
+void AnalyticsLogModel::dropFiltered()
+{
+    //matching lines that were just dropped off the buffer
+    int numDropped = 0;
+
+    while(m_filteredFirst + numDropped < m_filtered.size() && m_filtered[m_filteredFirst + numDropped] < m_numDropped)
+        ++numDropped;
+
+    if(numDropped > 0)
+    {
+        beginRemoveRows(QModelIndex(), 0, numDropped - 1);
+        m_filteredFirst += numDropped;
+        endRemoveRows();
+    }
+
+    //the front is only cut off once it is half the list, so dropping rows stays cheap
+    if(m_filteredFirst > m_filtered.size() / 2)
+    {
+        m_filtered.remove(0, m_filteredFirst);
+        m_filteredFirst = 0;
+    }
+}
+
+void AnalyticsLogModel::setFilter(const AnalyticsLogFilter &filter)
+{
+    beginResetModel();
+
+    m_filter = filter;
+    m_filtering = !filter.isEmpty();
+    m_filtered = m_filtering ? m_index.find(filter, m_numDropped) : QVector<qint64>();
+    m_filteredFirst = 0;
+
+    endResetModel();
+}
+
+void AnalyticsLogModel::clear()
+{
+    //the filter stays, it applies to whatever comes next
+    beginResetModel();
+    m_lines.clear();
+    m_first = 0;
+    m_count = 0;
+    m_numDropped = 0;
+    m_index.clear();
+    m_prunedAt = 0;
+    m_filtered.clear();
+    m_filteredFirst = 0;
+    endResetModel();
+
+    emit termsChanged();
+}
@@ -0,0 +1,88 @@
+#ifndef ANALYTICSLOGMODEL_H
+#define ANALYTICSLOGMODEL_H
+
+#include <QAbstractListModel>
+#include <QVector>
+#include <QList>
+
+#include "analyticsdelta.h"
+#include "analyticslogindex.h"
+
+///
+/// \brief Lines of the analytics log window, kept in a ring buffer of fixed capacity.
+///
+/// Once full, the oldest lines are dropped as new ones arrive, so appending costs the same however
+/// long the session has run. Lines keep their text and timestamp apart and are only formatted when
+/// the view asks for a visible row. Everything is kept on disk by the log writer anyway.
+///
+/// Lines are indexed as they are appended, so the model can be narrowed down to the lines matching
+/// a filter straight from the index. While filtered, only the rows of matching lines exist.
+///
+class AnalyticsLogModel : public QAbstractListModel
+{
+    Q_OBJECT
+public:
+    explicit AnalyticsLogModel(int capacity, QObject *parent = 0);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+    ///
+    /// \brief Add lines at the end, dropping the oldest ones if there is no room left
+    ///
+    void append(const QList<AnalyticsLogLine> &lines);
+
+    void clear();
+
+    ///
+    /// \brief Only show the lines matching the filter, or every line if it is empty
+    ///
+    void setFilter(const AnalyticsLogFilter &filter);
+    bool isFiltered() const {return m_filtering;}
+
+    ///
+    /// \brief Terms of a field that lines in the buffer have, for suggesting filters
+    ///
+    QStringList getTerms(AnalyticsLogLine::Field field) const {return m_index.getTerms(field);}
+
+    int getCapacity() const {return m_capacity;}
+
+    ///
+    /// \brief Lines in the buffer, whether or not they are filtered out
+    ///
+    int getNumLines() const {return m_count;}
+
+    ///
+    /// \brief How many lines have been dropped off the front since the last clear
+    ///
+    qint64 getNumDropped() const {return m_numDropped;}
+
+signals:
+    ///
+    /// \brief Terms were added by new lines or went with the old ones
+    ///
+    void termsChanged();
+
+private:
+    //lines are numbered from the first since the last clear, row 0 of the buffer is line m_numDropped
+    const AnalyticsLogLine &lineAt(int row) const {return m_lines[(m_first + row) % m_capacity];}
+    const AnalyticsLogLine &lineOfOrdinal(qint64 ordinal) const {return lineAt(int(ordinal - m_numDropped));}
+
+    void dropFiltered();
+
+    QVector<AnalyticsLogLine> m_lines;  //grows up to the capacity, then wraps around
+    int m_capacity;
+    int m_first;                        //slot of row 0
+    int m_count;
+    qint64 m_numDropped;
+
+    AnalyticsLogIndex m_index;
+    qint64 m_prunedAt;                  //m_numDropped when the index was last pruned
+
+    AnalyticsLogFilter m_filter;
+    bool m_filtering;
+    QVector<qint64> m_filtered;         //ordinals of the matching lines, from m_filteredFirst on
+    int m_filteredFirst;
+};
+
+#endif // ANALYTICSLOGMODEL_H
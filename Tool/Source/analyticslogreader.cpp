@@ -0,0 +1,236 @@
+#include "analyticslogreader.h"
+
+#include <QFileInfo>
+#include <QDebug>
+#include <cstring>
+
+#include "analyticssegmentedlog.h"
+
+AnalyticsLogReader::AnalyticsLogReader(const AnalyticsVerbTable &verbs)
+    : m_parser(verbs)
+    , m_fileIndex(-1)
+    , m_map(nullptr)
+    , m_lineMode(false)
+    , m_linePos(0)
+    , m_bytesBefore(0)
+    , m_totalBytes(0)
+    , m_error(false)
+{
+
+}
+
+AnalyticsLogReader::~AnalyticsLogReader()
+{
+    close();
+}
+
+bool AnalyticsLogReader::open(const QString &fileName)
+{
+    close();
+
+    if(AnalyticsSegmentedLog::isSegmentFile(fileName))
+    {
+        //read as it is, a log still being written or left by a crash is only recovered by the writer
+        m_files = AnalyticsSegmentedLog::segmentFiles(QFileInfo(fileName).path());
+    }
+    else
+        m_files.append(fileName);
+
+    for(int i = 0; i < m_files.size(); ++i)
+        m_totalBytes += sizeOf(i);
+
+    return openFile(0);
+}
+
+void AnalyticsLogReader::close()
+{
+    unmapFile();
+
+    m_files.clear();
+    m_fileIndex = -1;
+    m_bytesBefore = 0;
+    m_totalBytes = 0;
+    m_error = false;
+}
+
+bool AnalyticsLogReader::openFile(int index)
+{
+    if(m_fileIndex >= 0)
+    {
+        m_bytesBefore += m_data.size();
+        unmapFile();
+    }
+
+    m_fileIndex = index;
+
+    if(index >= m_files.size())
+        return false;
+
+    m_file.setFileName(m_files[index]);
+
+    if(AnalyticsSegmentedLog::isCompressedSegment(m_files[index]))
+    {
+        //bounded by the segment size, and only the frames that are whole
+        m_data = AnalyticsSegmentedLog::readSegment(m_files[index]);
+        m_lineMode = true;
+        m_linePos = 0;
+
+        return true;
+    }
+
+    if(!m_file.open(QIODevice::ReadOnly))
+    {
+        qDebug() << "Could not open" << m_files[index];
+        m_error = true;
+        return false;
+    }
+
+    //an empty segment can't be mapped and has nothing to read anyway
+    if(m_file.size() > 0)
+    {
+        m_map = m_file.map(0, m_file.size());
+
+        if(!m_map)
+        {
+            qDebug() << "Could not map" << m_files[index];
+            m_error = true;
+            return false;
+        }
+
+        m_data = QByteArray::fromRawData(reinterpret_cast<const char*>(m_map), int(m_file.size()));
+    }
+
+    //segments hold one event per line, log files a JSON array
+    int first = 0;
+    while(first < m_data.size() && (m_data[first] == ' ' || m_data[first] == '\t' || m_data[first] == '\r' || m_data[first] == '\n'))
+        ++first;
+
+    m_lineMode = first >= m_data.size() || m_data[first] != '[';
+    m_linePos = 0;
+
+    //stop at the last whole line, one torn by a crash or still being written is never read
+    if(m_lineMode)
+        m_data = QByteArray::fromRawData(m_data.constData(), m_data.lastIndexOf('\n') + 1);
+
+    if(!m_lineMode)
+        m_parser.setData(m_data);
+
+    return true;
+}
+
+void AnalyticsLogReader::unmapFile()
+{
+    m_data.clear();
+
+    if(m_map)
+        m_file.unmap(m_map);
+
+    m_map = nullptr;
+    m_file.close();
+}
+
+bool AnalyticsLogReader::next(AnalyticsEvent &event)
+{
+    while(!m_error && m_fileIndex >= 0 && m_fileIndex < m_files.size())
+    {
+        if(m_lineMode)
+        {
+            if(nextLine(event))
+                return true;
+        }
+        else
+        {
+            if(m_parser.next(event))
+                return true;
+
+            if(m_parser.hasError())
+            {
+                m_error = true;
+                return false;
+            }
+        }
+
+        openFile(m_fileIndex + 1);
+    }
+
+    return false;
+}
+
+bool AnalyticsLogReader::nextLine(AnalyticsEvent &event)
+{
+    const char *data = m_data.constData();
+
+    while(m_linePos < m_data.size())
+    {
+        const char *begin = data + m_linePos;
+        const char *newline = static_cast<const char*>(memchr(begin, '\n', size_t(m_data.size() - m_linePos)));
+        const char *end = newline ? newline : data + m_data.size();
+
+        m_linePos = newline ? end - data + 1 : m_data.size();
+
+        if(end == begin || (end - begin == 1 && *begin == '\r'))
+            continue;
+
+        m_parser.setData(QByteArray::fromRawData(begin, int(end - begin)));
+
+        if(m_parser.next(event))
+            return true;
+
+        //a bad line only loses that event
+        qDebug() << "Skipping malformed line in" << m_files[m_fileIndex];
+    }
+
+    m_linePos = m_data.size();
+    return false;
+}
+
+bool AnalyticsLogReader::seek(qint64 position)
+{
+    if(m_files.isEmpty())
+        return false;
+
+    unmapFile();
+    m_fileIndex = -1;
+    m_bytesBefore = 0;
+    m_error = false;
+
+    //positions run on from one segment to the next
+    int index = 0;
+    qint64 size = sizeOf(index);
+
+    while(index < m_files.size() - 1 && position - m_bytesBefore >= size)
+    {
+        m_bytesBefore += size;
+        size = sizeOf(++index);
+    }
+
+    if(!openFile(index))
+        return false;
+
+    qint64 offset = position - m_bytesBefore;
+
+    if(m_lineMode)
+        m_linePos = qBound(qint64(0), offset, qint64(m_data.size()));
+    else
+        if(offset > m_parser.getPosition())     //never back before the opening bracket
+            m_parser.setPosition(offset);
+
+    return true;
+}
+
+qint64 AnalyticsLogReader::sizeOf(int index) const
+{
+    //a torn line at the end is counted, it is only skipped once the segment is read
+    if(AnalyticsSegmentedLog::isSegmentFile(m_files[index]))
+        return AnalyticsSegmentedLog::segmentSize(m_files[index]);
+
+    return QFileInfo(m_files[index]).size();
+}
+
+qint64 AnalyticsLogReader::getBytesRead() const
+{
+    if(m_fileIndex < 0 || m_fileIndex >= m_files.size())
+        return m_totalBytes;
+
+    return m_bytesBefore + (m_lineMode ? m_linePos : m_parser.getPosition());
+}
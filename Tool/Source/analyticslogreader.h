@@ -0,0 +1,70 @@
+#ifndef ANALYTICSLOGREADER_H
+#define ANALYTICSLOGREADER_H
+
+#include <QString>
+#include <QStringList>
+#include <QByteArray>
+#include <QFile>
+
+#include "analyticsevent.h"
+
+///
+/// \brief Reads the events of a saved log one at a time, straight from a memory-mapped file.
+///
+/// Works with JSON array log files and with segmented logs (any segment opens the whole log,
+/// one segment mapped at a time). Nothing is copied out of the file except the event being
+/// decoded, so memory use doesn't depend on the size of the log. Compressed segments are
+/// decompressed one at a time instead of mapped, and positions count their decompressed bytes.
+/// The log is never written to: segments are read up to their last whole line or frame, so a
+/// log still being written, or not yet recovered after a crash, can be read as it is.
+///
+class AnalyticsLogReader
+{
+public:
+    AnalyticsLogReader(const AnalyticsVerbTable &verbs);
+    ~AnalyticsLogReader();
+
+    ///
+    /// \brief Open a JSON array log file, or the segmented log a segment file belongs to
+    ///
+    bool open(const QString &fileName);
+    void close();
+
+    ///
+    /// \brief Decode the next event, returns false at the end of the log or if it is malformed
+    ///
+    bool next(AnalyticsEvent &event);
+
+    bool hasError() const {return m_error;}
+
+    ///
+    /// \brief Carry on reading from a position returned by getBytesRead(), the log must not have changed since
+    ///
+    bool seek(qint64 position);
+
+    qint64 getBytesRead() const;
+    qint64 getTotalBytes() const {return m_totalBytes;}
+
+private:
+    bool openFile(int index);
+    qint64 sizeOf(int index) const;
+    void unmapFile();
+    bool nextLine(AnalyticsEvent &event);
+
+    AnalyticsEventParser m_parser;
+
+    QStringList m_files;
+    int m_fileIndex;
+
+    QFile m_file;
+    uchar *m_map;
+    QByteArray m_data;      //raw view of the mapped file, or the decompressed segment
+    bool m_lineMode;        //one event per line (segments) instead of a JSON array
+    qint64 m_linePos;
+
+    qint64 m_bytesBefore;   //sizes of the files already read
+    qint64 m_totalBytes;
+    bool m_error;
+};
+
+#endif // ANALYTICSLOGREADER_H
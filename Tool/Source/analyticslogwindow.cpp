@@ -1,61 +1,185 @@
 #include "analyticslogwindow.h"
 #include <QDir>
+#include <QFileInfo>
+#include <QKeyEvent>
+#include <QApplication>
+#include <QClipboard>
+#include <algorithm>
+
+#include "analyticslogwriter.h"
+#include "analyticslogmodel.h"
+#include "analyticslogfilterbar.h"
+#include "analyticssegmentedlog.h"
+
+static const int kMaxLines = 100000;        //lines shown in the window, older ones are only in the log files
 
 AnalyticsLogWindow::AnalyticsLogWindow(QWidget *parent)
-    : QPlainTextEdit(parent)
+    : QListView(parent)
+    , m_lineModel(new AnalyticsLogModel(kMaxLines, this))
+    , m_filterBar(new AnalyticsLogFilterBar(this))
+    , m_writerThread(new QThread(this))
+    , m_logWriter(new AnalyticsLogWriter())
 {
-    QPlainTextEdit::setReadOnly(true);
+    //every row is one line of text, so the view never has to measure rows it isn't showing
+    setModel(m_lineModel);
+    setUniformItemSizes(true);
+    setEditTriggers(QAbstractItemView::NoEditTriggers);
+    setSelectionMode(QAbstractItemView::ExtendedSelection);
+
+    //the filter bar sits in a margin above the lines, like the header of a table
+    setViewportMargins(0, m_filterBar->sizeHint().height(), 0, 0);
+    connect(m_filterBar, &AnalyticsLogFilterBar::filterChanged, this, &AnalyticsLogWindow::onFilterChanged);
+    connect(m_lineModel, &AnalyticsLogModel::termsChanged, this, &AnalyticsLogWindow::onTermsChanged);
+
+    //file writes and syncs never hold up the GUI
+    m_logWriter->moveToThread(m_writerThread);
+    connect(m_writerThread, &QThread::finished, m_logWriter, &QObject::deleteLater);
+    m_writerThread->start();
 }
 
 AnalyticsLogWindow::~AnalyticsLogWindow()
 {
-    if(m_fileInitialised && !m_jsonEvents.empty())  //export to file if cross button is pressed without disconnecting
+    foreach (int sessionId, m_sessionLogs.keys())
     {
-        exportToFile();
+        if(m_sessionLogs[sessionId].fileInitialised)  //export to file if cross button is pressed without disconnecting
+        {
+            //wait for it, the writer stops with the window
+            QMetaObject::invokeMethod(m_logWriter, "closeLog", Qt::BlockingQueuedConnection, Q_ARG(int, sessionId));
+        }
     }
+
+    m_writerThread->quit();
+    m_writerThread->wait();
 }
 
-void AnalyticsLogWindow::initialiseLogFile(QString fileName)
+void AnalyticsLogWindow::initialiseLogFile(QString fileName, int sessionId)
 {
+    SessionLog &log = m_sessionLogs[sessionId];
+
     if(fileName == "")
     {
         if(!QDir("logs").exists())
             QDir().mkdir("logs");
 
+        //a directory of segments, see AnalyticsSegmentedLog
         QDateTime current = QDateTime::currentDateTime().toUTC();
-        m_fileName = "logs/" + current.toString("yyyy.MM.dd_hh-mm-ss-t_logFile") + ".json";
+        log.fileName = "logs/" + current.toString("yyyy.MM.dd_hh-mm-ss-t_logFile");
+
+        if(sessionId != 0)  //players connected at the same time would otherwise share a file
+            log.fileName += "_player" + QString::number(sessionId);
     }
     else
-        m_fileName = fileName;
+        if(AnalyticsSegmentedLog::isSegmentFile(fileName))  //saved next to the segmented log it was replayed from
+            log.fileName = QFileInfo(fileName).path() + ".json";
+        else
+            log.fileName = fileName;
+
+    log.fileInitialised = true;
 
-    m_logFile.setFileName(m_fileName);
-    m_fileInitialised = true;
+    m_logWriter->openLog(sessionId, log.fileName);
 }
 
 void AnalyticsLogWindow::appendToWindow(const QString& text)
 {
-    this->appendPlainText(text); // Adds the message to the widget
-    this->verticalScrollBar()->setValue(this->verticalScrollBar()->maximum()); // Scrolls to the bottom
+    appendToWindow(QList<AnalyticsLogLine>() << AnalyticsLogLine(text));
 }
 
-void AnalyticsLogWindow::appendToLogFile(const QJsonObject& obj)
+void AnalyticsLogWindow::appendToWindow(const QList<AnalyticsLogLine>& lines)
 {
-    m_jsonEvents.append(obj);
+    if(lines.isEmpty())
+        return;
+
+    //only follow new lines if the user hasn't scrolled up to read something
+    bool atBottom = verticalScrollBar()->value() == verticalScrollBar()->maximum();
+
+    m_lineModel->append(lines);     //one insert and scroll for the whole batch
+
+    if(m_lineModel->isFiltered())
+        m_filterBar->setNumMatches(m_lineModel->rowCount(), m_lineModel->getNumLines());
+
+    if(atBottom)
+        scrollToBottom(); // Scrolls to the bottom
 }
 
-void AnalyticsLogWindow::exportToFile()
+void AnalyticsLogWindow::clearWindow()
 {
-    //called at the end to save data to the file
-    QJsonDocument jsonDoc;
+    m_lineModel->clear();
+    m_filterBar->setNumMatches(0, 0);
+}
 
-    m_logFile.open(QIODevice::ReadWrite | QIODevice::Truncate | QIODevice::Text);   //open the file and set to overwrite
+bool AnalyticsLogWindow::hasLines() const
+{
+    return m_lineModel->getNumLines() > 0;
+}
 
-    jsonDoc.setArray(m_jsonEvents);
+void AnalyticsLogWindow::resizeEvent(QResizeEvent *event)
+{
+    QListView::resizeEvent(event);
 
-    QTextStream outputStream(&m_logFile);   //write updated (or new) array then close the file
-    outputStream << jsonDoc.toJson();
+    QRect viewport = viewport()->geometry();
+    m_filterBar->setGeometry(viewport.left(), frameWidth(), viewport.width(), viewport.top() - frameWidth());
+}
 
-    m_logFile.close();  //close log file and clear json array
-    m_jsonEvents = QJsonArray();
-    m_fileInitialised = false;
+void AnalyticsLogWindow::onFilterChanged(AnalyticsLogFilter filter)
+{
+    //answered from the index, however many lines the buffer holds
+    m_lineModel->setFilter(filter);
+    m_filterBar->setNumMatches(m_lineModel->rowCount(), m_lineModel->getNumLines());
+
+    scrollToBottom();
 }
+
+void AnalyticsLogWindow::onTermsChanged()
+{
+    for(int i = 0; i < AnalyticsLogLine::FIELD_COUNT; ++i)
+        m_filterBar->setTerms(AnalyticsLogLine::Field(i), m_lineModel->getTerms(AnalyticsLogLine::Field(i)));
+}
+
+void AnalyticsLogWindow::keyPressEvent(QKeyEvent *event)
+{
+    if(!event->matches(QKeySequence::Copy))
+    {
+        QListView::keyPressEvent(event);
+        return;
+    }
+
+    //copy the selected lines as text, like the text box this used to be
+    QModelIndexList selected = selectionModel()->selectedRows();
+    std::sort(selected.begin(), selected.end());
+
+    QStringList lines;
+    foreach (const QModelIndex &index, selected)
+        lines.append(index.data().toString());
+
+    QApplication::clipboard()->setText(lines.join('\n'));
+}
+
+void AnalyticsLogWindow::appendToLogFile(const QByteArray& event, int sessionId)
+{
+    if(m_sessionLogs.value(sessionId).fileInitialised)
+        m_logWriter->append(sessionId, event);
+}
+
+void AnalyticsLogWindow::exportToFile(int sessionId)
+{
+    //called at the end, the writer turns what it streamed to disk into the JSON array log file
+    if(m_sessionLogs.value(sessionId).fileInitialised)
+        QMetaObject::invokeMethod(m_logWriter, "closeLog", Qt::QueuedConnection, Q_ARG(int, sessionId));
+
+    m_sessionLogs.remove(sessionId);
+}
+
+void AnalyticsLogWindow::discardLogFile(int sessionId)
+{
+    if(m_sessionLogs.value(sessionId).fileInitialised)
+        m_logWriter->discardLog(sessionId);
+
+    m_sessionLogs.remove(sessionId);
+}
+
+void AnalyticsLogWindow::setLogDictionary(const QByteArray &dictionary)
+{
+    //queued ahead of any log opened after it
+    QMetaObject::invokeMethod(m_logWriter, "setDictionary", Qt::QueuedConnection, Q_ARG(QByteArray, dictionary));
+}
+
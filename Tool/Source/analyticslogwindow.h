@@ -1,34 +1,77 @@
 #ifndef ANALYTICSLOGWINDOW_H
 #define ANALYTICSLOGWINDOW_H
 
-#include <QPlainTextEdit>
+#include <QListView>
 #include <QScrollBar>
-#include <QTextStream>
 #include <QDateTime>
 #include <QDebug>
-#include <QJsonDocument>
-#include <QJsonArray>
-#include <QJsonObject>
+#include <QHash>
+#include <QThread>
 
-class AnalyticsLogWindow : public QPlainTextEdit
+#include "analyticsdelta.h"
+#include "analyticslogindex.h"
+
+class AnalyticsLogWriter;
+class AnalyticsLogModel;
+class AnalyticsLogFilterBar;
+
+///
+/// \brief Log widget at the bottom of the tool, also keeps the log file of each session.
+///
+/// Only the newest lines are shown, from a ring buffer whose rows are formatted as they scroll
+/// into view, so a long session costs no more to show than a short one. Events are streamed to
+/// disk by an AnalyticsLogWriter as they arrive, none are kept in memory.
+/// A filter bar above the lines narrows them down to an actor, verb, object or curator label.
+///
+class AnalyticsLogWindow : public QListView
 {
     Q_OBJECT
 
 public:
     AnalyticsLogWindow(QWidget *parent);
     ~AnalyticsLogWindow();
-    void initialiseLogFile(QString fileName = "");
+    void initialiseLogFile(QString fileName = "", int sessionId = 0);
     void appendToWindow(const QString& text);
-    void appendToLogFile(const QJsonObject& obj);
-    void exportToFile();
+    void appendToWindow(const QList<AnalyticsLogLine>& lines);
+    void clearWindow();
+    bool hasLines() const;
+    void appendToLogFile(const QByteArray& event, int sessionId = 0);
+    void exportToFile(int sessionId = 0);
+
+    ///
+    /// \brief Stop logging a session without saving it, e.g. a replay that was cancelled
+    ///
+    void discardLogFile(int sessionId = 0);
+
+    ///
+    /// \brief Compress the logs of sessions started from now on with the dictionary, see AnalyticsLogCompression
+    ///
+    void setLogDictionary(const QByteArray &dictionary);
+
+protected:
+    void keyPressEvent(QKeyEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
 
-    bool isEmpty(){return m_jsonEvents.isEmpty();}
+private slots:
+    void onFilterChanged(AnalyticsLogFilter filter);
+    void onTermsChanged();
 
 private:
-    QFile m_logFile;
-    QString m_fileName;
-    bool m_fileInitialised;
-    QJsonArray m_jsonEvents;
+    struct SessionLog
+    {
+        SessionLog() : fileInitialised(false) {}
+
+        QString fileName;
+        bool fileInitialised;
+    };
+
+    QHash<int, SessionLog> m_sessionLogs;   //one log file per connected player
+
+    AnalyticsLogModel *m_lineModel;
+    AnalyticsLogFilterBar *m_filterBar;
+
+    QThread *m_writerThread;
+    AnalyticsLogWriter *m_logWriter;
 };
 
 #endif // ANALYTICSLOGWINDOW_H
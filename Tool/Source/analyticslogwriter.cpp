@@ -0,0 +1,250 @@
+#include "analyticslogwriter.h"
+
+#include <QFile>
+#include <QBuffer>
+#include <QJsonDocument>
+#include <QMutexLocker>
+#include <QDir>
+#include <QDebug>
+
+#include "analyticssegmentedlog.h"
+
+static const int kFlushInterval = 100;  //ms between writes to the logs
+static const int kSyncInterval = 1000;  //ms between syncs to disk, at most this much is lost in a crash
+
+static const QString kName_JournalSuffix = ".journal";
+
+AnalyticsLogWriter::AnalyticsLogWriter(QObject *parent)
+    : QObject(parent)
+    , m_flushTimer(new QTimer(this))
+{
+    m_flushTimer->setInterval(kFlushInterval);
+    connect(m_flushTimer, SIGNAL(timeout()), this, SLOT(flush()));
+}
+
+AnalyticsLogWriter::~AnalyticsLogWriter()
+{
+    //sessions still open keep their segments, they can be loaded next time
+    flush();
+
+    foreach (const SessionJournal &journal, m_journals)
+        delete journal.log;
+}
+
+QString AnalyticsLogWriter::logDirectory(const QString &logFileName)
+{
+    //live sessions are logged straight to a directory of segments
+    if(logFileName.endsWith(".json"))
+        return logFileName.left(logFileName.size() - 5) + kName_JournalSuffix;
+
+    return logFileName;
+}
+
+static bool isCompleteEvent(const QByteArray &line, bool terminated)
+{
+    //only the last line can be torn, by a crash in the middle of a write
+    return terminated || !QJsonDocument::fromJson(line).isNull();
+}
+
+bool AnalyticsLogWriter::convertToJsonArray(const QString &directory, const QString &logFile)
+{
+    QFile log(logFile);
+
+    if(!AnalyticsSegmentedLog::recover(directory))
+    {
+        qDebug() << "No log segments in" << directory;
+        return false;
+    }
+
+    if(!log.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text))
+    {
+        qDebug() << "Could not write log file" << logFile;
+        return false;
+    }
+
+    bool first = true;
+
+    log.write("[\n");
+
+    foreach (const QString &segmentFile, AnalyticsSegmentedLog::segmentFiles(directory))
+    {
+        //one segment in memory at a time, decompressed if it has to be
+        QBuffer segment;
+        segment.setData(AnalyticsSegmentedLog::readSegment(segmentFile));
+
+        if(!segment.open(QIODevice::ReadOnly))
+            return false;
+
+        while(!segment.atEnd())
+        {
+            QByteArray line = segment.readLine();
+            bool terminated = line.endsWith('\n');
+
+            if(terminated)
+                line.chop(1);
+
+            if(line.isEmpty() || !isCompleteEvent(line, terminated))
+                continue;
+
+            if(!first)
+                log.write(",\n");
+
+            log.write(line);
+            first = false;
+        }
+    }
+
+    log.write(first ? "]\n" : "\n]\n");
+
+    return log.error() == QFile::NoError;
+}
+
+void AnalyticsLogWriter::append(int sessionId, const QByteArray &event)
+{
+    QMutexLocker locker(&m_pendingMutex);
+
+    PendingEvent pendingEvent;
+    pendingEvent.generation = m_generations.value(sessionId, 0);
+    pendingEvent.event = event;
+
+    m_pending[sessionId].append(pendingEvent);
+}
+
+void AnalyticsLogWriter::openLog(int sessionId, const QString &logFileName)
+{
+    int generation;
+
+    {
+        QMutexLocker locker(&m_pendingMutex);
+        generation = ++m_generations[sessionId];
+    }
+
+    //events appended from now on are for this log, they wait for it to start
+    QMetaObject::invokeMethod(this, "startLog", Qt::QueuedConnection, Q_ARG(int, sessionId), Q_ARG(QString, logFileName), Q_ARG(int, generation));
+}
+
+void AnalyticsLogWriter::discardLog(int sessionId)
+{
+    {
+        //only the events queued so far are for the log being discarded
+        QMutexLocker locker(&m_pendingMutex);
+        m_pending.remove(sessionId);
+    }
+
+    QMetaObject::invokeMethod(this, "removeLog", Qt::QueuedConnection, Q_ARG(int, sessionId));
+}
+
+void AnalyticsLogWriter::startLog(int sessionId, QString logFileName, int generation)
+{
+    if(m_journals.contains(sessionId))
+        closeLog(sessionId);
+
+    SessionJournal &journal = m_journals[sessionId];
+    journal.logFileName = logFileName;
+    journal.log = new AnalyticsSegmentedLog();
+    journal.generation = generation;
+
+    m_startedGenerations[sessionId] = generation;
+
+    //a journal only lives until it is turned into a log file, so it isn't worth compressing
+    QString directory = logDirectory(logFileName);
+    journal.log->setCompression(directory == logFileName, m_dictionary);
+
+    if(!journal.log->create(directory))
+        qDebug() << "Could not start log" << logFileName;
+
+    if(!m_flushTimer->isActive())
+    {
+        m_sinceSync.start();
+        m_flushTimer->start();
+    }
+}
+
+void AnalyticsLogWriter::closeLog(int sessionId)
+{
+    if(!m_journals.contains(sessionId))
+        return;
+
+    flush();
+
+    SessionJournal journal = m_journals.take(sessionId);
+    QString directory = journal.log->getDirectory();
+
+    journal.log->close();
+    delete journal.log;
+
+    //the segments are only removed once the log file is safely written
+    if(directory != journal.logFileName && convertToJsonArray(directory, journal.logFileName))
+        QDir(directory).removeRecursively();
+
+    if(m_journals.isEmpty())
+        m_flushTimer->stop();
+}
+
+void AnalyticsLogWriter::removeLog(int sessionId)
+{
+    if(!m_journals.contains(sessionId))
+        return;
+
+    SessionJournal journal = m_journals.take(sessionId);
+    QString directory = journal.log->getDirectory();
+
+    delete journal.log;
+
+    //only a journal can be thrown away, a live session's segments are its log
+    if(directory != journal.logFileName)
+        QDir(directory).removeRecursively();
+
+    if(m_journals.isEmpty())
+        m_flushTimer->stop();
+}
+
+void AnalyticsLogWriter::flush()
+{
+    QHash<int, QList<PendingEvent>> pending;
+    QHash<int, QList<PendingEvent>> waiting;    //for logs opened but not yet started
+
+    {
+        QMutexLocker locker(&m_pendingMutex);
+        pending.swap(m_pending);
+    }
+
+    for(QHash<int, QList<PendingEvent>>::const_iterator pendingIt = pending.constBegin(); pendingIt != pending.constEnd(); ++pendingIt)
+    {
+        int sessionId = pendingIt.key();
+        QHash<int, SessionJournal>::const_iterator journalIt = m_journals.constFind(sessionId);
+        int startedGeneration = m_startedGenerations.value(sessionId, 0);
+        int numDropped = 0;
+
+        foreach (const PendingEvent &pendingEvent, pendingIt.value())
+        {
+            if(journalIt != m_journals.constEnd() && pendingEvent.generation == journalIt->generation)
+                journalIt->log->append(pendingEvent.event);
+            else
+                if(pendingEvent.generation > startedGeneration)
+                    waiting[sessionId].append(pendingEvent);
+                else
+                    ++numDropped;   //its log was closed or never opened
+        }
+
+        if(numDropped > 0)
+            qDebug() << numDropped << "events of session" << sessionId << "arrived without a log file";
+    }
+
+    if(!waiting.isEmpty())
+    {
+        //ahead of anything appended since the swap
+        QMutexLocker locker(&m_pendingMutex);
+
+        for(QHash<int, QList<PendingEvent>>::iterator waitingIt = waiting.begin(); waitingIt != waiting.end(); ++waitingIt)
+            m_pending[waitingIt.key()] = waitingIt.value() + m_pending.value(waitingIt.key());
+    }
+
+    if(m_sinceSync.isValid() && m_sinceSync.elapsed() >= kSyncInterval)
+    {
+        foreach (const SessionJournal &journal, m_journals)
+            journal.log->sync();
+
+        m_sinceSync.restart();
+    }
+}
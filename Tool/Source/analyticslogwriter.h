@@ -0,0 +1,108 @@
+#ifndef ANALYTICSLOGWRITER_H
+#define ANALYTICSLOGWRITER_H
+
+#include <QObject>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QHash>
+#include <QByteArray>
+#include <QString>
+#include <QList>
+
+#include "analyticsdelta.h"
+
+class AnalyticsSegmentedLog;
+
+///
+/// \brief Streams the events of every session to disk as they arrive, on its own thread.
+///
+/// Each session is written to an AnalyticsSegmentedLog, a directory of newline-delimited JSON
+/// segments. Events are buffered and written in the background every few frames and synced to
+/// disk about once a second, so at most that much is lost in a crash. A session saved to a
+/// ".json" file (a replayed log) is turned into the JSON array format when it ends. The segments
+/// of live sessions are compressed with a dictionary of the current tasks and spatial graph.
+///
+class AnalyticsLogWriter : public QObject
+{
+    Q_OBJECT
+public:
+    explicit AnalyticsLogWriter(QObject *parent = 0);
+    ~AnalyticsLogWriter();
+
+    ///
+    /// \brief Directory the segments of a log are written to, "x.json" is journalled to "x.journal"
+    ///
+    static QString logDirectory(const QString &logFileName);
+
+    ///
+    /// \brief Write a segmented log as a JSON array log file, a line at a time so memory stays bounded
+    ///
+    static bool convertToJsonArray(const QString &directory, const QString &logFile);
+
+    ///
+    /// \brief Queue an event for the log last opened for a session, safe to call from any thread
+    ///
+    /// Events are kept until their log has been opened on the writer's thread.
+    ///
+    void append(int sessionId, const QByteArray &event);
+
+    ///
+    /// \brief Start logging a session to logFileName, replacing an old log there, safe to call from any thread
+    ///
+    void openLog(int sessionId, const QString &logFileName);
+
+    ///
+    /// \brief Close a log and remove what was written of it, safe to call from any thread
+    ///
+    /// The file it would have replaced is left alone, and events for a log opened after it are kept.
+    ///
+    void discardLog(int sessionId);
+
+public slots:
+    ///
+    /// \brief Dictionary the logs of live sessions opened from now on are compressed with
+    ///
+    void setDictionary(QByteArray dictionary){m_dictionary = dictionary;}
+
+    ///
+    /// \brief Write out and sync what is left and close the log, converting it if it is a ".json" file
+    ///
+    void closeLog(int sessionId);
+
+private slots:
+    void flush();
+
+    void startLog(int sessionId, QString logFileName, int generation);
+    void removeLog(int sessionId);
+
+private:
+    struct SessionJournal
+    {
+        SessionJournal() : log(nullptr), generation(0) {}
+
+        QString logFileName;
+        AnalyticsSegmentedLog *log;
+        int generation;
+    };
+
+    struct PendingEvent
+    {
+        int generation;     //of the log it was appended for
+        QByteArray event;   //compact JSON, one line of the log
+    };
+
+    QMutex m_pendingMutex;
+    QHash<int, QList<PendingEvent>> m_pending;  //events not yet handed to the logs
+    QHash<int, int> m_generations;              //of the log last opened for each session, 0 for none
+
+    QHash<int, SessionJournal> m_journals;  //only used on the writer's thread
+    QHash<int, int> m_startedGenerations;   //of the log last started for each session, on the writer's thread
+
+    QTimer *m_flushTimer;
+    QElapsedTimer m_sinceSync;
+
+    QByteArray m_dictionary;
+};
+
+#endif // ANALYTICSLOGWRITER_H
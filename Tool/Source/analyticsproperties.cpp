@@ -2,6 +2,10 @@
 
 #include <QVBoxLayout>
 #include <QGridLayout>
+#include <QHBoxLayout>
+#include <QComboBox>
+#include <QSlider>
+#include <QTime>
 
 #include "collapsible.h"
 #include "curatoranalyticseditor.h"
@@ -14,8 +18,15 @@ static const QString kName_NarrativeNodesWithoutConnection = "Number of Gameplay
 static const QString kName_NarrativeNodesAverageConnection = "Average Number of Story Connections: ";
 static const QString kName_NumConnection = "Total Number of Gameplay-Story Connections: ";
 
+static const int kAllSessions = -1;
+
 static float maxLostness = sqrt(2);
 
+static QString formatReplayTime(int secs)
+{
+    return QTime(0, 0).addSecs(secs).toString("h:mm:ss");
+}
+
 AnalyticsProperties::AnalyticsProperties(Collapsible *parent)
 : QWidget(parent)
 , m_pCollapsible(parent)
@@ -48,6 +59,43 @@ AnalyticsProperties::AnalyticsProperties(Collapsible *parent)
     m_mainLayout->addWidget(m_narrativeNodesAverageConnections);
     m_mainLayout->addWidget(m_totalConnections);
 
+    //only shown when several players can be connected
+    m_sessionSelectorWidget = new QWidget(this);
+    m_sessionSelector = new QComboBox(m_sessionSelectorWidget);
+    QHBoxLayout *sessionSelectorLayout = new QHBoxLayout(m_sessionSelectorWidget);
+    sessionSelectorLayout->setContentsMargins(0, 8, 0, 0);
+    sessionSelectorLayout->addWidget(new QLabel("Player", m_sessionSelectorWidget));
+    sessionSelectorLayout->addWidget(m_sessionSelector, 1);
+    m_mainLayout->addWidget(m_sessionSelectorWidget);
+    clearSessions();
+    m_sessionSelectorWidget->hide();
+
+    connect(m_sessionSelector, static_cast<void(QComboBox::*)(int)>(&QComboBox::activated),
+            [=](int index){sessionSelected(m_sessionSelector->itemData(index).toInt());});
+
+    //only shown once a log has been replayed
+    m_replayTimelineWidget = new QWidget(this);
+    m_replaySlider = new QSlider(Qt::Horizontal, m_replayTimelineWidget);
+    m_replayTimeLabel = new QLabel(m_replayTimelineWidget);
+    m_replayFirstMsecs = 0;
+    QHBoxLayout *replayTimelineLayout = new QHBoxLayout(m_replayTimelineWidget);
+    replayTimelineLayout->setContentsMargins(0, 8, 0, 0);
+    replayTimelineLayout->addWidget(new QLabel("Replay", m_replayTimelineWidget));
+    replayTimelineLayout->addWidget(m_replaySlider, 1);
+    replayTimelineLayout->addWidget(m_replayTimeLabel);
+    m_mainLayout->addWidget(m_replayTimelineWidget);
+    m_replayTimelineWidget->hide();
+
+    //each seek replays events, so only ask for one when the slider is let go
+    m_replaySlider->setTracking(false);
+
+    connect(m_replaySlider, &QSlider::sliderMoved,
+            [=](int secs){m_replayTimeLabel->setText(formatReplayTime(secs) + " / " + formatReplayTime(m_replaySlider->maximum()));});
+    connect(m_replaySlider, &QSlider::valueChanged, [=](int secs){
+        m_replayTimeLabel->setText(formatReplayTime(secs) + " / " + formatReplayTime(m_replaySlider->maximum()));
+        replayTimeSelected(m_replayFirstMsecs + qint64(secs) * 1000);
+    });
+
     // update the title of the collapsible container
     m_pCollapsible->updateTitle("Analytics - Disconnected");
 }
@@ -62,6 +110,55 @@ void AnalyticsProperties::DisconnectedFromServer()
     m_pCollapsible->updateTitle("Analytics - Disconnected");
 }
 
+void AnalyticsProperties::ReconnectingToServer(QString address)
+{
+    m_pCollapsible->updateTitle("Analytics - Reconnecting to: " + address);
+}
+
+void AnalyticsProperties::ListeningForPlayers(int port)
+{
+    m_pCollapsible->updateTitle("Analytics - Listening on port: " + QString::number(port));
+}
+
+void AnalyticsProperties::showSessionSelector(bool show)
+{
+    m_sessionSelectorWidget->setVisible(show);
+}
+
+void AnalyticsProperties::addSession(int sessionId, QString name)
+{
+    if(m_sessionSelector->findData(sessionId) == -1)
+        m_sessionSelector->addItem(name, sessionId);
+}
+
+void AnalyticsProperties::clearSessions()
+{
+    m_sessionSelector->clear();
+    m_sessionSelector->addItem("All players", kAllSessions);
+}
+
+void AnalyticsProperties::showReplayTimeline(qint64 firstMsecs, qint64 lastMsecs)
+{
+    int length = int((lastMsecs - firstMsecs + 999) / 1000);
+
+    m_replayFirstMsecs = firstMsecs;
+
+    //the whole log has been replayed, so the slider starts at the end
+    m_replaySlider->blockSignals(true);
+    m_replaySlider->setRange(0, length);
+    m_replaySlider->setPageStep(qMax(1, length / 20));
+    m_replaySlider->setValue(length);
+    m_replaySlider->blockSignals(false);
+
+    m_replayTimeLabel->setText(formatReplayTime(length) + " / " + formatReplayTime(length));
+    m_replayTimelineWidget->show();
+}
+
+void AnalyticsProperties::hideReplayTimeline()
+{
+    m_replayTimelineWidget->hide();
+}
+
 void AnalyticsProperties::UpdateLinkerValues(QList<zodiac::NodeHandle> &nodes)
 {
     float sNodesWithConnections = 0;
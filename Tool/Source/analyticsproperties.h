@@ -10,6 +10,8 @@
 class Collapsible;
 class QVBoxLayout;
 class QGridLayout;
+class QComboBox;
+class QSlider;
 struct CuratorLabel;
 struct CuratorObjective;
 
@@ -43,6 +45,41 @@ public:// methods
     ///
     void DisconnectedFromServer();
 
+    ///
+    /// \brief Show the connection to the server dropped and is being retried
+    ///
+    void ReconnectingToServer(QString address);
+
+    ///
+    /// \brief Show the port used to listen for players
+    ///
+    void ListeningForPlayers(int port);
+
+    ///
+    /// \brief Show or hide the player selector, only used when listening for players
+    ///
+    void showSessionSelector(bool show);
+
+    ///
+    /// \brief Add a player to the player selector
+    ///
+    void addSession(int sessionId, QString name);
+
+    ///
+    /// \brief Remove all players from the player selector, leaving the option to show all of them
+    ///
+    void clearSessions();
+
+    ///
+    /// \brief Show the slider used to go to any time of a replayed log
+    ///
+    void showReplayTimeline(qint64 firstMsecs, qint64 lastMsecs);
+
+    ///
+    /// \brief Hide the replay slider, the log it was for can't be seeked any more
+    ///
+    void hideReplayTimeline();
+
     ///
     /// \brief Show all of the properties for in-game analytics
     ///
@@ -98,6 +135,17 @@ public:// methods
     ///
     void resetAllCuratorLabels();
 
+signals:
+    ///
+    /// \brief A player was picked in the player selector, -1 for all players
+    ///
+    void sessionSelected(int sessionId);
+
+    ///
+    /// \brief The replay slider was let go at a time, in milliseconds since the epoch
+    ///
+    void replayTimeSelected(qint64 msecs);
+
 public slots:
     ///
     /// \brief Updates the values for links between story and narrative nodes
@@ -161,6 +209,36 @@ private:
     ///
     QLabel *m_totalConnections;
 
+    ///
+    /// \brief Label and combo box used to pick the player shown
+    ///
+    QWidget *m_sessionSelectorWidget;
+
+    ///
+    /// \brief Selects the player shown, or all of them
+    ///
+    QComboBox *m_sessionSelector;
+
+    ///
+    /// \brief Label, slider and time of the replay timeline
+    ///
+    QWidget *m_replayTimelineWidget;
+
+    ///
+    /// \brief Seconds since the first event of the replayed log
+    ///
+    QSlider *m_replaySlider;
+
+    ///
+    /// \brief Time the slider is at and length of the log
+    ///
+    QLabel *m_replayTimeLabel;
+
+    ///
+    /// \brief Time of the first event of the replayed log
+    ///
+    qint64 m_replayFirstMsecs;
+
     ///
     /// \brief Layout of the widgets related to the curator labels.
     ///
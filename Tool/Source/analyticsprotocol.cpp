@@ -0,0 +1,95 @@
+#include "analyticsprotocol.h"
+
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QtEndian>
+
+static const char kStreamPreamble[] = {char(0xD9), char(0xD9), char(0xF7)};   //tag 55799, "self-described CBOR"
+
+static const QString kName_HelloKey = "analyticsHello";
+static const QString kName_FormatsKey = "formats";
+static const QString kName_ResumeKey = "resumeAfter";
+static const QString kName_AckKey = "ack";
+static const QString kName_FormatCbor = "cbor";
+static const QString kName_FormatJson = "json";
+static const int kHelloVersion = 1;
+
+QByteArray AnalyticsProtocol::streamPreamble()
+{
+    return QByteArray::fromRawData(kStreamPreamble, int(sizeof(kStreamPreamble)));
+}
+
+QByteArray AnalyticsProtocol::helloMessage(bool offerBinary, qint64 resumeAfter)
+{
+    QJsonArray formats;
+
+    if(offerBinary)
+        formats.append(kName_FormatCbor);
+
+    formats.append(kName_FormatJson);
+
+    QJsonObject hello;
+    hello[kName_HelloKey] = kHelloVersion;
+    hello[kName_FormatsKey] = formats;
+
+    if(resumeAfter >= 0)
+        hello[kName_ResumeKey] = double(resumeAfter);
+
+    return QJsonDocument(hello).toJson(QJsonDocument::Compact);
+}
+
+bool AnalyticsProtocol::readHello(const QByteArray &message, bool &offersBinary, qint64 &resumeAfter)
+{
+    QJsonObject hello = QJsonDocument::fromJson(message).object();
+
+    if(!hello.contains(kName_HelloKey))
+        return false;
+
+    offersBinary = hello[kName_FormatsKey].toArray().contains(kName_FormatCbor);
+    resumeAfter = hello.contains(kName_ResumeKey) ? qint64(hello[kName_ResumeKey].toDouble()) : -1;
+
+    return true;
+}
+
+QByteArray AnalyticsProtocol::ackMessage(qint64 sequence)
+{
+    //written by hand, sent several times a second
+    QByteArray message = "{\"ack\":";
+    message += QByteArray::number(sequence);
+    message += '}';
+
+    return message;
+}
+
+bool AnalyticsProtocol::readAck(const QByteArray &message, qint64 &sequence)
+{
+    QJsonObject ack = QJsonDocument::fromJson(message).object();
+
+    if(!ack.contains(kName_AckKey))
+        return false;
+
+    sequence = qint64(ack[kName_AckKey].toDouble());
+
+    return true;
+}
+
+QByteArray AnalyticsProtocol::frame(const QByteArray &message, FramingMode framing)
+{
+    QByteArray framed;
+    framed.reserve(message.size() + 4);
+
+    if(framing == FRAMING_LENGTH_PREFIXED)
+    {
+        framed.resize(4);
+        qToBigEndian<quint32>(quint32(message.size()), reinterpret_cast<uchar*>(framed.data()));
+        framed += message;
+    }
+    else
+    {
+        framed += message;
+        framed += '\n';
+    }
+
+    return framed;
+}
@@ -0,0 +1,49 @@
+#ifndef ANALYTICSPROTOCOL_H
+#define ANALYTICSPROTOCOL_H
+
+#include <QByteArray>
+
+#include "analyticsframer.h"
+
+///
+/// \brief Control messages exchanged with the game on top of the event stream.
+///
+/// After connecting, the tool sends a hello that lists the event formats it accepts and the last
+/// event sequence number it has handled. A game that supports the binary format starts its stream with
+/// the CBOR self-describe tag (D9 D9 F7) and then sends every event as a length-prefixed CBOR
+/// map. Games that number their events ("seq") get acknowledgements back, and after a
+/// reconnect they only resend the events after the one named in the hello. Older games ignore
+/// all of this and keep sending JSON text.
+///
+class AnalyticsProtocol
+{
+public:
+    ///
+    /// \brief Bytes a binary stream starts with, can't be the start of JSON text or a valid length prefix
+    ///
+    static QByteArray streamPreamble();
+
+    ///
+    /// \brief Hello sent by the tool after connecting, resumeAfter is -1 for a new session
+    ///
+    static QByteArray helloMessage(bool offerBinary, qint64 resumeAfter = -1);
+
+    ///
+    /// \brief Read a hello on the game side, returns false if the message is not a hello
+    ///
+    static bool readHello(const QByteArray &message, bool &offersBinary, qint64 &resumeAfter);
+
+    ///
+    /// \brief Tells the game every event up to and including sequence has been handled
+    ///
+    static QByteArray ackMessage(qint64 sequence);
+
+    static bool readAck(const QByteArray &message, qint64 &sequence);
+
+    ///
+    /// \brief Wrap a message the way the framer on the other side expects it
+    ///
+    static QByteArray frame(const QByteArray &message, FramingMode framing);
+};
+
+#endif // ANALYTICSPROTOCOL_H
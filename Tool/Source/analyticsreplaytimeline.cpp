@@ -0,0 +1,84 @@
+#include "analyticsreplaytimeline.h"
+
+#include <algorithm>
+
+static const int kCheckpointInterval = 10000;   //events between checkpoints, the most replayed to reach any time
+
+static bool isBeforeCheckpoint(qint64 msecs, const AnalyticsReplayCheckpoint &checkpoint)
+{
+    return msecs < checkpoint.msecs;
+}
+
+AnalyticsReplayTimeline::AnalyticsReplayTimeline()
+{
+    clear();
+}
+
+void AnalyticsReplayTimeline::start(int sessionId, const QString &fileName, bool updateValues)
+{
+    clear();
+
+    m_sessionId = sessionId;
+    m_fileName = fileName;
+    m_updateValues = updateValues;
+}
+
+void AnalyticsReplayTimeline::clear()
+{
+    m_sessionId = 0;
+    m_fileName.clear();
+    m_updateValues = false;
+
+    m_checkpoints.clear();
+    m_summary.reset();
+    m_numSinceCheckpoint = 0;
+
+    m_firstMsecs = 0;
+    m_lastMsecs = 0;
+}
+
+bool AnalyticsReplayTimeline::needsCheckpoint() const
+{
+    return isActive() && (m_checkpoints.isEmpty() || m_numSinceCheckpoint >= kCheckpointInterval);
+}
+
+void AnalyticsReplayTimeline::addCheckpoint(qint64 position, const AnalyticsSessionState &state)
+{
+    AnalyticsReplayCheckpoint checkpoint;
+
+    checkpoint.msecs = m_lastMsecs;
+    checkpoint.position = position;
+    checkpoint.state = state;
+    checkpoint.summary = m_summary;     //shares its data until the next delta changes it
+
+    m_checkpoints.append(checkpoint);
+    m_numSinceCheckpoint = 0;
+}
+
+void AnalyticsReplayTimeline::eventReplayed(const AnalyticsEvent &event)
+{
+    ++m_numSinceCheckpoint;
+
+    if(!event.time.valid)
+        return;
+
+    if(m_firstMsecs == 0)
+        m_firstMsecs = event.time.msecs;
+
+    //kept in order so the checkpoints can be searched
+    m_lastMsecs = qMax(m_lastMsecs, event.time.msecs);
+}
+
+const AnalyticsReplayCheckpoint *AnalyticsReplayTimeline::findCheckpoint(qint64 msecs) const
+{
+    if(m_checkpoints.isEmpty())
+        return nullptr;
+
+    //the first checkpoint is always before any time, it is taken before the first event
+    QList<AnalyticsReplayCheckpoint>::const_iterator after = std::upper_bound(m_checkpoints.constBegin(), m_checkpoints.constEnd(), msecs, isBeforeCheckpoint);
+
+    if(after == m_checkpoints.constBegin())
+        return &m_checkpoints.first();
+
+    return &*(after - 1);
+}
@@ -0,0 +1,80 @@
+#ifndef ANALYTICSREPLAYTIMELINE_H
+#define ANALYTICSREPLAYTIMELINE_H
+
+#include <QString>
+#include <QList>
+
+#include "analyticssession.h"
+#include "analyticssessionsummary.h"
+
+///
+/// \brief Everything needed to carry on a replay from part way through the log
+///
+struct AnalyticsReplayCheckpoint
+{
+    AnalyticsReplayCheckpoint() : msecs(0), position(0) {}
+
+    qint64 msecs;                       //latest event time replayed before the checkpoint, 0 before the first
+    qint64 position;                    //where the log reader carries on, see AnalyticsLogReader::seek
+    AnalyticsSessionState state;
+    AnalyticsSessionSummary summary;    //what the GUI had been sent up to here
+};
+
+///
+/// \brief Checkpoints taken while a log is replayed, so any point of it can be shown again.
+///
+/// Going to a time restores the last checkpoint before it and only replays the events in
+/// between, instead of everything from the start of the log. Times only ever go forward along
+/// the timeline, an event earlier than one before it counts as happening at the same time.
+///
+class AnalyticsReplayTimeline
+{
+public:
+    AnalyticsReplayTimeline();
+
+    void start(int sessionId, const QString &fileName, bool updateValues);
+    void clear();
+
+    bool isActive() const {return !m_fileName.isEmpty();}
+
+    ///
+    /// \brief Whether enough events have been replayed since the last checkpoint to take another
+    ///
+    bool needsCheckpoint() const;
+    void addCheckpoint(qint64 position, const AnalyticsSessionState &state);
+
+    ///
+    /// \brief Keep track of what a replayed event has changed
+    ///
+    void eventReplayed(const AnalyticsEvent &event);
+    void deltaReplayed(const AnalyticsDelta &delta) {m_summary.apply(delta);}
+
+    ///
+    /// \brief Last checkpoint before the time, nullptr if there are none
+    ///
+    const AnalyticsReplayCheckpoint *findCheckpoint(qint64 msecs) const;
+
+    int getSessionId() const {return m_sessionId;}
+    QString getFileName() const {return m_fileName;}
+    bool getUpdateValues() const {return m_updateValues;}
+
+    ///
+    /// \brief Time of the first and latest event replayed, 0 if none had a valid time
+    ///
+    qint64 getFirstMsecs() const {return m_firstMsecs;}
+    qint64 getLastMsecs() const {return m_lastMsecs;}
+
+private:
+    int m_sessionId;
+    QString m_fileName;
+    bool m_updateValues;
+
+    QList<AnalyticsReplayCheckpoint> m_checkpoints;
+    AnalyticsSessionSummary m_summary;
+    int m_numSinceCheckpoint;
+
+    qint64 m_firstMsecs;
+    qint64 m_lastMsecs;
+};
+
+#endif // ANALYTICSREPLAYTIMELINE_H
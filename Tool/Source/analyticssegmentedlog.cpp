@@ -0,0 +1,348 @@
+#include "analyticssegmentedlog.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QDebug>
+
+#ifdef Q_OS_WIN
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "analyticslogcompression.h"
+
+static const qint64 kSegmentBytes = 4 * 1024 * 1024;    //a new segment is started after this size
+static const qint64 kSegmentAge = 10 * 60 * 1000;       //or after this many ms
+static const int kRecoveryChunk = 64 * 1024;            //bytes read at a time looking for the last complete record
+static const int kFrameBytes = 256 * 1024;              //lines compressed into one frame at most, frames are also written on every sync
+
+static const QString kName_SegmentPrefix = "segment_";
+static const QString kName_SegmentSuffix = ".ndjson";
+static const QString kName_CompressedSegmentSuffix = ".ndz";
+static const QString kName_Dictionary = "segments.dict";
+
+AnalyticsSegmentedLog::AnalyticsSegmentedLog()
+    : m_segmentBytes(0)
+    , m_compressed(false)
+    , m_numEvents(0)
+{
+
+}
+
+AnalyticsSegmentedLog::~AnalyticsSegmentedLog()
+{
+    close();
+}
+
+void AnalyticsSegmentedLog::setCompression(bool enabled, const QByteArray &dictionary)
+{
+    m_compressed = enabled;
+    m_dictionary = enabled ? dictionary : QByteArray();
+}
+
+bool AnalyticsSegmentedLog::create(const QString &directory)
+{
+    close();
+
+    m_directory = directory;
+    m_numEvents = 0;
+
+    QDir dir(directory);
+
+    if(!dir.exists() && !QDir().mkpath(directory))
+    {
+        qDebug() << "Could not create log directory" << directory;
+        return false;
+    }
+
+    foreach (const QString &segment, segmentFiles(directory))
+        QFile::remove(segment);
+
+    m_frame.clear();
+
+    //the dictionary goes with the log, the tasks it was built from may have changed by the time it is read
+    QFile dictionary(dir.filePath(kName_Dictionary));
+    dictionary.remove();
+
+    if(m_compressed)
+    {
+        if(!dictionary.open(QIODevice::WriteOnly) || dictionary.write(m_dictionary) != m_dictionary.size())
+        {
+            qDebug() << "Could not write the dictionary of log" << directory;
+            return false;
+        }
+
+        syncFile(dictionary);
+    }
+
+    return startSegment();
+}
+
+bool AnalyticsSegmentedLog::startSegment()
+{
+    if(m_segment.isOpen())
+    {
+        //the old segment is complete before anything goes into the new one
+        sync();
+        m_segment.close();
+    }
+
+    QString name = kName_SegmentPrefix + QString("%1").arg(m_numEvents, 12, 10, QChar('0')) + (m_compressed ? kName_CompressedSegmentSuffix : kName_SegmentSuffix);
+
+    m_segment.setFileName(QDir(m_directory).filePath(name));
+    m_segmentBytes = 0;
+    m_segmentAge.start();
+
+    if(!m_segment.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        qDebug() << "Could not open log segment" << m_segment.fileName();
+        return false;
+    }
+
+    return true;
+}
+
+bool AnalyticsSegmentedLog::append(const QByteArray &event)
+{
+    if(m_segment.isOpen() && (m_segmentBytes >= kSegmentBytes || m_segmentAge.elapsed() >= kSegmentAge))
+        startSegment();
+
+    if(!m_segment.isOpen())
+        return false;
+
+    if(m_compressed)
+    {
+        m_frame += event;
+        m_frame += '\n';
+
+        if(m_frame.size() >= kFrameBytes)
+            writeFrame();
+    }
+    else
+    {
+        m_segment.write(event);
+        m_segment.write("\n", 1);
+    }
+
+    m_segmentBytes += event.size() + 1;
+    ++m_numEvents;
+
+    return true;
+}
+
+void AnalyticsSegmentedLog::writeFrame()
+{
+    if(m_frame.isEmpty())
+        return;
+
+    QByteArray frame = AnalyticsLogCompression::compressFrame(m_frame, m_dictionary);
+
+    if(frame.isEmpty())
+        qDebug() << "Could not compress" << m_frame.size() << "bytes of log" << m_segment.fileName();
+    else
+        m_segment.write(frame);
+
+    m_frame.clear();
+}
+
+void AnalyticsSegmentedLog::sync()
+{
+    if(m_segment.isOpen())
+    {
+        writeFrame();
+        syncFile(m_segment);
+    }
+}
+
+void AnalyticsSegmentedLog::close()
+{
+    if(!m_segment.isOpen())
+        return;
+
+    sync();
+    m_segment.close();
+}
+
+void AnalyticsSegmentedLog::syncFile(QFile &file)
+{
+    file.flush();
+
+#ifdef Q_OS_WIN
+    _commit(file.handle());
+#else
+    fsync(file.handle());
+#endif
+}
+
+QStringList AnalyticsSegmentedLog::segmentFiles(const QString &directory)
+{
+    QDir dir(directory);
+    QStringList files;
+
+    //ordinals are zero padded, so name order is log order
+    QStringList filters;
+    filters << kName_SegmentPrefix + "*" + kName_SegmentSuffix << kName_SegmentPrefix + "*" + kName_CompressedSegmentSuffix;
+
+    foreach (const QString &name, dir.entryList(filters, QDir::Files, QDir::Name))
+        files.append(dir.filePath(name));
+
+    return files;
+}
+
+bool AnalyticsSegmentedLog::isSegmentFile(const QString &fileName)
+{
+    QString name = QFileInfo(fileName).fileName();
+    return name.startsWith(kName_SegmentPrefix) && (name.endsWith(kName_SegmentSuffix) || name.endsWith(kName_CompressedSegmentSuffix));
+}
+
+bool AnalyticsSegmentedLog::isCompressedSegment(const QString &fileName)
+{
+    return isSegmentFile(fileName) && fileName.endsWith(kName_CompressedSegmentSuffix);
+}
+
+QString AnalyticsSegmentedLog::suffixOf(const QString &segmentFile)
+{
+    return segmentFile.endsWith(kName_CompressedSegmentSuffix) ? kName_CompressedSegmentSuffix : kName_SegmentSuffix;
+}
+
+QString AnalyticsSegmentedLog::dictionaryFileFor(const QString &segmentFile)
+{
+    return QDir(QFileInfo(segmentFile).path()).filePath(kName_Dictionary);
+}
+
+QByteArray AnalyticsSegmentedLog::readSegment(const QString &segmentFile)
+{
+    QFile segment(segmentFile);
+
+    if(!segment.open(QIODevice::ReadOnly))
+        return QByteArray();
+
+    if(!isCompressedSegment(segmentFile))
+        return segment.readAll();
+
+    QFile dictionary(dictionaryFileFor(segmentFile));
+    dictionary.open(QIODevice::ReadOnly);   //a log compressed without tasks loaded has an empty one
+
+    return AnalyticsLogCompression::decompressFrames(segment.readAll(), dictionary.readAll());
+}
+
+qint64 AnalyticsSegmentedLog::segmentSize(const QString &segmentFile)
+{
+    if(!isCompressedSegment(segmentFile))
+        return QFileInfo(segmentFile).size();
+
+    QFile segment(segmentFile);
+
+    if(!segment.open(QIODevice::ReadOnly))
+        return 0;
+
+    //the frame headers are enough, a torn frame at the end isn't counted
+    qint64 size = 0;
+    qint64 position = 0;
+    qint64 fileSize = segment.size();
+    char header[AnalyticsLogCompression::kFrameHeaderSize];
+    quint32 compressedSize, uncompressedSize;
+
+    while(position + AnalyticsLogCompression::kFrameHeaderSize <= fileSize && segment.seek(position)
+          && segment.read(header, sizeof(header)) == sizeof(header)
+          && AnalyticsLogCompression::readFrameHeader(header, compressedSize, uncompressedSize)
+          && position + AnalyticsLogCompression::kFrameHeaderSize + compressedSize <= fileSize)
+    {
+        size += uncompressedSize;
+        position += AnalyticsLogCompression::kFrameHeaderSize + compressedSize;
+    }
+
+    return size;
+}
+
+bool AnalyticsSegmentedLog::recover(const QString &directory)
+{
+    QStringList segments = segmentFiles(directory);
+
+    if(segments.isEmpty())
+        return false;
+
+    QString segmentFile = segments.last();
+    QFile segment(segmentFile);
+
+    if(!segment.open(QIODevice::ReadWrite))
+        return false;
+
+    //frames hold whole records, so only a torn frame has to go
+    if(isCompressedSegment(segmentFile))
+        return recoverCompressed(segment);
+
+    qint64 size = segment.size();
+
+    //only the end can be torn, search backwards for the last newline
+    qint64 end = size;
+    qint64 complete = 0;
+
+    while(end > 0)
+    {
+        qint64 begin = qMax(qint64(0), end - kRecoveryChunk);
+
+        segment.seek(begin);
+        QByteArray chunk = segment.read(end - begin);
+        int newline = chunk.lastIndexOf('\n');
+
+        if(newline != -1)
+        {
+            complete = begin + newline + 1;
+            break;
+        }
+
+        end = begin;
+    }
+
+    if(complete != size)
+    {
+        qDebug() << "Truncating torn record at the end of" << segmentFile << "from" << size << "to" << complete << "bytes";
+        segment.resize(complete);
+    }
+
+    return true;
+}
+
+bool AnalyticsSegmentedLog::recoverCompressed(QFile &segment)
+{
+    qint64 fileSize = segment.size();
+    qint64 position = 0;
+    qint64 lastFrame = -1;
+    char header[AnalyticsLogCompression::kFrameHeaderSize];
+    quint32 compressedSize, uncompressedSize;
+
+    while(position + AnalyticsLogCompression::kFrameHeaderSize <= fileSize && segment.seek(position)
+          && segment.read(header, sizeof(header)) == sizeof(header)
+          && AnalyticsLogCompression::readFrameHeader(header, compressedSize, uncompressedSize)
+          && position + AnalyticsLogCompression::kFrameHeaderSize + compressedSize <= fileSize)
+    {
+        lastFrame = position;
+        position += AnalyticsLogCompression::kFrameHeaderSize + compressedSize;
+    }
+
+    //a crash can leave the last frame the right length but not all of it on disk
+    if(lastFrame != -1)
+    {
+        QFile dictionary(dictionaryFileFor(segment.fileName()));
+        dictionary.open(QIODevice::ReadOnly);
+
+        segment.seek(lastFrame);
+        qint64 complete = 0;
+        AnalyticsLogCompression::decompressFrames(segment.read(position - lastFrame), dictionary.readAll(), &complete);
+
+        if(complete == 0)
+            position = lastFrame;
+    }
+
+    if(position != fileSize)
+    {
+        qDebug() << "Truncating torn frame at the end of" << segment.fileName() << "from" << fileSize << "to" << position << "bytes";
+
+        if(!segment.resize(position))
+            return false;
+    }
+
+    return true;
+}
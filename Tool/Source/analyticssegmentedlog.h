@@ -0,0 +1,104 @@
+#ifndef ANALYTICSSEGMENTEDLOG_H
+#define ANALYTICSSEGMENTEDLOG_H
+
+#include <QString>
+#include <QStringList>
+#include <QByteArray>
+#include <QFile>
+#include <QElapsedTimer>
+
+///
+/// \brief Write-ahead log of one session, kept as a directory of bounded segments.
+///
+/// Events are appended one per line to "segment_<first event>.ndjson". A segment is closed and a
+/// new one started once it reaches a size or age limit, so no file grows with the session.
+/// Only the end of the last segment can be torn by a crash, and recovery only looks at that.
+///
+/// With compression on, segments are "segment_<first event>.ndz": the same lines written as
+/// AnalyticsLogCompression frames whenever the log is synced, with the dictionary saved next to
+/// them.
+///
+class AnalyticsSegmentedLog
+{
+public:
+    AnalyticsSegmentedLog();
+    ~AnalyticsSegmentedLog();
+
+    ///
+    /// \brief Compress the segments of logs created from now on with the dictionary
+    ///
+    void setCompression(bool enabled, const QByteArray &dictionary = QByteArray());
+
+    ///
+    /// \brief Start a new log in directory, segments of an older log there are removed
+    ///
+    bool create(const QString &directory);
+
+    ///
+    /// \brief Append the compact JSON of an event
+    ///
+    bool append(const QByteArray &event);
+
+    ///
+    /// \brief Flush what was appended to the disk itself, not just to the OS
+    ///
+    void sync();
+
+    void close();
+
+    qint64 getNumEvents() const {return m_numEvents;}
+    const QString &getDirectory() const {return m_directory;}
+
+    ///
+    /// \brief Segment files of a log, oldest first
+    ///
+    static QStringList segmentFiles(const QString &directory);
+
+    ///
+    /// \brief True if the file is one of the segments of a log
+    ///
+    static bool isSegmentFile(const QString &fileName);
+    static bool isCompressedSegment(const QString &fileName);
+
+    ///
+    /// \brief Lines of a segment, decompressed if it needs to be (only the frames that are whole)
+    ///
+    static QByteArray readSegment(const QString &segmentFile);
+
+    ///
+    /// \brief Size of a segment once decompressed, without decompressing it
+    ///
+    static qint64 segmentSize(const QString &segmentFile);
+
+    ///
+    /// \brief Cut a record torn by a crash off the end of the last segment
+    ///
+    static bool recover(const QString &directory);
+
+    ///
+    /// \brief fsync for QFile, or its equivalent on Windows
+    ///
+    static void syncFile(QFile &file);
+
+private:
+    bool startSegment();
+    void writeFrame();
+
+    static bool recoverCompressed(QFile &segment);
+    static QString suffixOf(const QString &segmentFile);
+    static QString dictionaryFileFor(const QString &segmentFile);
+
+    QString m_directory;
+
+    QFile m_segment;
+    QElapsedTimer m_segmentAge;
+    qint64 m_segmentBytes;  //before compression
+
+    bool m_compressed;
+    QByteArray m_dictionary;
+    QByteArray m_frame;     //lines not yet compressed into the segment
+
+    qint64 m_numEvents;
+};
+
+#endif // ANALYTICSSEGMENTEDLOG_H
@@ -0,0 +1,12 @@
+#include "analyticsserver.h"
+
+AnalyticsServer::AnalyticsServer(QObject *parent)
+    : QTcpServer(parent)
+{
+
+}
+
+void AnalyticsServer::incomingConnection(qintptr socketDescriptor)
+{
+    clientConnected(socketDescriptor);
+}
@@ -0,0 +1,25 @@
+#ifndef ANALYTICSSERVER_H
+#define ANALYTICSSERVER_H
+
+#include <QTcpServer>
+
+///
+/// \brief Listens for game clients when the dashboard runs a multi-player session.
+///
+/// Accepted connections are not wrapped in a QTcpSocket here, the descriptor is handed to the
+/// ingest worker that owns the player's session so the socket is created on that thread.
+///
+class AnalyticsServer : public QTcpServer
+{
+    Q_OBJECT
+public:
+    explicit AnalyticsServer(QObject *parent = 0);
+
+signals:
+    void clientConnected(qlonglong socketDescriptor);
+
+protected:
+    void incomingConnection(qintptr socketDescriptor) override;
+};
+
+#endif // ANALYTICSSERVER_H
@@ -0,0 +1,862 @@
+#include "analyticssession.h"
+
+#include <QDebug>
+#include <QMap>
+
+#include "lostness.h"
+#include "analyticscbor.h"
+
+//json value names
+static const QString kName_Lostness = "lostness";
+static const QString kName_Unlock = "unlock";
+
+//log window sentences
+static const QString kName_With = " with ";
+static const QString kName_WithResults = " with results: ";
+static const QString kName_WithLostness = " with lostness value: ";
+static const QString kName_At = " at ";
+
+//indexed by VerbAction, the locomotion and interaction actions are both steps along the player's path
+const AnalyticsSession::VerbHandler AnalyticsSession::s_verbHandlers[VERB_ACTION_COUNT] =
+{
+    nullptr,
+    &AnalyticsSession::handleStartTask,
+    &AnalyticsSession::handleCompleteTask,
+    &AnalyticsSession::handlePathAction,
+    &AnalyticsSession::handlePathAction,
+    &AnalyticsSession::handleAttempt,
+    &AnalyticsSession::handleFound
+};
+
+AnalyticsSession::AnalyticsSession()
+    : m_gameProgress(0)
+    , m_localLostness(0)
+    , m_progressSum(0)
+    , m_totalNodes(0)
+    , m_hasStartTime(false)
+    , m_lastSequence(-1)
+    , m_numDuplicates(0)
+{
+
+}
+
+AnalyticsSession::~AnalyticsSession()
+{
+    qDeleteAll(m_curatorLabelsList);
+}
+
+void AnalyticsSession::configure(const AnalyticsSessionConfig &config)
+{
+    qDeleteAll(m_curatorLabelsList);
+    m_curatorLabelsList.clear();
+    m_curatorLabelsHash.clear();
+    m_objectivesHash.clear();
+
+    m_lostnessHandler = config.lostnessHandler;
+    m_verbs = config.verbs;
+
+    foreach (const CuratorLabelDefinition &definition, config.curatorLabels)
+    {
+        SessionCuratorLabel *curatorLabel = new SessionCuratorLabel;
+        curatorLabel->id = definition.id;
+        curatorLabel->startDependency = new SessionObjective(definition.startObjective);
+        curatorLabel->minSteps = definition.minSteps;
+
+        foreach (const QString &objectiveId, definition.objectives)
+        {
+            SessionObjective *objective = new SessionObjective(objectiveId);
+            curatorLabel->narrativeDependenciesHash.insert(objectiveId, objective);
+            curatorLabel->narrativeDependenciesList.append(objective);
+
+            if(!m_objectivesHash.contains(objectiveId))
+                m_objectivesHash.insert(objectiveId, OwnedObjective(curatorLabel, objective));
+        }
+
+        if(!m_objectivesHash.contains(definition.startObjective))
+            m_objectivesHash.insert(definition.startObjective, OwnedObjective(curatorLabel, curatorLabel->startDependency));
+
+        m_curatorLabelsHash.insert(curatorLabel->id, curatorLabel);
+        m_curatorLabelsList.append(curatorLabel);
+    }
+
+    resetAll();
+}
+
+void AnalyticsSession::resetAll()
+{
+    foreach (SessionCuratorLabel* curatorLabel, m_curatorLabelsList)
+    {
+        //reset lostness
+        curatorLabel->uniqueNodesVisited.clear();
+        curatorLabel->totalNumOfNodesVisited = 0;
+        curatorLabel->totalNumUniqueNodesVisited = 0;
+        curatorLabel->lostness = -1;
+
+        //and progress
+        curatorLabel->progress = 0;
+        curatorLabel->numFound = 0;
+        curatorLabel->foundSums = LostnessSums();
+
+        //starting node and other dependencies
+        curatorLabel->startDependency->reset();
+
+        foreach (SessionObjective *dependency, curatorLabel->narrativeDependenciesList)
+            dependency->reset();
+    }
+
+    m_gameProgress = 0;
+    m_localLostness = 0;
+    m_progressSum = 0;
+    m_localSums = LostnessSums();
+
+    m_endNode = "";
+    m_lastLocomotionNode = "";
+    m_totalNodes = 0;
+    m_uniqueNodes.clear();
+    m_activeTasks.clear();
+    m_hasStartTime = false;
+}
+
+AnalyticsSessionState AnalyticsSession::getState() const
+{
+    AnalyticsSessionState state;
+
+    foreach (const SessionCuratorLabel *curatorLabel, m_curatorLabelsList)
+    {
+        AnalyticsSessionState::CuratorLabel label;
+
+        label.startDependency = *curatorLabel->startDependency;
+
+        foreach (const SessionObjective *dependency, curatorLabel->narrativeDependenciesList)
+            label.narrativeDependencies.append(*dependency);
+
+        label.uniqueNodesVisited = curatorLabel->uniqueNodesVisited;
+        label.totalNumOfNodesVisited = curatorLabel->totalNumOfNodesVisited;
+        label.totalNumUniqueNodesVisited = curatorLabel->totalNumUniqueNodesVisited;
+        label.startNode = curatorLabel->startNode;
+        label.endNode = curatorLabel->endNode;
+        label.progress = curatorLabel->progress;
+        label.lostness = curatorLabel->lostness;
+
+        state.curatorLabels.append(label);
+    }
+
+    state.gameProgress = m_gameProgress;
+    state.localLostness = m_localLostness;
+    state.firstNode = m_firstNode;
+    state.endNode = m_endNode;
+    state.lastLocomotionNode = m_lastLocomotionNode;
+    state.totalNodes = m_totalNodes;
+    state.uniqueNodes = m_uniqueNodes;
+    state.activeTasks = m_activeTasks;
+    state.hasStartTime = m_hasStartTime;
+    state.startTime = m_startTime;
+
+    return state;
+}
+
+bool AnalyticsSession::setState(const AnalyticsSessionState &state)
+{
+    if(state.curatorLabels.size() != m_curatorLabelsList.size())
+    {
+        qDebug() << "Session state doesn't match the curator labels";
+        return false;
+    }
+
+    for(int i = 0; i < m_curatorLabelsList.size(); ++i)
+    {
+        SessionCuratorLabel *curatorLabel = m_curatorLabelsList[i];
+        const AnalyticsSessionState::CuratorLabel &label = state.curatorLabels[i];
+
+        if(label.startDependency.id != curatorLabel->startDependency->id || label.narrativeDependencies.size() != curatorLabel->narrativeDependenciesList.size())
+        {
+            qDebug() << "Session state doesn't match the curator labels";
+            return false;
+        }
+    }
+
+    //objectives are copied into the existing ones, the hashes point at them
+    for(int i = 0; i < m_curatorLabelsList.size(); ++i)
+    {
+        SessionCuratorLabel *curatorLabel = m_curatorLabelsList[i];
+        const AnalyticsSessionState::CuratorLabel &label = state.curatorLabels[i];
+
+        *curatorLabel->startDependency = label.startDependency;
+
+        for(int j = 0; j < label.narrativeDependencies.size(); ++j)
+            *curatorLabel->narrativeDependenciesList[j] = label.narrativeDependencies[j];
+
+        curatorLabel->uniqueNodesVisited = label.uniqueNodesVisited;
+        curatorLabel->totalNumOfNodesVisited = label.totalNumOfNodesVisited;
+        curatorLabel->totalNumUniqueNodesVisited = label.totalNumUniqueNodesVisited;
+        curatorLabel->startNode = label.startNode;
+        curatorLabel->endNode = label.endNode;
+        curatorLabel->progress = label.progress;
+        curatorLabel->lostness = label.lostness;
+    }
+
+    recount();
+
+    m_gameProgress = state.gameProgress;
+    m_localLostness = state.localLostness;
+    m_firstNode = state.firstNode;
+    m_endNode = state.endNode;
+    m_lastLocomotionNode = state.lastLocomotionNode;
+    m_totalNodes = state.totalNodes;
+    m_uniqueNodes = state.uniqueNodes;
+    m_activeTasks = state.activeTasks;
+    m_hasStartTime = state.hasStartTime;
+    m_startTime = state.startTime;
+
+    return true;
+}
+
+void AnalyticsSession::handleMessage(const QByteArray &message, PayloadFormat format, bool updateValues, bool loadLogFile, AnalyticsDelta &delta)
+{
+    AnalyticsEvent event;
+
+    if(format == PAYLOAD_CBOR)
+    {
+        if(!AnalyticsCbor::decodeEvent(message, m_verbs, event))
+        {
+            qDebug() << "Problem with CBOR event";
+            return;
+        }
+
+        if(!loadLogFile && isDuplicate(event))
+            return;
+
+        if(!(m_verbs.getAction(event.verbId) == VERB_ACTION_FOUND && updateValues))
+            handleEvent(event, updateValues, loadLogFile, delta);
+
+        return;
+    }
+
+    //events are decoded one at a time straight from the message
+    AnalyticsEventParser parser(m_verbs);
+
+    parser.setData(message);
+
+    while(parser.next(event))
+    {
+        if(!loadLogFile && isDuplicate(event))
+            continue;
+
+        if(!(m_verbs.getAction(event.verbId) == VERB_ACTION_FOUND && updateValues))    //ignore a found action sent by the game if tool is calculating lostness
+            handleEvent(event, updateValues, loadLogFile, delta);
+    }
+
+    if(parser.hasError())
+        qDebug() << "Problem with JSON string";
+}
+
+void AnalyticsSession::replayEvent(AnalyticsEvent &event, bool updateValues, AnalyticsDelta &delta)
+{
+    //saved logs are not deduplicated, their events were already checked when they arrived
+    if(!(m_verbs.getAction(event.verbId) == VERB_ACTION_FOUND && updateValues))
+        handleEvent(event, updateValues, true, delta);
+}
+
+bool AnalyticsSession::isDuplicate(const AnalyticsEvent &event)
+{
+    if(event.sequence < 0)
+        return false;   //game doesn't number its events
+
+    //resent by the game after a reconnect, already counted
+    if(event.sequence <= m_lastSequence)
+    {
+        ++m_numDuplicates;
+        return true;
+    }
+
+    //a reconnect resends a whole run of events, logged once the game catches up
+    if(m_numDuplicates > 0)
+    {
+        qDebug() << "Skipped" << m_numDuplicates << "events already handled, up to event" << m_lastSequence;
+        m_numDuplicates = 0;
+    }
+
+    m_lastSequence = event.sequence;
+    return false;
+}
+
+void AnalyticsSession::handleEvent(AnalyticsEvent &event, bool updateValues, bool loadLogFile, AnalyticsDelta &delta)
+{
+    if(!event.isComplete())
+    {
+        qDebug() << "Problem with JSON object";
+        return;
+    }
+
+    //log the start time if first action
+    if(!m_hasStartTime)
+    {
+        m_startTime = event.time;
+        m_hasStartTime = true;
+    }
+
+    VerbHandler handler = s_verbHandlers[m_verbs.getAction(event.verbId)];
+
+    if(!isEmpty() && handler)    //don't need any of this if no tasks to log
+        (this->*handler)(event, updateValues, delta);
+
+    handleTextOutput(event, updateValues, loadLogFile, delta);
+}
+
+void AnalyticsSession::handleStartTask(AnalyticsEvent &event, bool updateValues, AnalyticsDelta &delta)
+{
+    Q_UNUSED(updateValues);
+
+    //add new task to active list and set as started in properties
+    m_activeTasks.push_back(event.object);
+    delta.startedCuratorLabels.append(event.object);
+    //handle difficulty in results
+}
+
+void AnalyticsSession::handleCompleteTask(AnalyticsEvent &event, bool updateValues, AnalyticsDelta &delta)
+{
+    //task completed, get lostness value, remove from the list and update properties
+    if(updateValues)
+    {
+        float lostness = getLostnessofCuratorLabelFromObjectives(event.object);
+
+        if(lostness >= 0)
+        {
+            event.hasLostness = true;
+            event.lostness = lostness;
+        }
+
+        delta.curatorLabelLostness.insert(event.object, lostness);
+        delta.curatorLabelProgress.insert(event.object, getCuratorLabelProgress(event.object));
+        setGameValues(delta);
+    }
+    else
+    {
+        if(event.hasLostness)
+            delta.curatorLabelLostness.insert(event.object, event.lostness);
+        else
+        {
+            float lostness = getLostnessofCuratorLabelFromObjectives(event.object);
+
+            if(lostness >= 0)
+            {
+                event.hasLostness = true;
+                event.lostness = lostness;
+            }
+
+            delta.curatorLabelLostness.insert(event.object, lostness);
+        }
+    }
+
+    m_activeTasks.removeAll(event.object);
+}
+
+void AnalyticsSession::handlePathAction(AnalyticsEvent &event, bool updateValues, AnalyticsDelta &delta)
+{
+    updatePath(event.object, event.verbId);
+
+    foreach (QString task, m_activeTasks)   //update lostness and check progress
+    {
+        nodeVisited(task, event.object, event.verbId);   //Update lostness values (S and N) for each curator label
+
+        if(updateValues)    //update lostness
+            delta.curatorLabelLostness.insert(task, getLostnessofCuratorLabel(task));
+    }
+}
+
+void AnalyticsSession::handleAttempt(AnalyticsEvent &event, bool updateValues, AnalyticsDelta &delta)
+{
+    //light up node in scene to show unlocked
+    QString result;
+
+    bool unlock = (event.resultType == AnalyticsEvent::RESULT_STRING && event.resultString == kName_Unlock) ||
+            (event.getResultString(QLatin1String("result"), result) && result == kName_Unlock);
+
+    if(!unlock)
+        return;
+
+    delta.unlockedNodes.append(event.object);
+
+    //functionality needed for when tool detects objectives and lostness
+    if(updateValues)   //update curator label progress
+        if(possibleObjectiveFound(event.object))
+        {
+            //get variables needed for json output
+            QString parent = getParentId(event.object);
+            int r, s, n;
+            QString startNode, endNode;
+            float lostness = getLostnessofObjective(parent, event.object, r, s, n, startNode, endNode);
+
+            //send to properties
+            delta.objectiveLostness.append(ObjectiveLostnessUpdate(parent, event.object, lostness));
+            delta.curatorLabelProgress.insert(parent, getCuratorLabelProgress(parent));
+            setGameValues(delta);
+
+            //send to graph
+            delta.lostnessPoints.append(QPointF(m_startTime.secsTo(event.time), lostness));
+
+            handleTextOutput(event, updateValues, false, delta);    //send this out now before doing to found message immediately afterwards
+
+            //make found message, results in the order they are written to the log
+            AnalyticsEvent foundEvent;
+
+            foundEvent.fields = AnalyticsEvent::FIELD_ACTOR | AnalyticsEvent::FIELD_OBJECT | AnalyticsEvent::FIELD_VERB;
+            foundEvent.actor = event.actor;
+            foundEvent.object = event.object;
+            foundEvent.verbId = m_verbs.getId(m_verbs.getNameOfAction(VERB_ACTION_FOUND));
+            foundEvent.verb = m_verbs.getName(foundEvent.verbId);
+
+            foundEvent.resultType = AnalyticsEvent::RESULT_FIELDS;
+            foundEvent.resultFields.append(AnalyticsResultField("curatorLabel", parent));
+            foundEvent.resultFields.append(AnalyticsResultField("endNode", endNode));
+            foundEvent.resultFields.append(AnalyticsResultField(kName_Lostness, lostness));
+            foundEvent.resultFields.append(AnalyticsResultField("n", n));
+            foundEvent.resultFields.append(AnalyticsResultField("r", r));
+            foundEvent.resultFields.append(AnalyticsResultField("s", s));
+            foundEvent.resultFields.append(AnalyticsResultField("startNode", startNode));
+
+            handleTextOutput(foundEvent, true, false, delta);
+        }
+}
+
+void AnalyticsSession::handleFound(AnalyticsEvent &event, bool updateValues, AnalyticsDelta &delta)
+{
+    Q_UNUSED(updateValues);
+
+    //found an objective of a curator label
+    if(event.resultType != AnalyticsEvent::RESULT_FIELDS && !(event.resultType == AnalyticsEvent::RESULT_GENERIC && event.resultJson.startsWith('{')))
+        return;
+
+    QString startNode, endNode, curatorID;
+    double r = 0, s = 0, n = 0;
+    double lostness = 0.0;
+
+    if(!event.getResultNumber(QLatin1String("r"), r))
+        qDebug() << "R not found";
+
+    if(!event.getResultNumber(QLatin1String("s"), s))
+        qDebug() << "S not found";
+
+    if(!event.getResultNumber(QLatin1String("n"), n))
+        qDebug() << "N not found";
+
+    if(!event.getResultNumber(QLatin1String("lostness"), lostness))
+        qDebug() << "Lostness not found";
+
+    if(!event.getResultString(QLatin1String("startNode"), startNode))
+        qDebug() << "Start node not found";
+
+    if(!event.getResultString(QLatin1String("endNode"), endNode))
+        qDebug() << "End node not found";
+
+    if(!event.getResultString(QLatin1String("curatorLabel"), curatorID))
+        qDebug() << "Curator Label not found";
+
+    //update lostness
+    objectiveFound(event.object, curatorID, int(r), int(s), int(n), lostness, startNode, endNode);
+
+    //display all related properties in the sidebar
+    delta.objectiveLostness.append(ObjectiveLostnessUpdate(curatorID, event.object, lostness));
+    delta.curatorLabelProgress.insert(curatorID, getCuratorLabelProgress(curatorID));
+    setGameValues(delta);
+
+    //send lostness to graph
+    delta.lostnessPoints.append(QPointF(m_startTime.secsTo(event.time), lostness));
+}
+
+void AnalyticsSession::handleTextOutput(const AnalyticsEvent &event, bool updateValues, bool loadLogFile, AnalyticsDelta &delta)
+{
+    //formulate human-readable string for log window
+    QString sentence = event.actor + " " + event.verb + " " + event.object;
+
+    if(event.resultType == AnalyticsEvent::RESULT_FIELDS && !event.resultFields.empty()) //append list of results or only one result, if they are available
+    {
+        if(event.resultFields.size() == 1)
+        {
+            const AnalyticsResultField &field = event.resultFields.first();
+
+            if(field.isString)
+                sentence += kName_With + field.key + " " + field.string;
+            else
+                sentence += kName_With + field.key + " " + QString::number(field.number);
+        }
+        else
+        {
+            //listed by key, as they were when results were read into a QJsonObject
+            QMap<QString, const AnalyticsResultField*> fields;
+            foreach (const AnalyticsResultField &field, event.resultFields)
+                fields.insert(field.key, &field);
+
+            int i = 1;
+
+            sentence += kName_WithResults;
+
+            foreach(const AnalyticsResultField *field, fields)
+            {
+                if(i > 1)   //comma separate everything
+                    sentence += ", ";
+
+                sentence += field->key + " = ";
+
+                if(field->isString)
+                    sentence += field->string;
+                else
+                    sentence += QString::number(field->number);
+
+                ++i;
+            }
+        }
+    }
+    else
+        if(event.resultType == AnalyticsEvent::RESULT_GENERIC && !event.genericResult.empty())
+        {
+            const QJsonObject &jsonResultsObj = event.genericResult;
+
+            if(jsonResultsObj.count() == 1)
+            {
+
+                if(jsonResultsObj.begin().value().isString())
+                {
+                    sentence += kName_With + jsonResultsObj.begin().key() + " " + jsonResultsObj.begin().value().toString();
+                }
+                else
+                    if(jsonResultsObj.begin().value().isDouble())
+                        sentence += kName_With + jsonResultsObj.begin().key() + " " + QString::number(jsonResultsObj.begin().value().toDouble());
+            }
+            else
+            {
+                int i = 1;
+
+                sentence += kName_WithResults;
+
+                foreach(const QString& key, jsonResultsObj.keys())
+                {
+                    if(i > 1)   //comma separate everything
+                        sentence += ", ";
+
+                    sentence += key + " = ";
+
+                    if(jsonResultsObj.value(key).isString())
+                        sentence += jsonResultsObj.value(key).toString();
+                    else
+                        if(jsonResultsObj.value(key).isDouble())
+                            sentence += QString::number(jsonResultsObj.value(key).toDouble());
+
+                    ++i;
+                }
+            }
+        }
+
+    if(event.hasLostness)
+    {
+        //append lostness to string
+        sentence += kName_WithLostness;
+        sentence += QString::number(event.lostness);
+    }
+
+    sentence += kName_At;
+
+    //output string to window and full JSON message to file, the time is added when the line is shown
+    AnalyticsLogLine line(sentence, event.time);
+    line.fields[AnalyticsLogLine::FIELD_ACTOR] = event.actor;
+    line.fields[AnalyticsLogLine::FIELD_VERB] = event.verb;
+    line.fields[AnalyticsLogLine::FIELD_OBJECT] = event.object;
+    event.getResultString(QLatin1String("curatorLabel"), line.fields[AnalyticsLogLine::FIELD_CURATOR_LABEL]);
+
+    delta.logLines.append(line);
+
+    if(!(loadLogFile && !updateValues))
+        delta.logEvents.append(event.toJson());
+}
+
+void AnalyticsSession::setGameValues(AnalyticsDelta &delta)
+{
+    delta.gameValuesChanged = true;
+    delta.localLostness = m_localLostness;
+    delta.gameProgress = m_gameProgress;
+}
+
+void AnalyticsSession::updatePath(const QString &object, int verbId)
+{
+    QPair<QString, int> node = qMakePair(object, verbId);
+
+    if(!m_uniqueNodes.contains(node))
+        m_uniqueNodes.push_back(node);
+
+    ++m_totalNodes;
+
+    m_endNode = object;
+
+    if(m_verbs.getAction(verbId) == VERB_ACTION_LOCOMOTION)
+        m_lastLocomotionNode = object;
+}
+
+void AnalyticsSession::nodeVisited(QString id, const QString &object, int verbId)
+{
+    Q_ASSERT(m_curatorLabelsHash.contains(id));
+
+    QPair<QString, int> node = qMakePair(object, verbId);
+
+    if(!m_curatorLabelsHash[id]->uniqueNodesVisited.contains(node))
+        m_curatorLabelsHash[id]->uniqueNodesVisited.push_back(node);
+
+    ++m_curatorLabelsHash[id]->totalNumOfNodesVisited;
+}
+
+float AnalyticsSession::getLostnessofCuratorLabel(QString id)
+{
+    Q_ASSERT(m_curatorLabelsHash.contains(id));
+
+    SessionCuratorLabel* curatorLabel = m_curatorLabelsHash[id];
+
+    //if lostness already set then return it. Otherwise, calculate, save and return
+    if(curatorLabel->lostness != -1)
+        return curatorLabel->lostness;
+
+    qDebug() << "Calculating lostness for Curator Label: " << id;
+
+    float lostness = Lostness::getLostnessValue(curatorLabel->minSteps, curatorLabel->totalNumOfNodesVisited, curatorLabel->uniqueNodesVisited.size());
+
+    curatorLabel->lostness = lostness;
+    return lostness;
+}
+
+float AnalyticsSession::getLostnessofCuratorLabelFromObjectives(QString id)
+{
+    Q_ASSERT(m_curatorLabelsHash.contains(id));
+
+    SessionCuratorLabel* curatorLabel = m_curatorLabelsHash[id];
+    qDebug() << "Calculating lostness for Curator Label: " << id;
+
+    int sumR(0), sumS(0), sumN(0);
+    QString startNode = curatorLabel->startDependency->startNode;
+    QString endNode = m_endNode;
+
+    foreach (SessionObjective *obj, curatorLabel->narrativeDependenciesList)
+    {
+        if(obj->found) //if this isn't true, we have a problem
+        {
+            sumR += obj->minSteps;
+            sumS += obj->totalNumOfNodesVisited;
+            sumN += obj->totalNumUniqueNodesVisited;
+        }
+    }
+
+    curatorLabel->totalNumOfNodesVisited = sumS;
+    curatorLabel->totalNumUniqueNodesVisited = sumN;
+    curatorLabel->startNode = startNode;
+    curatorLabel->endNode = endNode;
+
+    float lostness = Lostness::getLostnessValue(sumR, sumS, sumN);
+
+    curatorLabel->lostness = lostness;
+    return lostness;
+}
+
+float AnalyticsSession::getLostnessofObjective(QString curatorId, QString objectiveId)
+{
+    Q_ASSERT(m_curatorLabelsHash.contains(curatorId));
+    Q_ASSERT(m_curatorLabelsHash[curatorId]->narrativeDependenciesHash.contains(objectiveId) || m_curatorLabelsHash[curatorId]->startDependency->id == objectiveId);
+
+    SessionObjective *objective;
+
+    if(m_curatorLabelsHash[curatorId]->narrativeDependenciesHash.contains(objectiveId))
+        objective = m_curatorLabelsHash[curatorId]->narrativeDependenciesHash[objectiveId];
+    else
+        objective = m_curatorLabelsHash[curatorId]->startDependency;
+
+    if(objective->lostness != -1)
+        return objective->lostness;
+
+    qDebug() << "Calculating lostness for Objective: " << objectiveId << " from Curator Label: " << curatorId;
+
+    float lostness = -1;
+
+    if(m_lostnessHandler)
+        lostness = m_lostnessHandler->getLostnessForObjective(objective->startNode, objective->endNode, objective->totalNumOfNodesVisited, objective->totalNumUniqueNodesVisited, objective->minSteps);
+
+    objective->lostness = lostness;
+    return lostness;
+}
+
+float AnalyticsSession::getLostnessofObjective(QString curatorId, QString objectiveId, int &r, int &s, int &n, QString &startNode, QString &endNode)
+{
+    Q_ASSERT(m_curatorLabelsHash.contains(curatorId));
+    Q_ASSERT(m_curatorLabelsHash[curatorId]->narrativeDependenciesHash.contains(objectiveId) || m_curatorLabelsHash[curatorId]->startDependency->id == objectiveId);
+
+    SessionObjective *objective;
+
+    if(m_curatorLabelsHash[curatorId]->narrativeDependenciesHash.contains(objectiveId))
+        objective = m_curatorLabelsHash[curatorId]->narrativeDependenciesHash[objectiveId];
+    else
+        objective = m_curatorLabelsHash[curatorId]->startDependency;
+
+    float lostness;
+    if(objective->lostness != -1)
+        lostness =  objective->lostness;
+    else
+        lostness = getLostnessofObjective(curatorId, objectiveId);
+
+    r = objective->minSteps;
+    s = objective->totalNumOfNodesVisited;
+    n = objective->totalNumUniqueNodesVisited;
+    startNode = objective->startNode;
+    endNode = objective->endNode;
+
+    return lostness;
+}
+
+void AnalyticsSession::updateGameProgress()
+{
+    m_gameProgress = m_progressSum / m_curatorLabelsList.size();
+}
+
+void AnalyticsSession::uncountObjective(SessionCuratorLabel *curatorLabel, const SessionObjective *objective)
+{
+    //the curator label's share of the game totals is taken out while it changes
+    m_progressSum -= curatorLabel->progress;
+
+    if(curatorLabel->startDependency->found)
+        m_localSums.remove(curatorLabel->foundSums);
+
+    if(objective->found)
+    {
+        curatorLabel->foundSums.remove(*objective);
+
+        if(objective != curatorLabel->startDependency)
+            --curatorLabel->numFound;
+    }
+}
+
+void AnalyticsSession::countObjective(SessionCuratorLabel *curatorLabel, const SessionObjective *objective)
+{
+    if(objective->found)
+    {
+        curatorLabel->foundSums.add(*objective);
+
+        if(objective != curatorLabel->startDependency)
+            ++curatorLabel->numFound;
+    }
+
+    curatorLabel->progress = float(curatorLabel->numFound) / curatorLabel->narrativeDependenciesList.size();
+    m_progressSum += curatorLabel->progress;
+
+    if(curatorLabel->startDependency->found)
+        m_localSums.add(curatorLabel->foundSums);
+
+    updateGameProgress();
+    updateLocalLostness();
+}
+
+void AnalyticsSession::recount()
+{
+    m_progressSum = 0;
+    m_localSums = LostnessSums();
+
+    foreach (SessionCuratorLabel *curatorLabel, m_curatorLabelsList)
+    {
+        curatorLabel->numFound = 0;
+        curatorLabel->foundSums = LostnessSums();
+
+        if(curatorLabel->startDependency->found)
+            curatorLabel->foundSums.add(*curatorLabel->startDependency);
+
+        foreach (const SessionObjective *objective, curatorLabel->narrativeDependenciesList)
+        {
+            if(objective->found)
+            {
+                curatorLabel->foundSums.add(*objective);
+                ++curatorLabel->numFound;
+            }
+        }
+
+        m_progressSum += curatorLabel->progress;
+
+        if(curatorLabel->startDependency->found)
+            m_localSums.add(curatorLabel->foundSums);
+    }
+}
+
+void AnalyticsSession::objectiveFound(QString objectiveId, QString curatorId, int r, int s, int n, float lostness, QString startNode, QString endNode)
+{
+    Q_ASSERT(m_curatorLabelsHash.contains(curatorId));
+    Q_ASSERT(m_curatorLabelsHash[curatorId]->narrativeDependenciesHash.contains(objectiveId) || m_curatorLabelsHash[curatorId]->startDependency->id == objectiveId);
+
+    qDebug() << "obj: " << objectiveId << "cur: " << curatorId << "r: " << r << "s: " << s << "n: " << n << "lostness" << lostness;
+    qDebug() << "start: " << startNode << "end: " << endNode;
+
+    SessionCuratorLabel *curatorLabel = m_curatorLabelsHash[curatorId];
+    SessionObjective *objective;
+
+    if(curatorLabel->narrativeDependenciesHash.contains(objectiveId))
+        objective = curatorLabel->narrativeDependenciesHash[objectiveId];
+    else
+        objective = curatorLabel->startDependency;
+
+    uncountObjective(curatorLabel, objective);
+
+    //set objective to found and add all lostness data
+    objective->found = true;
+    objective->minSteps = r;
+    objective->totalNumOfNodesVisited = s;
+    objective->totalNumUniqueNodesVisited = n;
+    objective->lostness = lostness;
+    objective->startNode = startNode;
+    objective->endNode = endNode;
+
+    //update progress for curator label and full game
+    countObjective(curatorLabel, objective);
+}
+
+bool AnalyticsSession::possibleObjectiveFound(QString objectiveId)
+{
+    OwnedObjective owned = m_objectivesHash.value(objectiveId, OwnedObjective(nullptr, nullptr));
+
+    SessionObjective* objective = owned.second;
+
+    SessionCuratorLabel* objOwner = owned.first;
+
+    if(objective == nullptr)
+        return false; //not found
+
+    uncountObjective(objOwner, objective);
+
+    //save the information needed for lostness to the objective
+    objective->found = true;
+    objective->startNode = m_firstNode;
+    objective->endNode = m_endNode;
+    objective->totalNumOfNodesVisited = m_totalNodes;
+    objective->totalNumUniqueNodesVisited = m_uniqueNodes.size();
+
+    //calculate lostness
+    getLostnessofObjective(objOwner->id, objective->id);
+
+    //reset everything for next objective
+    m_firstNode = m_lastLocomotionNode;
+
+    m_totalNodes = 0;
+    m_uniqueNodes.clear();
+
+    //update progress for curator label and full game
+    countObjective(objOwner, objective);
+
+    return true;
+}
+
+void AnalyticsSession::updateLocalLostness()
+{
+    m_localLostness = Lostness::getLostnessValue(m_localSums.r, m_localSums.s, m_localSums.n);
+}
+
+float AnalyticsSession::getCuratorLabelProgress(QString curatorId)
+{
+    return m_curatorLabelsHash[curatorId]->progress;
+}
+
+QString AnalyticsSession::getParentId(QString objectiveId)
+{
+    if(m_objectivesHash.contains(objectiveId))
+        return m_objectivesHash[objectiveId].first->id;
+
+    return "";  //error
+}
@@ -0,0 +1,304 @@
+#ifndef ANALYTICSSESSION_H
+#define ANALYTICSSESSION_H
+
+#include <QString>
+#include <QByteArray>
+#include <QStringList>
+#include <QList>
+#include <QHash>
+#include <QPair>
+#include <QSet>
+#include <QMetaType>
+#include <QSharedPointer>
+
+#include "analyticsdelta.h"
+#include "analyticsverbs.h"
+#include "analyticsevent.h"
+#include "analyticsframer.h"
+
+class Lostness;
+
+struct CuratorLabelDefinition
+{
+    QString id;
+    QString startObjective;
+    QStringList objectives;
+    int minSteps;
+};
+
+///
+/// \brief Snapshot of the tasks set up in the CuratorAnalyticsEditor, used to build a session
+///
+struct AnalyticsSessionConfig
+{
+    QList<CuratorLabelDefinition> curatorLabels;
+    QSharedPointer<const Lostness> lostnessHandler;    //spatial graph, never changed once sessions have it
+    AnalyticsVerbTable verbs;
+};
+
+Q_DECLARE_METATYPE(AnalyticsSessionConfig)
+
+struct SessionObjective
+{
+    SessionObjective(QString objectiveId)
+        : id(objectiveId)
+    {
+        reset();
+    }
+
+    void reset()
+    {
+        minSteps = 0;
+        totalNumOfNodesVisited = 0;
+        totalNumUniqueNodesVisited = 0;
+        lostness = -1;
+        startNode = "";
+        endNode = "";
+        found = false;
+    }
+
+    QString id;
+    int minSteps;
+    int totalNumOfNodesVisited;
+    int totalNumUniqueNodesVisited;
+    float lostness;
+    QString startNode;
+    QString endNode;
+    bool found;
+};
+
+///
+/// \brief R, S and N summed over found objectives, changed as objectives are found instead of summed again
+///
+struct LostnessSums
+{
+    LostnessSums() : r(0), s(0), n(0) {}
+
+    void add(const SessionObjective &objective)
+    {
+        r += objective.minSteps;
+        s += objective.totalNumOfNodesVisited;
+        n += objective.totalNumUniqueNodesVisited;
+    }
+
+    void remove(const SessionObjective &objective)
+    {
+        r -= objective.minSteps;
+        s -= objective.totalNumOfNodesVisited;
+        n -= objective.totalNumUniqueNodesVisited;
+    }
+
+    void add(const LostnessSums &other)
+    {
+        r += other.r;
+        s += other.s;
+        n += other.n;
+    }
+
+    void remove(const LostnessSums &other)
+    {
+        r -= other.r;
+        s -= other.s;
+        n -= other.n;
+    }
+
+    int r;
+    int s;
+    int n;
+};
+
+struct SessionCuratorLabel
+{
+    ~SessionCuratorLabel()
+    {
+        delete startDependency;
+        qDeleteAll(narrativeDependenciesList);
+    }
+
+    QString id;
+    QHash<QString, SessionObjective*> narrativeDependenciesHash;
+    QList<SessionObjective*> narrativeDependenciesList;
+    SessionObjective* startDependency;
+    int minSteps;
+
+    QList<QPair<QString, int>> uniqueNodesVisited; //object and verb id
+    int totalNumOfNodesVisited;
+    int totalNumUniqueNodesVisited;
+
+    QString startNode;
+    QString endNode;
+
+    float progress;
+    float lostness;
+
+    int numFound;               //narrative dependencies found
+    LostnessSums foundSums;     //of the found objectives, the start dependency included
+};
+
+///
+/// \brief Copy of everything a session has worked out, to carry on from later without replaying the events before it
+///
+struct AnalyticsSessionState
+{
+    struct CuratorLabel
+    {
+        CuratorLabel() : startDependency(QString()) {}
+
+        SessionObjective startDependency;
+        QList<SessionObjective> narrativeDependencies;
+
+        QList<QPair<QString, int>> uniqueNodesVisited;
+        int totalNumOfNodesVisited;
+        int totalNumUniqueNodesVisited;
+
+        QString startNode;
+        QString endNode;
+
+        float progress;
+        float lostness;
+    };
+
+    QList<CuratorLabel> curatorLabels;  //same order as the session's curator labels
+
+    float gameProgress;
+    float localLostness;
+
+    QString firstNode;
+    QString endNode;
+    QString lastLocomotionNode;
+    int totalNodes;
+    QList<QPair<QString, int>> uniqueNodes;
+
+    QList<QString> activeTasks;
+
+    bool hasStartTime;
+    AnalyticsTimestamp startTime;
+};
+
+///
+/// \brief Curator label and lostness state of one player, fed with xAPI events.
+///
+/// Contains no widgets so it can be owned by the ingest worker thread. Everything the GUI has to
+/// show is written into an AnalyticsDelta.
+///
+class AnalyticsSession
+{
+public:
+    AnalyticsSession();
+    ~AnalyticsSession();
+
+    void configure(const AnalyticsSessionConfig &config);
+    void resetAll();
+
+    void setFirstNode(QString node){m_firstNode = node;}
+    void resetStartTime(){m_hasStartTime = false;}
+
+    ///
+    /// \brief Sequence number of the last event handled, -1 if the game doesn't number its events
+    ///
+    qint64 getLastSequence() const {return m_lastSequence;}
+    void resetSequence(){m_lastSequence = -1; m_numDuplicates = 0;}
+
+    ///
+    /// \brief A JSON message holds one event or an array of them (log file), a CBOR message always holds one event
+    ///
+    void handleMessage(const QByteArray &message, PayloadFormat format, bool updateValues, bool loadLogFile, AnalyticsDelta &delta);
+
+    ///
+    /// \brief Handle an event read from a saved log
+    ///
+    void replayEvent(AnalyticsEvent &event, bool updateValues, AnalyticsDelta &delta);
+
+    bool isEmpty() const {return m_curatorLabelsList.empty();}
+
+    AnalyticsSessionState getState() const;
+
+    ///
+    /// \brief Go back to a state taken from this session, fails if the curator labels have been changed since
+    ///
+    bool setState(const AnalyticsSessionState &state);
+
+private:
+    typedef void (AnalyticsSession::*VerbHandler)(AnalyticsEvent &event, bool updateValues, AnalyticsDelta &delta);
+
+    void handleEvent(AnalyticsEvent &event, bool updateValues, bool loadLogFile, AnalyticsDelta &delta);
+    void handleTextOutput(const AnalyticsEvent &event, bool updateValues, bool loadLogFile, AnalyticsDelta &delta);
+    bool isDuplicate(const AnalyticsEvent &event);
+
+    ///
+    /// \brief Handlers for each VerbAction, looked up in s_verbHandlers
+    ///
+    void handleStartTask(AnalyticsEvent &event, bool updateValues, AnalyticsDelta &delta);
+    void handleCompleteTask(AnalyticsEvent &event, bool updateValues, AnalyticsDelta &delta);
+    void handlePathAction(AnalyticsEvent &event, bool updateValues, AnalyticsDelta &delta);
+    void handleAttempt(AnalyticsEvent &event, bool updateValues, AnalyticsDelta &delta);
+    void handleFound(AnalyticsEvent &event, bool updateValues, AnalyticsDelta &delta);
+
+    static const VerbHandler s_verbHandlers[VERB_ACTION_COUNT];
+
+    void updatePath(const QString &object, int verbId);
+    void nodeVisited(QString task, const QString &object, int verbId);
+    float getLostnessofCuratorLabel(QString id);
+    float getLostnessofCuratorLabelFromObjectives(QString id);
+
+    void updateGameProgress();
+    float getCuratorLabelProgress(QString curatorId);
+
+    ///
+    /// \brief Take an objective out of the running totals before it changes, countObjective() puts it back
+    ///
+    /// Between them the curator label's progress, the game progress and the local lostness are
+    /// brought up to date without going through the other objectives or curator labels.
+    ///
+    void uncountObjective(SessionCuratorLabel *curatorLabel, const SessionObjective *objective);
+    void countObjective(SessionCuratorLabel *curatorLabel, const SessionObjective *objective);
+
+    ///
+    /// \brief Work out the running totals from every objective, after they have all been set at once
+    ///
+    void recount();
+
+    void objectiveFound(QString objectiveId, QString curatorId, int r, int s, int n, float lostness, QString startNode, QString endNode);
+    bool possibleObjectiveFound(QString objectiveId);
+
+    float getLostnessofObjective(QString curatorId, QString objectiveId);
+    float getLostnessofObjective(QString curatorId, QString objectiveId, int &r, int &s, int &n, QString &startNode, QString &endNode);
+
+    void updateLocalLostness();
+    void setGameValues(AnalyticsDelta &delta);
+
+    QString getParentId(QString objectiveId);
+
+    QHash<QString, SessionCuratorLabel*> m_curatorLabelsHash;
+    QList<SessionCuratorLabel*> m_curatorLabelsList;
+
+    typedef QPair<SessionCuratorLabel*, SessionObjective*> OwnedObjective;
+    QHash<QString, OwnedObjective> m_objectivesHash;    //the first curator label to have the objective owns it
+
+    QSharedPointer<const Lostness> m_lostnessHandler;
+
+    float m_gameProgress;
+    float m_localLostness;
+
+    double m_progressSum;       //of every curator label
+    LostnessSums m_localSums;   //of the curator labels whose start dependency has been found
+
+    QString m_firstNode;
+    QString m_endNode;
+    QString m_lastLocomotionNode;
+    int m_totalNodes;
+    QList<QPair<QString, int>> m_uniqueNodes;
+
+    QList<QString> m_activeTasks;
+    AnalyticsVerbTable m_verbs;
+
+    bool m_hasStartTime;
+    AnalyticsTimestamp m_startTime;
+
+    qint64 m_lastSequence;
+    int m_numDuplicates;        //skipped since the last event that was handled
+
+    Q_DISABLE_COPY(AnalyticsSession)
+};
+
+#endif // ANALYTICSSESSION_H
@@ -0,0 +1,139 @@
+#include "analyticssessionsummary.h"
+
+void AnalyticsSessionSummary::apply(const AnalyticsDelta &delta)
+{
+    foreach (const QString &curatorLabel, delta.startedCuratorLabels)
+        if(!startedCuratorLabels.contains(curatorLabel))
+            startedCuratorLabels.append(curatorLabel);
+
+    foreach (const QString &node, delta.unlockedNodes)
+    {
+        if(!unlockedNodesSet.contains(node))
+        {
+            unlockedNodesSet.insert(node);
+            unlockedNodes.append(node);
+        }
+    }
+
+    for(QHash<QString, float>::const_iterator lostnessIt = delta.curatorLabelLostness.constBegin(); lostnessIt != delta.curatorLabelLostness.constEnd(); ++lostnessIt)
+        curatorLabelLostness.insert(lostnessIt.key(), lostnessIt.value());
+
+    for(QHash<QString, float>::const_iterator progressIt = delta.curatorLabelProgress.constBegin(); progressIt != delta.curatorLabelProgress.constEnd(); ++progressIt)
+        curatorLabelProgress.insert(progressIt.key(), progressIt.value());
+
+    foreach (const ObjectiveLostnessUpdate &update, delta.objectiveLostness)
+        objectiveLostness.insert(qMakePair(update.curatorLabel, update.objective), update.lostness);
+
+    if(delta.gameValuesChanged)
+    {
+        hasGameValues = true;
+        localLostness = delta.localLostness;
+        gameProgress = delta.gameProgress;
+    }
+
+    lostnessPoints += delta.lostnessPoints;
+}
+
+void AnalyticsSessionSummary::reset()
+{
+    startedCuratorLabels.clear();
+    unlockedNodes.clear();
+    unlockedNodesSet.clear();
+    curatorLabelLostness.clear();
+    curatorLabelProgress.clear();
+    objectiveLostness.clear();
+    hasGameValues = false;
+    localLostness = 0;
+    gameProgress = 0;
+    lostnessPoints.clear();
+}
+
+void AnalyticsSessionSummary::toDelta(AnalyticsDelta &delta) const
+{
+    delta.startedCuratorLabels = startedCuratorLabels;
+    delta.unlockedNodes = unlockedNodes;
+    delta.curatorLabelLostness = curatorLabelLostness;
+    delta.curatorLabelProgress = curatorLabelProgress;
+
+    for(QHash<QPair<QString, QString>, float>::const_iterator objectiveIt = objectiveLostness.constBegin(); objectiveIt != objectiveLostness.constEnd(); ++objectiveIt)
+        delta.objectiveLostness.append(ObjectiveLostnessUpdate(objectiveIt.key().first, objectiveIt.key().second, objectiveIt.value()));
+
+    delta.gameValuesChanged = hasGameValues;
+    delta.localLostness = localLostness;
+    delta.gameProgress = gameProgress;
+
+    delta.lostnessPoints = lostnessPoints;
+}
+
+void AnalyticsSessionSummary::aggregate(const QList<const AnalyticsSessionSummary*> &sessions, AnalyticsDelta &delta)
+{
+    QSet<QString> started, unlocked;
+    QHash<QString, QPair<float, int>> labelLostness, labelProgress;
+    QHash<QPair<QString, QString>, QPair<float, int>> objectives;
+    float sumLostness(0), sumProgress(0);
+    int numGameValues(0);
+
+    foreach (const AnalyticsSessionSummary *session, sessions)
+    {
+        foreach (const QString &curatorLabel, session->startedCuratorLabels)
+            if(!started.contains(curatorLabel))
+            {
+                started.insert(curatorLabel);
+                delta.startedCuratorLabels.append(curatorLabel);
+            }
+
+        foreach (const QString &node, session->unlockedNodes)
+            if(!unlocked.contains(node))
+            {
+                unlocked.insert(node);
+                delta.unlockedNodes.append(node);
+            }
+
+        //lostness below zero means it couldn't be calculated, leave it out of the average
+        for(QHash<QString, float>::const_iterator lostnessIt = session->curatorLabelLostness.constBegin(); lostnessIt != session->curatorLabelLostness.constEnd(); ++lostnessIt)
+            if(lostnessIt.value() >= 0)
+            {
+                labelLostness[lostnessIt.key()].first += lostnessIt.value();
+                ++labelLostness[lostnessIt.key()].second;
+            }
+
+        for(QHash<QString, float>::const_iterator progressIt = session->curatorLabelProgress.constBegin(); progressIt != session->curatorLabelProgress.constEnd(); ++progressIt)
+        {
+            labelProgress[progressIt.key()].first += progressIt.value();
+            ++labelProgress[progressIt.key()].second;
+        }
+
+        for(QHash<QPair<QString, QString>, float>::const_iterator objectiveIt = session->objectiveLostness.constBegin(); objectiveIt != session->objectiveLostness.constEnd(); ++objectiveIt)
+            if(objectiveIt.value() >= 0)
+            {
+                objectives[objectiveIt.key()].first += objectiveIt.value();
+                ++objectives[objectiveIt.key()].second;
+            }
+
+        if(session->hasGameValues)
+        {
+            sumLostness += session->localLostness;
+            sumProgress += session->gameProgress;
+            ++numGameValues;
+        }
+    }
+
+    //progress is averaged over every player, not only the ones that have made some
+    int numSessions = qMax(sessions.size(), 1);
+
+    for(QHash<QString, QPair<float, int>>::const_iterator it = labelLostness.constBegin(); it != labelLostness.constEnd(); ++it)
+        delta.curatorLabelLostness.insert(it.key(), it.value().first / it.value().second);
+
+    for(QHash<QString, QPair<float, int>>::const_iterator it = labelProgress.constBegin(); it != labelProgress.constEnd(); ++it)
+        delta.curatorLabelProgress.insert(it.key(), it.value().first / numSessions);
+
+    for(QHash<QPair<QString, QString>, QPair<float, int>>::const_iterator it = objectives.constBegin(); it != objectives.constEnd(); ++it)
+        delta.objectiveLostness.append(ObjectiveLostnessUpdate(it.key().first, it.key().second, it.value().first / it.value().second));
+
+    if(numGameValues > 0)
+    {
+        delta.gameValuesChanged = true;
+        delta.localLostness = sumLostness / numGameValues;
+        delta.gameProgress = sumProgress / numSessions;
+    }
+}
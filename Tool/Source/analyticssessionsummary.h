@@ -0,0 +1,61 @@
+#ifndef ANALYTICSSESSIONSUMMARY_H
+#define ANALYTICSSESSIONSUMMARY_H
+
+#include <QString>
+#include <QStringList>
+#include <QHash>
+#include <QSet>
+#include <QPair>
+#include <QVector>
+#include <QPointF>
+
+#include "analyticsdelta.h"
+
+///
+/// \brief GUI side copy of what one player's deltas have shown so far.
+///
+/// Lets the dashboard switch between players, or average them, without asking the ingest workers
+/// for their state.
+///
+struct AnalyticsSessionSummary
+{
+    AnalyticsSessionSummary()
+        : hasGameValues(false)
+        , localLostness(0)
+        , gameProgress(0)
+        , connected(false)
+    {}
+
+    void apply(const AnalyticsDelta &delta);
+    void reset();
+
+    ///
+    /// \brief Fill a delta that brings a cleared view up to the state of this session
+    ///
+    void toDelta(AnalyticsDelta &delta) const;
+
+    ///
+    /// \brief Average the values of all sessions into one delta, nodes and started labels are merged
+    ///
+    static void aggregate(const QList<const AnalyticsSessionSummary*> &sessions, AnalyticsDelta &delta);
+
+    QString name;
+
+    QStringList startedCuratorLabels;
+    QStringList unlockedNodes;
+    QSet<QString> unlockedNodesSet;
+
+    QHash<QString, float> curatorLabelLostness;
+    QHash<QString, float> curatorLabelProgress;
+    QHash<QPair<QString, QString>, float> objectiveLostness;
+
+    bool hasGameValues;
+    float localLostness;
+    float gameProgress;
+
+    QVector<QPointF> lostnessPoints;
+
+    bool connected;
+};
+
+#endif // ANALYTICSSESSIONSUMMARY_H
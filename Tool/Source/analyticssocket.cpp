@@ -1,115 +1,265 @@
 #include "analyticssocket.h"
 
-AnalyticsSocket::AnalyticsSocket(/*AnalyticsLogWindow* analyticsLog,*/ QWidget *parent)
-    : QDialog(parent)
- //   , m_analyticsLog(analyticsLog)
+#include "analyticsprotocol.h"
+
+static const int kConnectTimeout = 5000;            //ms
+static const int kInitialReconnectDelay = 500;      //ms, doubled after every failed attempt
+static const int kMaxReconnectDelay = 30000;        //ms
+static const int kAckInterval = 200;                //ms, acks are batched so dense streams don't get one per event
+
+AnalyticsSocket::AnalyticsSocket(QObject *parent)
+    : QObject(parent)
+    , m_socket(nullptr)
+    , m_state(STATE_DISCONNECTED)
+    , m_framing(FRAMING_NEWLINE)
+    , m_offerBinary(false)
+    , m_negotiating(false)
+    , m_format(PAYLOAD_JSON)
+    , m_canReconnect(false)
+    , m_hasConnected(false)
+    , m_reconnectAttempt(0)
+    , m_connectTimer(new QTimer(this))
+    , m_reconnectTimer(new QTimer(this))
+    , m_handledSequence(-1)
+    , m_sentAck(-1)
+    , m_ackTimer(new QTimer(this))
+    , m_port(0)
 {
+    m_connectTimer->setSingleShot(true);
+    m_connectTimer->setInterval(kConnectTimeout);
+    connect(m_connectTimer, SIGNAL(timeout()), this, SLOT(connectTimedOut()));
+
+    m_reconnectTimer->setSingleShot(true);
+    connect(m_reconnectTimer, SIGNAL(timeout()), this, SLOT(reconnect()));
 
+    m_ackTimer->setSingleShot(true);
+    m_ackTimer->setInterval(kAckInterval);
+    connect(m_ackTimer, SIGNAL(timeout()), this, SLOT(sendAck()));
 }
 
-void AnalyticsSocket::SetUpSocket()
+void AnalyticsSocket::connectToServer(QString address, int port, FramingMode framing, bool offerBinary)
 {
-    QLabel *ipLabel = new QLabel("IP: ");
-    QLineEdit *ipField = new QLineEdit();
+    m_address = address;
+    m_port = port;
+    m_framing = framing;
+    m_offerBinary = offerBinary;
 
-    QLabel *portLabel = new QLabel("Port: ");
-    QLineEdit *portField = new QLineEdit();
+    //a new session, nothing to resume
+    m_canReconnect = true;
+    m_hasConnected = false;
+    m_reconnectAttempt = 0;
+    m_handledSequence = -1;
+    m_sentAck = -1;
+    m_reconnectTimer->stop();
 
-    QPushButton *connectBtn = new QPushButton("Connect");
-    QPushButton *cancelBtn = new QPushButton("Cancel");
+    qDebug() << "Connecting...";
 
-    connect(connectBtn, &QPushButton::released, [=]{connectToServer(ipField->text(), portField->text().toInt());});
+    openConnection();
+}
 
-    connect(cancelBtn, &QPushButton::released, [=]{this->hide();});
+bool AnalyticsSocket::acceptConnection(qintptr socketDescriptor, FramingMode framing, bool offerBinary)
+{
+    releaseSocket();
 
-    QGridLayout *mainLayout = new QGridLayout;
-    mainLayout->addWidget(ipLabel, 0, 0);
-    mainLayout->addWidget(ipField, 0, 1);
-    mainLayout->addWidget(portLabel, 1, 0);
-    mainLayout->addWidget(portField, 1, 1);
-    mainLayout->addWidget(connectBtn);
-    mainLayout->addWidget(cancelBtn);
-    setLayout(mainLayout);
+    m_framing = framing;
+    m_offerBinary = offerBinary;
+    m_canReconnect = false;
+    m_hasConnected = true;
+    m_handledSequence = -1;
+    m_sentAck = -1;
 
-    setWindowTitle(tr("Connect to Server"));
+    m_framer.setMode(m_framing);
+    m_framer.reset();
+    m_format = PAYLOAD_JSON;
+    m_negotiating = m_offerBinary;
 
-    this->show();
-}
+    m_socket = new QTcpSocket(this);
 
-void AnalyticsSocket::connectToServer(QString address, int port)
-{
-    if(address == "")
+    if(!m_socket->setSocketDescriptor(socketDescriptor))
     {
-        QMessageBox messageBox;
-        messageBox.critical(0,"Error","Address cannot be empty.");
-        messageBox.setFixedSize(500,200);
+        errorCallback(m_socket->errorString());
+        releaseSocket();
+        return false;
     }
-    else
-        if(port == 0)
-        {
-            QMessageBox messageBox;
-            messageBox.critical(0,"Error","Port is invalid.");
-            messageBox.setFixedSize(500,200);
-        }
-    else
-        {
-            m_address = address;
-            m_port = port;
 
-            m_socket = new QTcpSocket(this);
+    m_address = m_socket->peerAddress().toString();
+    m_port = m_socket->peerPort();
+
+    attachSocket();
+    m_state = STATE_CONNECTED;
+
+    startHandshake();
+
+    //the game may have sent events before the socket was handed to this thread
+    if(m_socket->bytesAvailable() > 0)
+        readyRead();
+
+    return true;
+}
+
+void AnalyticsSocket::acknowledge(qint64 sequence)
+{
+    if(sequence <= m_handledSequence)
+        return;
 
-            connect(m_socket, SIGNAL(connected()), this, SLOT(connected()));
-            connect(m_socket, SIGNAL(disconnected()), this, SLOT(disconnected()));
-            connect(m_socket, SIGNAL(bytesWritten(qint64)), this, SLOT(bytesWritten(qint64)));
-            connect(m_socket, SIGNAL(readyRead()), this, SLOT(readyRead()));
+    m_handledSequence = sequence;
 
-            qDebug() << "Connecting...";
+    if(!m_ackTimer->isActive())
+        m_ackTimer->start();
+}
+
+void AnalyticsSocket::openConnection()
+{
+    releaseSocket();
 
-            m_socket->connectToHost(address, port);
+    m_framer.setMode(m_framing);
+    m_framer.reset();
+    m_format = PAYLOAD_JSON;
+    m_negotiating = m_offerBinary;
 
-            this->hide();
+    m_socket = new QTcpSocket(this);
 
-            if(!m_socket->waitForConnected(5000))
-            {
-                QMessageBox messageBox;
-                messageBox.critical(0,"Error",m_socket->errorString());
-                messageBox.setFixedSize(500,200);
-                this->show();
-            }
-        }
+    attachSocket();
+    connect(m_socket, SIGNAL(connected()), this, SLOT(connected()));
+    connect(m_socket, SIGNAL(error(QAbstractSocket::SocketError)), this, SLOT(socketError(QAbstractSocket::SocketError)));
+
+    m_state = STATE_CONNECTING;
+
+    //returns straight away, connected() or socketError() follow
+    m_socket->connectToHost(m_address, quint16(m_port));
+    m_connectTimer->start();
+}
+
+void AnalyticsSocket::attachSocket()
+{
+    connect(m_socket, SIGNAL(disconnected()), this, SLOT(disconnected()));
+    connect(m_socket, SIGNAL(bytesWritten(qint64)), this, SLOT(bytesWritten(qint64)));
+    connect(m_socket, SIGNAL(readyRead()), this, SLOT(readyRead()));
+}
+
+void AnalyticsSocket::releaseSocket()
+{
+    if(!m_socket)
+        return;
+
+    //no more signals from it, the state machine has already moved on
+    m_socket->disconnect(this);
+    m_socket->abort();
+    m_socket->deleteLater();
+    m_socket = nullptr;
 }
 
 void AnalyticsSocket::connected()
 {
-    qDebug() << "Connected.";
-    QMessageBox messageBox;
-    messageBox.information(0, "Connected", "Connected to: " + m_address + ":" + QString::number(m_port));
-    messageBox.setFixedSize(500,200);
+    m_connectTimer->stop();
+    m_state = STATE_CONNECTED;
+    m_reconnectAttempt = 0;
 
-    //m_socket->write("Send me some stuff");
+    startHandshake();
 
-    //m_analyticsLog->initialiseLogFile();
+    if(m_hasConnected)
+    {
+        qDebug() << "Reconnected, resuming after event" << m_handledSequence;
+        reconnectedCallback();
+        return;
+    }
 
+    qDebug() << "Connected.";
+
+    m_hasConnected = true;
     connectedCallback();
 }
 
 void AnalyticsSocket::disconnected()
 {
-    qDebug() << "Disconnected.";
+    if(m_state == STATE_DISCONNECTED)
+    {
+        //asked for by the user
+        qDebug() << "Disconnected.";
 
-    QMessageBox messageBox;
-    messageBox.information(0, "Disconnected", "Disconnected from: " + m_address + ":" + QString::number(m_port));
-    messageBox.setFixedSize(500,200);
+        releaseSocket();
+        disconnectedCallback();
+        return;
+    }
 
-    m_socket->deleteLater();
-    m_socket->close();
+    connectionFailed("Connection lost");
+}
+
+void AnalyticsSocket::socketError(QAbstractSocket::SocketError error)
+{
+    Q_UNUSED(error);
 
-    disconnectedCallback();
+    //errors on an established connection are followed by disconnected()
+    if(m_state == STATE_CONNECTING)
+        connectionFailed(m_socket->errorString());
+}
+
+void AnalyticsSocket::connectTimedOut()
+{
+    if(m_state == STATE_CONNECTING)
+        connectionFailed("Connection timed out");
+}
+
+void AnalyticsSocket::connectionFailed(QString reason)
+{
+    releaseSocket();
+    m_connectTimer->stop();
+    m_ackTimer->stop();
+
+    if(!m_hasConnected)
+    {
+        m_state = STATE_DISCONNECTED;
+        errorCallback(reason);
+        return;
+    }
+
+    if(!m_canReconnect)
+    {
+        qDebug() << "Disconnected.";
+
+        m_state = STATE_DISCONNECTED;
+        disconnectedCallback();
+        return;
+    }
+
+    int delay = qMin(kInitialReconnectDelay << qMin(m_reconnectAttempt, 10), kMaxReconnectDelay);
+    ++m_reconnectAttempt;
+
+    qDebug() << reason << "- reconnecting in" << delay << "ms";
+
+    m_state = STATE_WAITING_TO_RECONNECT;
+    m_reconnectTimer->start(delay);
+
+    connectionLost(reason, delay);
+}
+
+void AnalyticsSocket::reconnect()
+{
+    if(m_state == STATE_WAITING_TO_RECONNECT)
+        openConnection();
 }
 
 void AnalyticsSocket::disconnectFromServer()
 {
-    m_socket->disconnectFromHost();
+    m_reconnectTimer->stop();
+    m_connectTimer->stop();
+
+    ConnectionState previousState = m_state;
+
+    if(previousState == STATE_CONNECTED)
+    {
+        sendAck();  //so the game doesn't keep events that were handled
+
+        m_state = STATE_DISCONNECTED;
+        m_socket->disconnectFromHost();     //disconnected() ends the session
+        return;
+    }
+
+    m_state = STATE_DISCONNECTED;
+    releaseSocket();
+
+    if(previousState != STATE_DISCONNECTED)
+        disconnectedCallback();
 }
 
 void AnalyticsSocket::bytesWritten(qint64 bytes)
@@ -119,12 +269,60 @@ void AnalyticsSocket::bytesWritten(qint64 bytes)
 
 void AnalyticsSocket::readyRead()
 {
-    //qDebug() << "Reading...";
-    QString data = m_socket->readAll();
-    //qDebug() << data;
-    //qDebug() << m_socket->readAll();
-    //m_analyticsLog->appendMessage(data);
-    //m_socket->write(data.toStdString().c_str());
+    //several events can arrive in one read, or an event can be split across reads
+    m_framer.readFrom(m_socket);
+
+    if(m_negotiating && !negotiate())
+        return;
+
+    QByteArray frame;
+    while(m_framer.nextFrame(frame))
+        readMessage(frame, m_format);
+}
+
+void AnalyticsSocket::sendAck()
+{
+    if(m_state != STATE_CONNECTED || m_handledSequence <= m_sentAck)
+        return;
+
+    m_socket->write(AnalyticsProtocol::frame(AnalyticsProtocol::ackMessage(m_handledSequence), m_framing));
+    m_sentAck = m_handledSequence;
+}
+
+void AnalyticsSocket::startHandshake()
+{
+    if(!m_offerBinary && m_handledSequence < 0)
+        return;     //nothing to tell the game, older builds never read from the socket
+
+    //sent in the framing the game was set up with, whatever format it answers in
+    m_socket->write(AnalyticsProtocol::frame(AnalyticsProtocol::helloMessage(m_offerBinary, m_handledSequence), m_framing));
+    m_sentAck = m_handledSequence;
+}
+
+bool AnalyticsSocket::negotiate()
+{
+    QByteArray preamble = AnalyticsProtocol::streamPreamble();
+    QByteArray head = m_framer.peek(preamble.size());
+
+    if(head.isEmpty())
+        return false;
+
+    if(!preamble.startsWith(head))
+    {
+        //JSON text from a game that doesn't know the hello, or chose to stay with JSON
+        m_negotiating = false;
+        return true;
+    }
+
+    if(head.size() < preamble.size())
+        return false;   //wait for the rest of the preamble
+
+    qDebug() << "Game switched to binary events";
+
+    m_framer.skip(preamble.size());
+    m_framer.setMode(FRAMING_LENGTH_PREFIXED, true);
+    m_format = PAYLOAD_CBOR;
+    m_negotiating = false;
 
-    readMessage(data);
+    return true;
 }
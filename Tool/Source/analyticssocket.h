@@ -1,47 +1,110 @@
 #ifndef ANALYTICSSOCKET_H
 #define ANALYTICSSOCKET_H
 
-#include <QDialog>
+#include <QObject>
 #include <QDebug>
 
 #include <QTcpSocket>
 #include <QAbstractSocket>
+#include <QTimer>
 
-#include <QLabel>
-#include <QLineEdit>
-#include <QPushButton>
-#include <QGridLayout>
-#include <QMessageBox>
+#include "analyticsframer.h"
 
-#include "analyticslogwindow.h"
-
-class AnalyticsSocket : public QDialog
+///
+/// \brief TCP connection to the game. Lives on the ingest worker thread, so it must not touch any widgets.
+///
+/// Connecting never blocks. Once a connection made with connectToServer() has been established, a
+/// dropped connection is retried with exponential backoff until it comes back or the user disconnects,
+/// and the game is asked to resend everything after the last event that was acknowledged.
+///
+class AnalyticsSocket : public QObject
 {
     Q_OBJECT
 public:
-    explicit AnalyticsSocket(/*AnalyticsLogWindow* analyticsLog, */QWidget *parent = 0);
+    enum ConnectionState
+    {
+        STATE_DISCONNECTED,
+        STATE_CONNECTING,
+        STATE_CONNECTED,
+        STATE_WAITING_TO_RECONNECT
+    };
+
+    explicit AnalyticsSocket(QObject *parent = 0);
 
     QString getAddressAndPort(){return m_address + ":" + QString::number(m_port);}
 
+    ///
+    /// \brief True while the connection is up or being re-established
+    ///
+    bool isConnected() const {return m_state != STATE_DISCONNECTED;}
+
+    ConnectionState getState() const {return m_state;}
+
+    ///
+    /// \brief offerBinary sends a hello offering CBOR, the game's reply decides the format of the whole connection
+    ///
+    void connectToServer(QString address, int port, FramingMode framing, bool offerBinary);
+
+    ///
+    /// \brief Take over a connection accepted by the AnalyticsServer (listening mode), these are not reconnected
+    ///
+    bool acceptConnection(qintptr socketDescriptor, FramingMode framing, bool offerBinary);
+
+    ///
+    /// \brief Every event up to and including sequence has been handled, batched into one ack to the game
+    ///
+    void acknowledge(qint64 sequence);
+
+    PayloadFormat getPayloadFormat() const {return m_format;}
+
 signals:
     void connectedCallback();
     void disconnectedCallback();
-    void readMessage(QString message);
+    void errorCallback(QString error);
+    void connectionLost(QString reason, int retryInMs);
+    void reconnectedCallback();
+    void readMessage(const QByteArray &message, PayloadFormat format);   //slice of the receive buffer, only valid during the call
 
 public slots:
-    void SetUpSocket();
-
     void connected();
     void disconnected();
     void disconnectFromServer();
     void bytesWritten(qint64 bytes);
     void readyRead();
 
+private slots:
+    void socketError(QAbstractSocket::SocketError error);
+    void connectTimedOut();
+    void reconnect();
+    void sendAck();
+
 private:
-    void connectToServer(QString address, int port);
+    void openConnection();
+    void attachSocket();
+    void releaseSocket();
+    void connectionFailed(QString reason);
+
+    void startHandshake();
+    bool negotiate();
 
     QTcpSocket *m_socket;
-    AnalyticsLogWindow *m_analyticsLog;
+    AnalyticsFramer m_framer;
+    ConnectionState m_state;
+
+    FramingMode m_framing;
+    bool m_offerBinary;
+    bool m_negotiating;     //waiting for the first bytes of the game to see which format it chose
+    PayloadFormat m_format;
+
+    bool m_canReconnect;    //only connections made by the tool, accepted players reconnect by themselves
+    bool m_hasConnected;    //the first attempt failing is reported as an error instead of retried
+    int m_reconnectAttempt;
+    QTimer *m_connectTimer;
+    QTimer *m_reconnectTimer;
+
+    qint64 m_handledSequence;   //last event handled, the game resends everything after it on reconnect
+    qint64 m_sentAck;
+    QTimer *m_ackTimer;
 
     QString m_address;
     int m_port;
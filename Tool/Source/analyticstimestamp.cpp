@@ -0,0 +1,162 @@
+#include "analyticstimestamp.h"
+
+#include <QDateTime>
+
+static const QString kName_DisplayFormat = "MMM dd, yyyy hh:mm:ss t";
+
+static inline bool readDigits(const char *text, int count, int &value)
+{
+    value = 0;
+
+    for(int i = 0; i < count; ++i)
+    {
+        if(text[i] < '0' || text[i] > '9')
+            return false;
+
+        value = value * 10 + (text[i] - '0');
+    }
+
+    return true;
+}
+
+static inline bool isLeapYear(int year)
+{
+    return (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+}
+
+static int daysInMonth(int year, int month)
+{
+    static const int kDays[12] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    return month == 2 && isLeapYear(year) ? 29 : kDays[month - 1];
+}
+
+static qint64 daysFromCivil(int year, int month, int day)
+{
+    //days since 1970-01-01 in the proleptic Gregorian calendar
+    year -= month <= 2;
+    const qint64 era = (year >= 0 ? year : year - 399) / 400;
+    const int yearOfEra = int(year - era * 400);
+    const int dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    const int dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    return era * 146097 + dayOfEra - 719468;
+}
+
+AnalyticsTimestamp AnalyticsTimestamp::fromIsoString(const char *text, int length)
+{
+    AnalyticsTimestamp timestamp;
+    int year, month, day, hour, minute, second, msec = 0;
+
+    //fixed part, yyyy-MM-ddThh:mm:ss
+    if(length >= 19 && text[4] == '-' && text[7] == '-' && (text[10] == 'T' || text[10] == ' ') && text[13] == ':' && text[16] == ':' &&
+            readDigits(text, 4, year) && readDigits(text + 5, 2, month) && readDigits(text + 8, 2, day) &&
+            readDigits(text + 11, 2, hour) && readDigits(text + 14, 2, minute) && readDigits(text + 17, 2, second) &&
+            month >= 1 && month <= 12 && day >= 1 && day <= daysInMonth(year, month) && hour < 24 && minute < 60 && second < 60)
+    {
+        int pos = 19;
+
+        //fraction of a second, only milliseconds are kept
+        if(pos < length && (text[pos] == '.' || text[pos] == ','))
+        {
+            ++pos;
+            int digits = 0;
+
+            while(pos < length && text[pos] >= '0' && text[pos] <= '9')
+            {
+                if(digits < 3)
+                    msec = msec * 10 + (text[pos] - '0');
+
+                ++digits;
+                ++pos;
+            }
+
+            if(digits == 0)
+                return fromIsoString(QString::fromUtf8(text, length));
+
+            for(; digits < 3; ++digits)
+                msec *= 10;
+        }
+
+        int offset = 0;
+        bool hasZone = false;
+
+        if(pos < length && text[pos] == 'Z')
+        {
+            hasZone = true;
+            ++pos;
+        }
+        else
+            if(pos < length && (text[pos] == '+' || text[pos] == '-'))
+            {
+                int offsetHours, offsetMinutes = 0;
+                int sign = text[pos] == '-' ? -1 : 1;
+                ++pos;
+
+                if(pos + 2 > length || !readDigits(text + pos, 2, offsetHours))
+                    return fromIsoString(QString::fromUtf8(text, length));
+
+                pos += 2;
+
+                if(pos < length && text[pos] == ':')
+                    ++pos;
+
+                if(pos + 2 <= length && readDigits(text + pos, 2, offsetMinutes))
+                    pos += 2;
+
+                offset = sign * (offsetHours * 3600 + offsetMinutes * 60);
+                hasZone = true;
+            }
+
+        //no time zone means local time, leave that to QDateTime
+        if(hasZone && pos == length)
+        {
+            timestamp.msecs = ((daysFromCivil(year, month, day) * 24 + hour) * 60 + minute) * qint64(60000) + second * 1000 + msec - offset * qint64(1000);
+            timestamp.offsetSeconds = offset;
+            timestamp.timeSpec = offset == 0 ? Qt::UTC : Qt::OffsetFromUTC;
+            timestamp.valid = true;
+            return timestamp;
+        }
+    }
+
+    return fromIsoString(QString::fromUtf8(text, length));
+}
+
+AnalyticsTimestamp AnalyticsTimestamp::fromIsoString(const QString &text)
+{
+    AnalyticsTimestamp timestamp;
+    QDateTime dateTime = QDateTime::fromString(text, Qt::ISODate);
+
+    if(dateTime.isValid())
+    {
+        timestamp.msecs = dateTime.toMSecsSinceEpoch();
+        timestamp.offsetSeconds = dateTime.offsetFromUtc();
+        timestamp.timeSpec = dateTime.timeSpec();
+        timestamp.valid = true;
+    }
+
+    return timestamp;
+}
+
+static QDateTime toDateTime(const AnalyticsTimestamp &timestamp)
+{
+    //only an explicit offset is kept as one, local time follows the zone it is shown in
+    if(timestamp.timeSpec == Qt::OffsetFromUTC)
+        return QDateTime::fromMSecsSinceEpoch(timestamp.msecs, Qt::OffsetFromUTC, timestamp.offsetSeconds);
+
+    return QDateTime::fromMSecsSinceEpoch(timestamp.msecs, timestamp.timeSpec);
+}
+
+QString AnalyticsTimestamp::toString() const
+{
+    if(!valid)
+        return QString();
+
+    return toDateTime(*this).toString(kName_DisplayFormat);
+}
+
+QString AnalyticsTimestamp::toIsoString() const
+{
+    if(!valid)
+        return QString();
+
+    return toDateTime(*this).toString(Qt::ISODateWithMs);
+}
@@ -0,0 +1,45 @@
+#ifndef ANALYTICSTIMESTAMP_H
+#define ANALYTICSTIMESTAMP_H
+
+#include <QString>
+#include <QtGlobal>
+
+///
+/// \brief Event time decoded once from the ISO 8601 string sent by the game.
+///
+/// Kept as milliseconds since the epoch plus the UTC offset it was written with, so it can be
+/// compared cheaply and only turned into a QDateTime when a log line is actually shown. A time
+/// written without a zone is local time, and is shown as local time.
+///
+struct AnalyticsTimestamp
+{
+    AnalyticsTimestamp() : msecs(0), offsetSeconds(0), timeSpec(Qt::UTC), valid(false) {}
+
+    ///
+    /// \brief Decode "yyyy-MM-ddThh:mm:ss[.zzz][Z|+hh:mm]", other formats go through QDateTime
+    ///
+    static AnalyticsTimestamp fromIsoString(const char *text, int length);
+    static AnalyticsTimestamp fromIsoString(const QString &text);
+
+    ///
+    /// \brief Whole seconds from this time to other, 0 if either is invalid (same as QDateTime::secsTo)
+    ///
+    qint64 secsTo(const AnalyticsTimestamp &other) const {return valid && other.valid ? (other.msecs - msecs) / 1000 : 0;}
+
+    ///
+    /// \brief Format for the log window, empty if invalid
+    ///
+    QString toString() const;
+
+    ///
+    /// \brief ISO 8601 with milliseconds and the original UTC offset, for events that arrived without a timestamp string
+    ///
+    QString toIsoString() const;
+
+    qint64 msecs;
+    int offsetSeconds;
+    Qt::TimeSpec timeSpec;  //Qt::LocalTime if it was written without a zone
+    bool valid;
+};
+
+#endif // ANALYTICSTIMESTAMP_H
@@ -0,0 +1,102 @@
+#include "analyticsupdatecoalescer.h"
+
+static const int kDefaultInterval = 16;    //ms, roughly one display frame
+
+void AnalyticsUpdateBatch::clear()
+{
+    startedCuratorLabels.clear();
+    unlockedNodes.clear();
+    curatorLabelLostness.clear();
+    curatorLabelProgress.clear();
+    objectiveLostness.clear();
+    gameValuesChanged = false;
+    localLostness = 0;
+    gameProgress = 0;
+    lostnessPoints.clear();
+    logLines.clear();
+    receivedAt = 0;
+}
+
+bool AnalyticsUpdateBatch::isEmpty() const
+{
+    return startedCuratorLabels.isEmpty() && unlockedNodes.isEmpty() && curatorLabelLostness.isEmpty() && curatorLabelProgress.isEmpty() &&
+            objectiveLostness.isEmpty() && !gameValuesChanged && lostnessPoints.isEmpty() && logLines.isEmpty();
+}
+
+AnalyticsUpdateCoalescer::AnalyticsUpdateCoalescer(QObject *parent)
+    : QObject(parent)
+    , m_timer(new QTimer(this))
+{
+    m_timer->setSingleShot(true);
+    m_timer->setInterval(kDefaultInterval);
+    connect(m_timer, &QTimer::timeout, this, &AnalyticsUpdateCoalescer::flush);
+}
+
+void AnalyticsUpdateCoalescer::addDelta(const AnalyticsDelta &delta, bool showGraph)
+{
+    m_pending.startedCuratorLabels += delta.startedCuratorLabels;
+    m_pending.unlockedNodes += delta.unlockedNodes;
+
+    //lostness below zero isn't shown, so it mustn't replace one that can be
+    for(QHash<QString, float>::const_iterator lostnessIt = delta.curatorLabelLostness.constBegin(); lostnessIt != delta.curatorLabelLostness.constEnd(); ++lostnessIt)
+        if(lostnessIt.value() >= 0 || !m_pending.curatorLabelLostness.contains(lostnessIt.key()))
+            m_pending.curatorLabelLostness.insert(lostnessIt.key(), lostnessIt.value());
+
+    for(QHash<QString, float>::const_iterator progressIt = delta.curatorLabelProgress.constBegin(); progressIt != delta.curatorLabelProgress.constEnd(); ++progressIt)
+        m_pending.curatorLabelProgress.insert(progressIt.key(), progressIt.value());
+
+    foreach (const ObjectiveLostnessUpdate &update, delta.objectiveLostness)
+        if(update.lostness >= 0 || !m_pending.objectiveLostness.contains(qMakePair(update.curatorLabel, update.objective)))
+            m_pending.objectiveLostness.insert(qMakePair(update.curatorLabel, update.objective), update.lostness);
+
+    if(delta.gameValuesChanged)
+    {
+        m_pending.gameValuesChanged = true;
+        m_pending.localLostness = delta.localLostness;
+        m_pending.gameProgress = delta.gameProgress;
+    }
+
+    if(showGraph)
+        m_pending.lostnessPoints += delta.lostnessPoints;
+
+    if(delta.receivedAt > 0 && (m_pending.receivedAt == 0 || delta.receivedAt < m_pending.receivedAt))
+        m_pending.receivedAt = delta.receivedAt;
+
+    scheduleFlush();
+}
+
+void AnalyticsUpdateCoalescer::addLogLine(const AnalyticsLogLine &line)
+{
+    m_pending.logLines.append(line);
+    scheduleFlush();
+}
+
+void AnalyticsUpdateCoalescer::discard(bool includeLog)
+{
+    QList<AnalyticsLogLine> logLines = m_pending.logLines;
+
+    m_pending.clear();
+
+    if(!includeLog)
+        m_pending.logLines = logLines;
+}
+
+void AnalyticsUpdateCoalescer::flush()
+{
+    m_timer->stop();
+
+    if(m_pending.isEmpty())
+        return;
+
+    //swapped out first so changes made while the batch is shown start a new one
+    AnalyticsUpdateBatch batch;
+    qSwap(batch, m_pending);
+
+    flushed(batch);
+}
+
+void AnalyticsUpdateCoalescer::scheduleFlush()
+{
+    if(!m_timer->isActive())
+        m_timer->start();
+}
@@ -0,0 +1,87 @@
+#ifndef ANALYTICSUPDATECOALESCER_H
+#define ANALYTICSUPDATECOALESCER_H
+
+#include <QObject>
+#include <QTimer>
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QHash>
+#include <QPair>
+#include <QVector>
+#include <QPointF>
+
+#include "analyticsdelta.h"
+
+///
+/// \brief Dashboard changes waiting to be shown, only the latest value of anything that is overwritten is kept
+///
+struct AnalyticsUpdateBatch
+{
+    AnalyticsUpdateBatch() {clear();}
+
+    void clear();
+    bool isEmpty() const;
+
+    QStringList startedCuratorLabels;
+    QStringList unlockedNodes;
+
+    QHash<QString, float> curatorLabelLostness;
+    QHash<QString, float> curatorLabelProgress;
+    QHash<QPair<QString, QString>, float> objectiveLostness;
+
+    bool gameValuesChanged;
+    float localLostness;
+    float gameProgress;
+
+    QVector<QPointF> lostnessPoints;
+
+    QList<AnalyticsLogLine> logLines;   //formatted by the log window when shown
+
+    qint64 receivedAt;  //oldest message in the batch, for the benchmark
+};
+
+///
+/// \brief Collects the changes from incoming deltas so the widgets are only updated once per interval.
+///
+/// Deltas can arrive from several ingest workers within one display frame. Instead of relaying out
+/// the analytics panel, graph and log for each of them, they are merged and handed over in a
+/// single batch when the timer fires.
+///
+class AnalyticsUpdateCoalescer : public QObject
+{
+    Q_OBJECT
+public:
+    explicit AnalyticsUpdateCoalescer(QObject *parent = 0);
+
+    ///
+    /// \brief Set the time between updates of the dashboard, 0 updates as soon as control returns to the event loop
+    ///
+    void setInterval(int msecs){m_timer->setInterval(qMax(msecs, 0));}
+    int getInterval() const {return m_timer->interval();}
+
+    void addDelta(const AnalyticsDelta &delta, bool showGraph);
+    void addLogLine(const AnalyticsLogLine &line);
+    void addLogLine(const QString &line) {addLogLine(AnalyticsLogLine(line));}
+
+    ///
+    /// \brief Drop changes that haven't been shown yet, used when the view is rebuilt
+    ///
+    void discard(bool includeLog);
+
+    ///
+    /// \brief Show pending changes now instead of waiting for the timer
+    ///
+    void flush();
+
+signals:
+    void flushed(const AnalyticsUpdateBatch &batch);
+
+private:
+    void scheduleFlush();
+
+    AnalyticsUpdateBatch m_pending;
+    QTimer *m_timer;
+};
+
+#endif // ANALYTICSUPDATECOALESCER_H
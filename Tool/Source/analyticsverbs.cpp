@@ -0,0 +1,112 @@
+#include "analyticsverbs.h"
+
+#include <QDebug>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+
+static const QString kName_Verbs = "verbs";
+static const QString kName_Verb = "verb";
+static const QString kName_Action = "action";
+
+//action names used in the verb file, in VerbAction order
+static const char *kActionNames[VERB_ACTION_COUNT] =
+{
+    "none",
+    "startTask",
+    "completeTask",
+    "locomotion",
+    "interaction",
+    "attempt",
+    "found"
+};
+
+const int AnalyticsVerbTable::kUnknownVerb;
+
+AnalyticsVerbTable::AnalyticsVerbTable()
+{
+    clear();
+
+    addVerb("started", VERB_ACTION_START_TASK);
+    addVerb("completed", VERB_ACTION_COMPLETE_TASK);
+    addVerb("jumped to", VERB_ACTION_LOCOMOTION);
+    addVerb("picked up", VERB_ACTION_INTERACTION);
+    addVerb("attempted", VERB_ACTION_ATTEMPT);
+    addVerb("found", VERB_ACTION_FOUND);
+}
+
+bool AnalyticsVerbTable::loadFromFile(QString fileName)
+{
+    QFile file(fileName);
+
+    if(!file.open(QIODevice::ReadOnly | QIODevice::Text))
+    {
+        qDebug() << "Verb file" << fileName << "not found, using default verbs";
+        return false;
+    }
+
+    QJsonDocument jsonDoc = QJsonDocument::fromJson(file.readAll());
+    file.close();
+
+    if(jsonDoc.isNull() || !jsonDoc.isObject() || !jsonDoc.object()[kName_Verbs].isArray())
+    {
+        qDebug() << "Verb file" << fileName << "is not in the correct format, using default verbs";
+        return false;
+    }
+
+    QHash<QString, VerbAction> actionsByName;
+    for(int i = 0; i < VERB_ACTION_COUNT; ++i)
+        actionsByName.insert(kActionNames[i], VerbAction(i));
+
+    clear();
+
+    foreach (QJsonValue jsonVal, jsonDoc.object()[kName_Verbs].toArray())
+    {
+        QJsonObject jsonObj = jsonVal.toObject();
+        QString verb = jsonObj[kName_Verb].toString();
+        QString action = jsonObj[kName_Action].toString();
+
+        if(verb.isEmpty() || !actionsByName.contains(action))
+        {
+            qDebug() << "Skipping verb" << verb << "with unknown action" << action;
+            continue;
+        }
+
+        addVerb(verb, actionsByName[action]);
+    }
+
+    return true;
+}
+
+QString AnalyticsVerbTable::getNameOfAction(VerbAction action) const
+{
+    int id = m_actions.indexOf(action, kUnknownVerb + 1);
+    return id == -1 ? QString() : m_names[id];
+}
+
+void AnalyticsVerbTable::clear()
+{
+    m_ids.clear();
+    m_utf8Ids.clear();
+    m_actions.clear();
+    m_names.clear();
+
+    //id 0 is kept for verbs that aren't in the table
+    m_actions.append(VERB_ACTION_NONE);
+    m_names.append(QString());
+}
+
+void AnalyticsVerbTable::addVerb(QString verb, VerbAction action)
+{
+    if(m_ids.contains(verb))
+    {
+        m_actions[m_ids[verb]] = action;
+        return;
+    }
+
+    m_ids.insert(verb, m_actions.size());
+    m_utf8Ids.insert(verb.toUtf8(), m_actions.size());
+    m_actions.append(action);
+    m_names.append(verb);
+}
@@ -0,0 +1,77 @@
+#ifndef ANALYTICSVERBS_H
+#define ANALYTICSVERBS_H
+
+#include <QString>
+#include <QStringList>
+#include <QHash>
+#include <QByteArray>
+#include <QVector>
+
+///
+/// \brief What the analytics session does with an event, each action has one handler
+///
+enum VerbAction
+{
+    VERB_ACTION_NONE,           //only logged
+    VERB_ACTION_START_TASK,
+    VERB_ACTION_COMPLETE_TASK,
+    VERB_ACTION_LOCOMOTION,     //counts towards lostness and moves the player
+    VERB_ACTION_INTERACTION,    //counts towards lostness
+    VERB_ACTION_ATTEMPT,        //may unlock a node
+    VERB_ACTION_FOUND,          //objective of a curator label found
+    VERB_ACTION_COUNT
+};
+
+///
+/// \brief Interns the xAPI verbs sent by the game into small ids, each mapped to a VerbAction.
+///
+/// Lets events be routed with a single hash lookup instead of comparing the verb string against
+/// every known verb. The mapping can be read from a file so new game verbs only need a new entry.
+///
+class AnalyticsVerbTable
+{
+public:
+    static const int kUnknownVerb = 0;
+
+    ///
+    /// \brief Constructor, sets up the verbs used by the games shipped with the tool
+    ///
+    AnalyticsVerbTable();
+
+    ///
+    /// \brief Replace the mapping with the one in the file, returns false and keeps the current one on failure
+    ///
+    bool loadFromFile(QString fileName);
+
+    ///
+    /// \brief Get the id of a verb, kUnknownVerb if it is not in the table
+    ///
+    int getId(const QString &verb) const {return m_ids.value(verb, kUnknownVerb);}
+
+    ///
+    /// \brief Get the id of a UTF-8 verb straight from a message buffer, without decoding it
+    ///
+    int getId(const char *verb, int length) const {return m_utf8Ids.value(QByteArray::fromRawData(verb, length), kUnknownVerb);}
+
+    VerbAction getAction(int id) const {return m_actions[id];}
+    VerbAction getAction(const QString &verb) const {return m_actions[getId(verb)];}
+
+    QString getName(int id) const {return m_names[id];}
+    int getNumVerbs() const {return m_names.size();}    //including kUnknownVerb
+
+    ///
+    /// \brief First verb mapped to the action, used when the tool writes events of its own
+    ///
+    QString getNameOfAction(VerbAction action) const;
+
+private:
+    void clear();
+    void addVerb(QString verb, VerbAction action);
+
+    QHash<QString, int> m_ids;
+    QHash<QByteArray, int> m_utf8Ids;
+    QVector<VerbAction> m_actions;  //indexed by verb id
+    QStringList m_names;
+};
+
+#endif // ANALYTICSVERBS_H
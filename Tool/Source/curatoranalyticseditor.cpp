@@ -4,6 +4,7 @@ CuratorAnalyticsEditor::CuratorAnalyticsEditor(QWidget *parent)
 : m_mainLayout(new QGridLayout),
   m_saveCuratorBtn(nullptr),
   m_loadCuratorBtn(nullptr),
+  m_lostnessHandler(new Lostness),
   m_useTool(nullptr),
   QDialog(parent)
 {
@@ -128,99 +129,33 @@ void CuratorAnalyticsEditor::loadCuratorLabels()
 
             m_jsonArray = jsonDoc.array();
 
-            for(QJsonArray::iterator mainArrayIt = m_jsonArray.begin(); mainArrayIt != m_jsonArray.end(); ++mainArrayIt)
+            foreach (const CuratorLabelDefinition &definition, readCuratorLabels(m_jsonArray))
             {
-                if((*mainArrayIt).isObject())
-                {
-                    CuratorLabel *curatorLabel = new CuratorLabel;
-                    curatorLabel->startDependencyLabel = new QLabel("Start Objective:");
-                    curatorLabel->dependenciesLabel = new QLabel("Objectives:");
-                    curatorLabel->minStepsLabel = new QLabel("Minimum Steps:");
-                    curatorLabel->totalNumOfNodesVisited = 0;
-
-                    curatorLabel->lostness = -1;
-                    curatorLabel->progress = 0;
-
-                    QJsonObject mainObj = (*mainArrayIt).toObject();
-
-                    if(mainObj.contains("narrative_deps") && mainObj["narrative_deps"].isArray())
-                    {
-                        QJsonArray depArray = mainObj["narrative_deps"].toArray();
-
-                        for(QJsonArray::iterator depArrayIt = depArray.begin(); depArrayIt != depArray.end(); ++depArrayIt)
-                        {                            
-                            if(mainObj.contains("text_id") && mainObj["text_id"].isString())
-                            {
-                                curatorLabel->id = new QLabel(mainObj["text_id"].toString());
-                                curatorLabel->id->setStyleSheet("font-weight: bold;");
-                                //qDebug() << mainObj["text_id"].toString();
-                            }
-
-                            if(mainObj.contains("begin_dep") && mainObj["begin_dep"].isString())
-                            {
-                                CuratorObjective *newObj = new CuratorObjective(mainObj["begin_dep"].toString());
-                                curatorLabel->startDependency = newObj;
-                                //curatorLabel->narrativeDependenciesHash.insert(mainObj["begin_dep"].toString(), newObj);
-                                //curatorLabel->narrativeDependenciesList.append(newObj);
-                                //qDebug() << mainObj["begin_dep"].toString();
-                            }
-
-                            if((*mainArrayIt).isObject())
-                            {
-                                QJsonObject depObj = (*depArrayIt).toObject();
-
-                                if(depObj.contains("narr_id") && depObj["narr_id"].isString())
-                                {
-                                    CuratorObjective *newObj = new CuratorObjective(depObj["narr_id"].toString());
-                                    curatorLabel->narrativeDependenciesHash.insert(depObj["narr_id"].toString(), newObj);
-                                    curatorLabel->narrativeDependenciesList.append(newObj);
-                                    //qDebug() << depObj["narr_id"].toString();
-                                }
-                            }
-                        }
-
-                        /*if(depObj.contains("subtitle") && depObj["subtitle"].isString())
-                            qDebug() << depObj["subtitle"].toString();
+                CuratorLabel *curatorLabel = new CuratorLabel;
+                curatorLabel->startDependencyLabel = new QLabel("Start Objective:");
+                curatorLabel->dependenciesLabel = new QLabel("Objectives:");
+                curatorLabel->minStepsLabel = new QLabel("Minimum Steps:");
 
-                        if(depObj.contains("screen_id") && depObj["screen_id"].isString())
-                            qDebug() << depObj["screen_id"].toString();
+                curatorLabel->id = new QLabel(definition.id);
+                curatorLabel->id->setStyleSheet("font-weight: bold;");
 
-                        if(depObj.contains("element_from") && depObj["element_from"].isString())
-                            qDebug() << depObj["element_from"].toString();
-
-                        if(depObj.contains("element_to") && depObj["element_to"].isString())
-                            qDebug() << depObj["element_to"].toString();
-
-                        if(mainObj.contains("screen_id") && mainObj["screen_id"].isString())
-                            qDebug() << mainObj["screen_id"].toString();
-
-                        if(mainObj.contains("element_id") && mainObj["element_id"].isString())
-                            qDebug() << mainObj["element_id"].toString();
-
-                        if(mainObj.contains("subtitle") && mainObj["subtitle"].isString())
-                            qDebug() << mainObj["subtitle"].toString();
-
-                        if(mainObj.contains("target_alpha") && mainObj["target_alpha"].isString())
-                            qDebug() << mainObj["target_alpha"].toString();
-
-                        if(mainObj.contains("complete_dep") && mainObj["complete_dep"].isString())
-                            qDebug() << mainObj["complete_dep"].toString();
-
-                        if(mainObj.contains("on_progress_completed") && mainObj["on_progress_completed"].isString())
-                            qDebug() << mainObj["on_progress_completed"].toString();*/
+                curatorLabel->startDependency = new CuratorObjective(definition.startObjective);
 
+                foreach (const QString &objectiveId, definition.objectives)
+                {
+                    CuratorObjective *newObj = new CuratorObjective(objectiveId);
+                    curatorLabel->narrativeDependenciesHash.insert(objectiveId, newObj);
+                    curatorLabel->narrativeDependenciesList.append(newObj);
+                }
 
-                        curatorLabel->minSteps = new QSpinBox();
+                curatorLabel->minSteps = new QSpinBox();
+                curatorLabel->minSteps->setValue(definition.minSteps);
 
-                        if(mainObj.contains("min_steps"))
-                                curatorLabel->minSteps->setValue(mainObj["min_steps"].toDouble());
-                    }
-                    m_curatorLabelsHash.insert(mainObj["text_id"].toString(), curatorLabel);
-                    m_curatorLabelsList.append(curatorLabel);
+                m_curatorLabelsHash.insert(definition.id, curatorLabel);
+                m_curatorLabelsList.append(curatorLabel);
 
-                    curatorLabel->minStepsLabel->setVisible(m_useGlobalLostness->isChecked());
-                    curatorLabel->minSteps->setVisible(m_useGlobalLostness->isChecked());
-                }
+                curatorLabel->minStepsLabel->setVisible(m_useGlobalLostness->isChecked());
+                curatorLabel->minSteps->setVisible(m_useGlobalLostness->isChecked());
             }
 
             showCuratorLabels();
@@ -238,6 +173,59 @@ void CuratorAnalyticsEditor::loadCuratorLabels()
     }
 }
 
+QList<CuratorLabelDefinition> CuratorAnalyticsEditor::readCuratorLabels(const QJsonArray &jsonArray)
+{
+    QList<CuratorLabelDefinition> curatorLabels;
+
+    foreach (const QJsonValue &value, jsonArray)
+    {
+        QJsonObject mainObj = value.toObject();
+
+        //a task without objectives has nothing to score
+        if(!value.isObject() || !mainObj.contains("narrative_deps") || !mainObj["narrative_deps"].isArray())
+            continue;
+
+        CuratorLabelDefinition definition;
+        definition.id = mainObj["text_id"].toString();
+        definition.startObjective = mainObj["begin_dep"].toString();
+        definition.minSteps = int(mainObj["min_steps"].toDouble());
+
+        foreach (const QJsonValue &dependency, mainObj["narrative_deps"].toArray())
+        {
+            QJsonObject depObj = dependency.toObject();
+
+            if(depObj.contains("narr_id") && depObj["narr_id"].isString())
+                definition.objectives.append(depObj["narr_id"].toString());
+        }
+
+        curatorLabels.append(definition);
+    }
+
+    return curatorLabels;
+}
+
+bool CuratorAnalyticsEditor::readCuratorLabels(const QString &fileName, QList<CuratorLabelDefinition> &curatorLabels, QString &error)
+{
+    QFile file(fileName);
+
+    if(!file.open(QIODevice::ReadOnly | QIODevice::Text))
+    {
+        error = "File could not be loaded. Ensure that you have the correct permissions";
+        return false;
+    }
+
+    QJsonDocument jsonDoc = QJsonDocument::fromJson(file.readAll());
+
+    if(jsonDoc.isNull() || !jsonDoc.isArray() || jsonDoc.isEmpty())
+    {
+        error = "File could not be loaded, please ensure that it is the correct format.";
+        return false;
+    }
+
+    curatorLabels = readCuratorLabels(jsonDoc.array());
+    return true;
+}
+
 void CuratorAnalyticsEditor::saveCuratorLabels()
 {
     QFile file(QFileDialog::getSaveFileName(this,
@@ -326,161 +314,36 @@ void CuratorAnalyticsEditor::hideCuratorLabels()
 
 void CuratorAnalyticsEditor::loadSpatialGraph()
 {
-    if(m_lostnessHandler.loadEdges())
+    //loaded aside, sessions get the new graph when the editor is closed and they are configured again
+    QSharedPointer<Lostness> lostnessHandler(new Lostness(m_lostnessHandler->getGraph()));
+
+    if(lostnessHandler->loadEdges())
     {
-        m_loadedLabel->setText(QString::number(m_lostnessHandler.getNumEdges()) + " edges loaded");
+        m_lostnessHandler = lostnessHandler;
+        m_loadedLabel->setText(QString::number(m_lostnessHandler->getNumEdges()) + " edges loaded");
         m_startNodeInput->setEnabled(true);
     }
 }
 
-void CuratorAnalyticsEditor::updatePath(QString object, QString verb)
+AnalyticsSessionConfig CuratorAnalyticsEditor::getSessionConfig()
 {
-    bool found = false;
-    for(QList<QPair<QString, QString>>::iterator visitedIt = m_uniqueNodes.begin(); visitedIt != m_uniqueNodes.end(); ++visitedIt)
-    {
-        if((*visitedIt).first == object && (*visitedIt).second == verb)
-        {
-            found = true;
-            break;
-        }
-    }
-
-    if(!found)
-        m_uniqueNodes.push_back(qMakePair(object, verb));
-
-    ++m_totalNodes;
-
-    m_endNode = object;
-
-    if(verb == "jumped to")
-        m_lastLocomotionNode = object;
-}
+    AnalyticsSessionConfig config;
+    config.lostnessHandler = m_lostnessHandler;
 
-void CuratorAnalyticsEditor::nodeVisited(QString id, QString object, QString verb)
-{
-    Q_ASSERT(m_curatorLabelsHash.contains(id));
-
-    bool found = false;
-    for(QList<QPair<QString, QString>>::iterator visitedIt = m_curatorLabelsHash[id]->uniqueNodesVisited.begin(); visitedIt != m_curatorLabelsHash[id]->uniqueNodesVisited.end(); ++visitedIt)
+    foreach (CuratorLabel* curatorLabel, m_curatorLabelsList)
     {
-        if((*visitedIt).first == object && (*visitedIt).second == verb)
-        {
-            found = true;
-            break;
-        }
-    }
+        CuratorLabelDefinition definition;
+        definition.id = curatorLabel->id->text();
+        definition.startObjective = curatorLabel->startDependency->label->text();
+        definition.minSteps = curatorLabel->minSteps->value();
 
-    if(!found)
-        m_curatorLabelsHash[id]->uniqueNodesVisited.push_back(qMakePair(object, verb));
-
-    ++m_curatorLabelsHash[id]->totalNumOfNodesVisited;
-
-}
-
-float CuratorAnalyticsEditor::getLostnessofCuratorLabel(QString id)
-{
-    Q_ASSERT(m_curatorLabelsHash.contains(id));
-
-    CuratorLabel* curatorLabel = m_curatorLabelsHash[id];
-
-    //if lostness already set then return it. Otherwise, calculate, save and return
-    if(curatorLabel->lostness != -1)
-        return curatorLabel->lostness;
-
-    qDebug() << "Calculating lostness for Curator Label: " << id;
-
-    float lostness = m_lostnessHandler.getLostnessValue(curatorLabel->minSteps->value(), curatorLabel->totalNumOfNodesVisited, curatorLabel->uniqueNodesVisited.size());
-
-    //qDebug() << "Lostness: " << lostness;
-
-    curatorLabel->lostness = lostness;
-    return lostness;
-}
-
-float CuratorAnalyticsEditor::getLostnessofCuratorLabelFromObjectives(QString id)
-{
-    Q_ASSERT(m_curatorLabelsHash.contains(id));
-
-    CuratorLabel* curatorLabel = m_curatorLabelsHash[id];
-    qDebug() << "Calculating lostness for Curator Label: " << id;
-
-    int sumR(0), sumS(0), sumN(0);
-    QString startNode = m_curatorLabelsHash[id]->startDependency->startNode;
-    QString endNode = m_endNode;
+        foreach (CuratorObjective *dependency, curatorLabel->narrativeDependenciesList)
+            definition.objectives.append(dependency->label->text());
 
-    foreach (CuratorObjective *obj, curatorLabel->narrativeDependenciesList)
-    {
-        if(obj->found) //if this isn't true, we have a problem
-        {
-            sumR += obj->minSteps;
-            sumS += obj->totalNumOfNodesVisited;
-            sumN += obj->totalNumUniqueNodesVisited;
-        }
+        config.curatorLabels.append(definition);
     }
 
-    curatorLabel->totalNumOfNodesVisited = sumS;
-    curatorLabel->totalNumUniqueNodesVisited = sumN;
-    curatorLabel->startNode = startNode;
-    curatorLabel->endNode = endNode;
-
-    float lostness = m_lostnessHandler.getLostnessValue(sumR, sumS, sumN);
-
-    //qDebug() << "Lostness: " << lostness;
-
-    curatorLabel->lostness = lostness;
-    return lostness;
-}
-
-float CuratorAnalyticsEditor::getLostnessofObjective(QString curatorId, QString objectiveId)
-{
-    Q_ASSERT(m_curatorLabelsHash.contains(curatorId));
-    Q_ASSERT(m_curatorLabelsHash[curatorId]->narrativeDependenciesHash.contains(objectiveId) || m_curatorLabelsHash[curatorId]->startDependency->label->text() == objectiveId);
-
-    CuratorObjective *objective;
-
-    if(m_curatorLabelsHash[curatorId]->narrativeDependenciesHash.contains(objectiveId))
-        objective = m_curatorLabelsHash[curatorId]->narrativeDependenciesHash[objectiveId];
-    else
-        objective = m_curatorLabelsHash[curatorId]->startDependency;
-
-    if(objective->lostness != -1)
-        return objective->lostness;
-
-    qDebug() << "Calculating lostness for Objective: " << objectiveId << " from Curator Label: " << curatorId;
-
-    float lostness = m_lostnessHandler.getLostnessForObjective(objective->startNode, objective->endNode, objective->totalNumOfNodesVisited, objective->totalNumUniqueNodesVisited, objective->minSteps);
-
-    //qDebug() << "Lostness: " << lostness;
-
-    objective->lostness = lostness;
-    return lostness;
-}
-
-float CuratorAnalyticsEditor::getLostnessofObjective(QString curatorId, QString objectiveId, int &r, int &s, int &n, QString &startNode, QString &endNode)
-{
-    Q_ASSERT(m_curatorLabelsHash.contains(curatorId));
-    Q_ASSERT(m_curatorLabelsHash[curatorId]->narrativeDependenciesHash.contains(objectiveId) || m_curatorLabelsHash[curatorId]->startDependency->label->text() == objectiveId);
-
-    CuratorObjective *objective;
-
-    if(m_curatorLabelsHash[curatorId]->narrativeDependenciesHash.contains(objectiveId))
-        objective = m_curatorLabelsHash[curatorId]->narrativeDependenciesHash[objectiveId];
-    else
-        objective = m_curatorLabelsHash[curatorId]->startDependency;
-
-    float lostness;
-    if(objective->lostness != -1)
-        lostness =  objective->lostness;
-    else
-        lostness = getLostnessofObjective(curatorId, objectiveId);
-
-    r = objective->minSteps;
-    s = objective->totalNumOfNodesVisited;
-    n = objective->totalNumUniqueNodesVisited;
-    startNode = objective->startNode;
-    endNode = objective->endNode;
-
-    return lostness;
+    return config;
 }
 
 bool CuratorAnalyticsEditor::checkIfAnalyticsLoaded()
@@ -488,7 +351,7 @@ bool CuratorAnalyticsEditor::checkIfAnalyticsLoaded()
     bool showAlert(false);
     QString title(""), message("");
 
-    if(m_curatorLabelsList.empty() && m_lostnessHandler.getNumEdges() == 0)
+    if(m_curatorLabelsList.empty() && m_lostnessHandler->getNumEdges() == 0)
     {
         showAlert = true;
         title = "No Curator Labels or Spatial Graph Loaded";
@@ -502,7 +365,7 @@ bool CuratorAnalyticsEditor::checkIfAnalyticsLoaded()
             message = "Do you want to load the curator labels (in-game tasks) before starting analytics?\n\n(Needed for task analysis)";
         }
     else
-        if(m_lostnessHandler.getNumEdges() == 0)
+        if(m_lostnessHandler->getNumEdges() == 0)
         {
             showAlert = true;
             title = "No Spatial Graph Loaded";
@@ -540,194 +403,3 @@ bool CuratorAnalyticsEditor::checkIfAnalyticsLoaded()
     else
         return true;
 }
-
-void CuratorAnalyticsEditor::resetAll()
-{
-    foreach (CuratorLabel* curatorLabel, m_curatorLabelsList)
-    {
-        //reset lostness
-        curatorLabel->uniqueNodesVisited.clear();
-        curatorLabel->totalNumOfNodesVisited = 0;
-        curatorLabel->lostness = -1;
-
-        //and progress
-        curatorLabel->progress = 0;
-
-        //starting node
-        curatorLabel->startDependency->minSteps = 0;
-        curatorLabel->startDependency->totalNumOfNodesVisited = 0;
-        curatorLabel->startDependency->totalNumUniqueNodesVisited = 0;
-        curatorLabel->startDependency->lostness = -1;
-        curatorLabel->startDependency->startNode = "";
-        curatorLabel->startDependency->endNode = "";
-        curatorLabel->startDependency->found = false;
-
-        //and other dependencies (duplicate code I know)
-        foreach (CuratorObjective *dependency, curatorLabel->narrativeDependenciesList)
-        {
-            dependency->minSteps = 0;
-            dependency->totalNumOfNodesVisited = 0;
-            dependency->totalNumUniqueNodesVisited = 0;
-            dependency->lostness = -1;
-            dependency->startNode = "";
-            dependency->endNode = "";
-            dependency->found = false;
-        }
-    }
-
-    m_gameProgress = 0;
-    m_localLostness = 0;
-}
-
-void CuratorAnalyticsEditor::updateGameProgress()
-{
-    m_gameProgress = 0;
-
-    foreach (CuratorLabel *curatorLabel, m_curatorLabelsList) //Loop through, get value and average. May be better to do the objectives. Check later
-    {
-        m_gameProgress += curatorLabel->progress;
-    }
-
-    m_gameProgress /= m_curatorLabelsList.size();
-}
-
-//This can be highly optimised
-void CuratorAnalyticsEditor::objectiveFound(QString objectiveId, QString curatorId, int r, int s, int n, float lostness, QString startNode, QString endNode)
-{
-    Q_ASSERT(m_curatorLabelsHash.contains(curatorId));
-    Q_ASSERT(m_curatorLabelsHash[curatorId]->narrativeDependenciesHash.contains(objectiveId) || m_curatorLabelsHash[curatorId]->startDependency->label->text() == objectiveId);
-
-    qDebug() << "obj: " << objectiveId << "cur: " << curatorId << "r: " << r << "s: " << s << "n: " << n << "lostness" << lostness;
-    qDebug() << "start: " << startNode << "end: " << endNode;
-
-    CuratorObjective *objective;
-
-    if(m_curatorLabelsHash[curatorId]->narrativeDependenciesHash.contains(objectiveId))
-        objective = m_curatorLabelsHash[curatorId]->narrativeDependenciesHash[objectiveId];
-    else
-        objective = m_curatorLabelsHash[curatorId]->startDependency;
-
-    //set objective to found and add all lostness data
-    objective->found = true;
-    objective->minSteps = r;
-    objective->totalNumOfNodesVisited = s;
-    objective->totalNumUniqueNodesVisited = n;
-    objective->lostness = lostness;
-    objective->startNode = startNode;
-    objective->endNode = endNode;
-
-    //update progress for curator label and full game
-    m_curatorLabelsHash[curatorId]->progress = 0;
-    foreach (CuratorObjective *obj, m_curatorLabelsHash[curatorId]->narrativeDependenciesList)
-    {
-        if(obj->found)
-            ++m_curatorLabelsHash[curatorId]->progress;
-    }
-
-    m_curatorLabelsHash[curatorId]->progress /= m_curatorLabelsHash[curatorId]->narrativeDependenciesList.size();
-    updateGameProgress();
-    updateLocalLostness();
-}
-
-bool CuratorAnalyticsEditor::possibleObjectiveFound(QString objectiveId)
-{
-    CuratorObjective* objective = nullptr;
-
-    CuratorLabel* objOwner;
-
-    foreach (CuratorLabel* task, m_curatorLabelsHash)
-    {
-        if(task->narrativeDependenciesHash.contains(objectiveId))
-        {
-            objective = task->narrativeDependenciesHash[objectiveId];
-            objOwner = task;
-            break;
-        }
-        else
-            if(task->startDependency->label->text() == objectiveId)
-            {
-                objective = task->startDependency;
-                objOwner = task;
-                break;
-            }
-    }
-
-    if(objective == nullptr)
-        return false; //not found
-
-    //save the information needed for lostness to the objective
-    objective->found = true;
-    objective->startNode = m_firstNode;
-    objective->endNode = m_endNode;
-    objective->totalNumOfNodesVisited = m_totalNodes;
-    objective->totalNumUniqueNodesVisited = m_uniqueNodes.size();
-
-    //calculate lostness
-    getLostnessofObjective(objOwner->id->text(), objective->label->text());
-
-    //reset everything for next objective
-    m_firstNode = m_lastLocomotionNode;
-    //m_endNode = "";
-    //m_lastLocomotionNode = "";
-
-    m_totalNodes = 0;
-    m_uniqueNodes.clear();
-
-    //update progress for curator label and full game
-        objOwner->progress = 0;
-        foreach (CuratorObjective *obj, objOwner->narrativeDependenciesList)
-        {
-            if(obj->found)
-                ++objOwner->progress;
-        }
-
-        objOwner->progress /= objOwner->narrativeDependenciesList.size();
-        updateGameProgress();
-        updateLocalLostness();
-
-    return true;
-}
-
-void CuratorAnalyticsEditor::updateLocalLostness()
-{
-    int sumR(0), sumS(0), sumN(0);
-    foreach (CuratorLabel *curatorLabel, m_curatorLabelsList) //Find all completed objectives, sum up lostness data and get full lostness
-    {
-        qDebug() << curatorLabel->id->text();
-        if(curatorLabel->startDependency->found)
-        {
-            sumR += curatorLabel->startDependency->minSteps;
-            sumS += curatorLabel->startDependency->totalNumOfNodesVisited;
-            sumN += curatorLabel->startDependency->totalNumUniqueNodesVisited;
-
-            foreach (CuratorObjective *obj, curatorLabel->narrativeDependenciesList)
-            {
-                if(obj->found)
-                {
-                    sumR += obj->minSteps;
-                    sumS += obj->totalNumOfNodesVisited;
-                    sumN += obj->totalNumUniqueNodesVisited;
-                }
-            }
-        }
-    }
-
-    m_localLostness = m_lostnessHandler.getLostnessValue(sumR, sumS, sumN);
-}
-
-float CuratorAnalyticsEditor::getCuratorLabelProgress(QString curatorId)
-{
-    return m_curatorLabelsHash[curatorId]->progress;
-}
-
-QString CuratorAnalyticsEditor::getParentId(QString objectiveId)
-{
-    foreach (CuratorLabel* task, m_curatorLabelsHash)
-    {
-        if(task->narrativeDependenciesHash.contains(objectiveId) || task->startDependency->label->text() == objectiveId)
-        {
-            return task->id->text();
-        }
-    }
-    return "";  //error
-}
@@ -18,23 +18,16 @@
 #include <QRadioButton>>
 
 #include "lostness.h"
+#include "analyticssession.h"
 
 struct CuratorObjective
 {
     CuratorObjective(QString objectiveName)
     {
         label = new QLabel(objectiveName);
-        found = false;
     }
 
-    int minSteps;
-    int totalNumOfNodesVisited;
-    int totalNumUniqueNodesVisited;
-    float lostness;
-    QString startNode;
-    QString endNode;
     QLabel* label;
-    bool found;
 };
 
 struct CuratorLabel
@@ -59,16 +52,6 @@ struct CuratorLabel
     CuratorObjective* startDependency;
     QLabel* minStepsLabel;
     QSpinBox* minSteps;
-
-    QList<QPair<QString, QString>> uniqueNodesVisited;
-    int totalNumOfNodesVisited;
-    int totalNumUniqueNodesVisited;
-
-    QString startNode;
-    QString endNode;
-
-    float progress;
-    float lostness;
 };
 
 class CuratorAnalyticsEditor : public QDialog
@@ -78,39 +61,26 @@ public:
     void loadCuratorLabels();
     void saveCuratorLabels();
     void showWindow();
-    void updatePath(QString object, QString verb);
-    void nodeVisited(QString task, QString object, QString verb);
-    float getLostnessofCuratorLabel(QString id);
-    float getLostnessofCuratorLabelFromObjectives(QString id);
     bool checkIfAnalyticsLoaded();
     QList<CuratorLabel*> getCuratorLabels(){return m_curatorLabelsList;}
-    void resetAll();
-
-    void updateGameProgress();
-    float getGameProgress(){return m_gameProgress;}
-
-    float getCuratorLabelProgress(QString curatorId);
-
-    void objectiveFound(QString objectiveId, QString curatorId, int r, int s, int n, float lostness, QString startNode, QString endNode);
-    bool possibleObjectiveFound(QString objectiveId);
 
-    float getLostnessofObjective(QString curatorId, QString objectiveId);
-    float getLostnessofObjective(QString curatorId, QString objectiveId, int &r, int &s, int &n, QString &startNode, QString &endNode);
-
-    void updateLocalLostness();
-
-    float getLocalLostness(){return m_localLostness;}
+    ///
+    /// \brief Copy of the loaded tasks that an AnalyticsSession can be built from, off the GUI thread
+    ///
+    AnalyticsSessionConfig getSessionConfig();
 
     bool isEmpty(){return m_curatorLabelsList.empty();}
 
-    bool getUseLostnessInTool() { if(m_useTool) return m_useTool->isChecked(); else return false;}
+    ///
+    /// \brief Curator labels of a tasks file, as the editor loads them but without any widgets
+    ///
+    static QList<CuratorLabelDefinition> readCuratorLabels(const QJsonArray &jsonArray);
+    static bool readCuratorLabels(const QString &fileName, QList<CuratorLabelDefinition> &curatorLabels, QString &error);
 
-    QString getParentId(QString objectiveId);
+    bool getUseLostnessInTool() { if(m_useTool) return m_useTool->isChecked(); else return false;}
 
     QString getSpecifiedStartNode(){return m_startNodeInput->text();}
 
-    void setFirstNodeToStartNode(){m_firstNode = m_startNodeInput->text();}
-
 private slots:
     void onLocalSelected(bool checked);
     void onGlobalSelected(bool checked);
@@ -133,10 +103,7 @@ private:
 
     QJsonArray m_jsonArray;
 
-    float m_gameProgress;
-    float m_localLostness;
-
-    Lostness m_lostnessHandler;
+    QSharedPointer<Lostness> m_lostnessHandler;  //swapped for a new one on load, sessions may still be reading the last
 
     QCheckBox *m_useTool;
 
@@ -144,11 +111,6 @@ private:
     QLabel* m_startNodeLabel;
     QLineEdit *m_startNodeInput;
 
-    QString m_firstNode;
-    QString m_endNode;
-    QString m_lastLocomotionNode;
-    int m_totalNodes;
-    QList<QPair<QString, QString>> m_uniqueNodes;
     QRadioButton *m_useLocalLostness;
     QRadioButton *m_useGlobalLostness;
     QRadioButton *m_useNoLostness;
@@ -1,7 +1,40 @@
 #include "lostness.h"
 #include <QMessageBox>
+#include <QStandardPaths>
+
+static const int kMaxStepCost = 100;
+
+//type names used in the nodes file and the costs of the spatial graph file
+static bool typeOfName(const QString &name, SpatialNodeType &type)
+{
+    if(name == "locomotion")
+        type = TYPE_LOCO;
+    else
+        if(name == "trigger")
+            type = TYPE_TRIGGER;
+        else
+            if(name == "artifact")
+                type = TYPE_ARTIFACT;
+            else
+                if(name == "logic")
+                    type = TYPE_LOGIC;
+                else
+                    return false;
+
+    return true;
+}
 
 Lostness::Lostness()
+    : m_cacheDirectory(QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/spatial graphs")
+    , m_distancesRevision(-1)
+{
+
+}
+
+Lostness::Lostness(const SpatialGraph &graph)
+    : m_graph(graph)
+    , m_cacheDirectory(QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/spatial graphs")
+    , m_distancesRevision(-1)
 {
 
 }
@@ -36,106 +69,120 @@ float Lostness::getLostnessValue(int minSteps, int totalSteps, int uniqueSteps)
 
 bool Lostness::loadEdges()
 {
-    QFile file(QFileDialog::getOpenFileName(this,
-                                                     QObject::tr("Load Edges"), "",
-                                                     QObject::tr("JSON File (*.json);;All Files (*)")));
+    QString fileName = QFileDialog::getOpenFileName(0,
+                                                    QObject::tr("Load Edges"), "",
+                                                    QObject::tr("JSON File (*.json);;All Files (*)"));
 
-    if(!file.fileName().isEmpty() && !file.fileName().isNull())
+    if(fileName.isEmpty())
+        return false;
+
+    QString error;
+
+    if(!loadEdges(fileName, error))
     {
-        if(file.open(QIODevice::ReadOnly | QIODevice::Text))
-        {
-            QString settings = file.readAll();
-            file.close();
+        QMessageBox messageBox;
+        messageBox.critical(0,"Error",error);
+        messageBox.setFixedSize(500,200);
+        return false;
+    }
 
-            QJsonDocument jsonDoc = QJsonDocument::fromJson(settings.toUtf8());
+    return true;
+}
 
-            if(jsonDoc.isNull() || !jsonDoc.isObject() || jsonDoc.isEmpty())
-            {
-                QMessageBox messageBox;
-                messageBox.critical(0,"Error","File could not be loaded, please ensure that it is the correct format.");
-                messageBox.setFixedSize(500,200);
-                return false;
-            }
+bool Lostness::loadEdges(const QString &fileName, QString &error)
+{
+    bool loaded = readEdges(fileName, error);
+    updateDistances();
 
-            QJsonObject jsonObj = jsonDoc.object();
+    return loaded;
+}
 
-            if(!jsonObj.contains("edges"))
-            {
-                QMessageBox messageBox;
-                messageBox.critical(0,"Error","Edges not found in file, please ensure that it is the correct format.");
-                messageBox.setFixedSize(500,200);
-                return false;
-            }
+bool Lostness::readEdges(const QString &fileName, QString &error)
+{
+    QFile file(fileName);
 
-            QJsonArray jsonEdgesArray = jsonObj["edges"].toArray();
+    if(!file.open(QIODevice::ReadOnly | QIODevice::Text))
+    {
+        error = "File could not be loaded. Ensure that you have the correct permissions";
+        m_graph.clearEdges();
+        return false;
+    }
 
-            foreach (const QJsonValue &v, jsonEdgesArray)
-            {
-                if(!v.isObject())
-                {
-                    QMessageBox messageBox;
-                    messageBox.critical(0,"Error","Error loading edge, please ensure that it is the correct format.");
-                    messageBox.setFixedSize(500,200);
-                    m_edges.clear();
-                    return false;
-                }
+    QString settings = file.readAll();
+    file.close();
 
-                QJsonObject jsonEdgeObject = v.toObject();
+    QJsonDocument jsonDoc = QJsonDocument::fromJson(settings.toUtf8());
 
-                if(!jsonEdgeObject.contains("links") || !jsonEdgeObject["links"].isArray() || (jsonEdgeObject["links"].isArray() && jsonEdgeObject["links"].toArray().count() != 2))
-                {
-                    QMessageBox messageBox;
-                    messageBox.critical(0,"Error","Error loading edge, please ensure that it is the correct format.");
-                    messageBox.setFixedSize(500,200);
-                    m_edges.clear();
-                    return false;
-                }
+    if(jsonDoc.isNull() || !jsonDoc.isObject() || jsonDoc.isEmpty())
+    {
+        error = "File could not be loaded, please ensure that it is the correct format.";
+        return false;
+    }
 
-                QJsonArray jsonLinksArray = jsonEdgeObject["links"].toArray();
+    QJsonObject jsonObj = jsonDoc.object();
 
-                if(!jsonLinksArray[0].isString() || !jsonLinksArray[0].isString())
-                {
-                    QMessageBox messageBox;
-                    messageBox.critical(0,"Error","Error loading edge, please ensure that it is the correct format.");
-                    messageBox.setFixedSize(500,200);
-                    m_edges.clear();
-                    return false;
-                }
+    if(!jsonObj.contains("edges"))
+    {
+        error = "Edges not found in file, please ensure that it is the correct format.";
+        return false;
+    }
 
-                //QString first =  jsonLinksArray[0].toString();
-                //QString second = jsonLinksArray[1].toString();
-                addEdge(jsonLinksArray[0].toString(), jsonLinksArray[1].toString());
-            }
-            return true;
+    if(jsonObj.contains("costs") && (!jsonObj["costs"].isObject() || !readCosts(jsonObj["costs"].toObject())))
+    {
+        error = "Error loading costs, please ensure that each is a whole number from 0 to 100 for locomotion, trigger, artifact or logic nodes.";
+        return false;
+    }
+
+    QJsonArray jsonEdgesArray = jsonObj["edges"].toArray();
+    QVector<QPair<QString, QString> > edges;
+
+    foreach (const QJsonValue &v, jsonEdgesArray)
+    {
+        if(!v.isObject())
+        {
+            error = "Error loading edge, please ensure that it is the correct format.";
+            m_graph.clearEdges();
+            return false;
         }
-        else
+
+        QJsonObject jsonEdgeObject = v.toObject();
+
+        if(!jsonEdgeObject.contains("links") || !jsonEdgeObject["links"].isArray() || (jsonEdgeObject["links"].isArray() && jsonEdgeObject["links"].toArray().count() != 2))
         {
-            QMessageBox messageBox;
-            messageBox.critical(0,"Error","File could not be loaded. Ensure that you have the correct permissions");
-            messageBox.setFixedSize(500,200);
-            m_edges.clear();
+            error = "Error loading edge, please ensure that it is the correct format.";
+            m_graph.clearEdges();
+            return false;
+        }
+
+        QJsonArray jsonLinksArray = jsonEdgeObject["links"].toArray();
+
+        if(!jsonLinksArray[0].isString() || !jsonLinksArray[0].isString())
+        {
+            error = "Error loading edge, please ensure that it is the correct format.";
+            m_graph.clearEdges();
             return false;
         }
+
+        edges.append(qMakePair(jsonLinksArray[0].toString(), jsonLinksArray[1].toString()));
     }
-    else
-        return false;
+
+    //compiled once for the whole file
+    m_graph.addEdges(edges);
+
+    return true;
 }
 
-void Lostness::addEdge(QString left, QString right)
+bool Lostness::loadNodes()
 {
-    if(!m_edges.contains(left))
-        m_edges.insert(left, QVector<QString>());
+    bool loaded = readNodes();
+    updateDistances();
 
-    if(!m_edges.contains(right))
-        m_edges.insert(right, QVector<QString>());
-
-    //adj[v].push_back(w); // Add w to v’s list.QString start, QString end
-    m_edges[left].push_back(right);
+    return loaded;
 }
 
-bool Lostness::loadNodes()
+bool Lostness::readNodes()
 {
-    QFile file(QFileDialog::getOpenFileName(this,
+    QFile file(QFileDialog::getOpenFileName(0,
                                                      QObject::tr("Load Nodes"), "",
                                                      QObject::tr("JSON File (*.json);;All Files (*)")));
 
@@ -166,7 +213,7 @@ bool Lostness::loadNodes()
                     QMessageBox messageBox;
                     messageBox.critical(0,"Error","Error loading node, please ensure that it is the correct format.");
                     messageBox.setFixedSize(500,200);
-                    m_nodes.clear();
+                    m_graph.clearTypes();
                     return false;
                 }
 
@@ -177,7 +224,7 @@ bool Lostness::loadNodes()
                     QMessageBox messageBox;
                     messageBox.critical(0,"Error","Error loading node, please ensure that it is the correct format.");
                     messageBox.setFixedSize(500,200);
-                    m_edges.clear();
+                    m_graph.clearEdges();
                     return false;
                 }
 
@@ -190,7 +237,7 @@ bool Lostness::loadNodes()
             QMessageBox messageBox;
             messageBox.critical(0,"Error","File could not be loaded. Ensure that you have the correct permissions");
             messageBox.setFixedSize(500,200);
-            m_edges.clear();
+            m_graph.clearEdges();
             return false;
         }
     }
@@ -200,146 +247,60 @@ bool Lostness::loadNodes()
 
 void Lostness::addNode(QString name, QString type)
 {
-    if(type == "locomotion")
-        m_nodes.insert(name, TYPE_LOCO);
-    else
-        if(type == "trigger")
-            m_nodes.insert(name, TYPE_TRIGGER);
-        else
-            if(type == "artifact")
-                m_nodes.insert(name, TYPE_ARTIFACT);
-            else
-                if(type == "logic")
-                    m_nodes.insert(name, TYPE_LOGIC);
+    SpatialNodeType nodeType;
+
+    if(typeOfName(type, nodeType))
+        m_graph.setType(name, nodeType);
 }
 
-/*void Lostness::getShortestPath(QString firstNode, QString lastNode)
+bool Lostness::readCosts(const QJsonObject &jsonCosts)
 {
-    // Mark all the vertices as not visited
-    QHash<QString, bool> visited;
-    foreach(const QString &key, m_edges.keys())
-        visited.insert(key, false);
-
-    // Create a queue for BFS
-    QList<QString> queue;
-
-    // Mark the first node as visited and enqueue it
-    visited[firstNode] = true;
-    queue.push_back(firstNode);
+    QVector<QPair<SpatialNodeType, int> > costs;
 
-    // 'i' will be used to get all adjacent
-    // vertices of a vertex
-    QVector<QString>::iterator i;
-
-    QString currentNode;
-    qDebug() << "Calculating path from " << firstNode << "to " << lastNode;
-    while(!queue.empty())
+    //all or nothing, the types left out keep their cost
+    for(QJsonObject::const_iterator it = jsonCosts.constBegin(); it != jsonCosts.constEnd(); ++it)
     {
-        // Dequeue a vertex from queue and print it
-        currentNode = queue.front();
-        qDebug() << "   current node: " << currentNode;
-        queue.pop_front();
-
-        // Get all adjacent vertices of the dequeued
-        // vertex s. If a adjacent has not been visited,
-        // then mark it visited and enqueue it
-        for (i = m_edges[currentNode].begin(); i != m_edges[currentNode].end(); ++i)
-        {
-            if (!visited[*i])
-            {
-                visited[*i] = true;
-                queue.push_back(*i);
-            }
-        }
-    }
-}*/
-
-int Lostness::shortestPath(QString start, QString end)
-{
-    QVector<QString> p;
-    return shortestPath(start, end, p);
-}
+        SpatialNodeType type;
+        double cost = it.value().toDouble(-1);
 
-int Lostness::shortestPath(QString start, QString end, QVector<QString>& path)
-        {
-            QVector<_HintsSubResult> nodeQueue;
-            int queueIndex = 0;
-            QSet<QString> visited = QSet<QString>();
-
-            QVector<QString> neighbors = m_edges[start];
-
-            for (const QString &node : neighbors)
-                nodeQueue.push_back(_HintsSubResult(node, 1, node, -1));
+        if(!typeOfName(it.key(), type) || cost < 0 || cost > kMaxStepCost || cost != int(cost))
+            return false;
 
-            for (queueIndex = 0; queueIndex < nodeQueue.size(); queueIndex++)
-            {
-                auto nodeSet = nodeQueue[queueIndex];
+        costs.append(qMakePair(type, int(cost)));
+    }
 
-                if (end == nodeSet.endNode) //|| (end == -1 && isTarget(nodeSet.endNode)))
-                {
-                    _HintsSubResult sub = nodeSet;
-                    path.clear();
-                    while (sub.previous != -1)
-                    {
-                        if(!sub.endNode.contains("Logic"))
-                            path.push_back(sub.endNode);
-                        sub = nodeQueue[sub.previous];
-                    }
-
-                    path.push_back(sub.endNode);
-                    //sub = nodeQueue[sub.previous];
-
-                    //Adjust for artifact
-                    //	nodeSet.length += 1;
-                    return path.length();//nodeSet;
-                }
+    for(int i = 0; i < costs.size(); ++i)
+        m_graph.setTypeCost(costs[i].first, costs[i].second);
 
-                //location = end, startLoc = start
-                neighbors = m_edges[nodeSet.endNode];
+    return true;
+}
 
+int Lostness::shortestPath(const QString &start, const QString &end) const
+{
+    int startId = m_graph.idOf(start);
+    int endId = m_graph.idOf(end);
 
-                //Remove visited nodes
-                std::sort(neighbors.begin(), neighbors.end());
-                QSet<QString> filteredNeighbors;
-                //std::set_difference(neighbors.begin(), neighbors.end(), visited.begin(), visited.end(), std::inserter(filteredNeighbors, filteredNeighbors.begin()));
+    if(startId == SpatialGraph::kNoNode || endId == SpatialGraph::kNoNode)
+        return -1;
 
-                foreach (const QString& val, neighbors) //very inefficient but set_difference won't compile and this may need to be used later
-                {
-                    if(!visited.contains(val))
-                    {
-                        filteredNeighbors.insert(val);
-                        visited.insert(val);
-                    }
-                }
+    return shortestPath(startId, endId);
+}
 
-                /*foreach (const QString& val, filteredNeighbors)   //uncomment if loop above not used
-                {
-                    visited.insert(val);
-                }*/
+int Lostness::shortestPath(int start, int end) const
+{
+    return m_distances.getSteps(m_graph, start, end);
+}
 
-                // Skip logic and trigger nodes for calculating path length.
-                /*if (m_nodes[end] == TYPE_LOGIC || m_nodes[end] == TYPE_TRIGGER)
-                {
-                    std::vector<_HintsSubResult> tempSubResults;
-                    for (auto neighbor : filteredNeighbors)
-                    {
-                        //tempSubResults.push_back(_HintsSubResult(nodeSet.firstNode, nodeSet.length, neighbor, nodeSet.previous));
-                    }
-                    nodeQueue.insert(nodeQueue.begin() + queueIndex + 1, tempSubResults.begin(), tempSubResults.end());
-                }
-                else
-                {*/
-                    for (auto neighbor : filteredNeighbors)
-                    {
-                        nodeQueue.push_back(_HintsSubResult(nodeSet.firstNode, nodeSet.length + 1, neighbor, queueIndex));
-                    }
-                //}
-            }
+void Lostness::updateDistances()
+{
+    if(m_distancesRevision == m_graph.getRevision())
+        return;
 
-            return -1;// HintsSearchResult("", -1, "");
-        }
+    m_distances.build(m_graph, m_cacheDirectory);
+    m_distancesRevision = m_graph.getRevision();
+}
 
-float Lostness::getLostnessForObjective(const QString &startNode, const QString &endNode, int &totalSteps, const int &uniqueSteps, int &minSteps)
+float Lostness::getLostnessForObjective(const QString &startNode, const QString &endNode, int &totalSteps, const int &uniqueSteps, int &minSteps) const
 {
     minSteps = std::min(shortestPath(startNode, endNode), uniqueSteps);
 
@@ -8,67 +8,84 @@
 #include <QJsonArray>
 #include <QJsonObject>
 
-enum SpatialNodeType
-{
-    TYPE_LOCO,
-    TYPE_TRIGGER,
-    TYPE_ARTIFACT,
-    TYPE_LOGIC
-};
-
-struct _HintsSubResult
-        {
-        public:
-            _HintsSubResult(){}
-            _HintsSubResult(QString first, int length, QString end, int prev) : firstNode(first), length(length), endNode(end), previous(prev)
-            {}
-            QString firstNode;
-            int length;
-            QString endNode;
-            int previous;
-        };
-
-        struct HintsSearchResult
-        {
-        public:
-            HintsSearchResult(QString first, int length, QString end) : firstNode(first), length(length), endNode(end)
-            {}
-            HintsSearchResult(_HintsSubResult fromSubResult) : firstNode(fromSubResult.firstNode), length(fromSubResult.length), endNode(fromSubResult.endNode)
-            {}
-            QString firstNode;
-            int length;
-            QString endNode;
-        };
-
-
-class Lostness : public QWidget
+#include "spatialgraph.h"
+#include "spatialdistancetable.h"
+
+///
+/// \brief Spatial graph of the game and the lostness measure worked out on it.
+///
+/// Holds no widgets, so it can be used without a GUI (see AnalyticsBatchRescorer) and read by
+/// the ingest threads. The steps between nodes are worked out whenever the graph changes, so
+/// finding the minimum steps of an objective is a lookup.
+///
+/// What a step onto each type of node costs is given in the spatial graph file as
+/// "costs": {"logic": 0, "trigger": 0}, so that the minimum steps only count real moves.
+///
+class Lostness
 {
 public:
     Lostness();
 
-    float getLostnessValue(int minSteps, int totalSteps, int uniqueSteps);
-    float getLostnessForObjective(const QString &startNode, const QString &endNode, int &totalSteps, const int &uniqueSteps, int &minSteps);
+    ///
+    /// \brief Start from a copy of a graph, the steps are worked out when the next file is loaded
+    ///
+    /// Sessions share a Lostness without locking, so a loaded one is never changed: files are
+    /// loaded into a new one built from the graph of the last.
+    ///
+    explicit Lostness(const SpatialGraph &graph);
+
+    static float getLostnessValue(int minSteps, int totalSteps, int uniqueSteps);
+    float getLostnessForObjective(const QString &startNode, const QString &endNode, int &totalSteps, const int &uniqueSteps, int &minSteps) const;
 
     bool loadEdges();
+
+    ///
+    /// \brief Load the edges without asking for the file, error is set if it fails
+    ///
+    bool loadEdges(const QString &fileName, QString &error);
     bool loadNodes();
 
-    int getNumEdges(){return m_edges.count();}
-    int getNumNodes(){return m_nodes.count();}
+    ///
+    /// \brief Where tables of steps are cached between runs, nothing is cached if it is empty
+    ///
+    void setCacheDirectory(const QString &directory){m_cacheDirectory = directory;}
+
+    int getNumEdges() const {return m_graph.getNumEdges();}
+    int getNumNodes() const {return m_graph.getNumTypedNodes();}
+
+    ///
+    /// \brief Ids of every node of the spatial graph, whether it has edges or only a type
+    ///
+    QStringList getNodeNames() const {return m_graph.getNames();}
+
+    const SpatialGraph &getGraph() const {return m_graph;}
 
 private:
 
-    void addEdge(QString left, QString right);
+    bool readEdges(const QString &fileName, QString &error);
+    bool readNodes();
 
     void addNode(QString name, QString type);
 
-    //void getShortestPath(QString firstNode, QString lastNode);
+    ///
+    /// \brief Set the costs of the types of node in a JSON object, false if any of them is not valid
+    ///
+    bool readCosts(const QJsonObject &jsonCosts);
+
+    ///
+    /// \brief Work out the steps between nodes again if the graph has changed since they were
+    ///
+    void updateDistances();
 
-    int shortestPath(QString start, QString end);
-    int shortestPath(QString start, QString end, QVector<QString>& path);
+    //const and read-only on the graph so analytics sessions can call it from the ingest thread
+    int shortestPath(const QString &start, const QString &end) const;
+    int shortestPath(int start, int end) const;
 
-    QHash<QString, QVector<QString>> m_edges;
+    SpatialGraph m_graph;
 
-    QHash<QString, SpatialNodeType> m_nodes;
+    SpatialDistanceTable m_distances;
+    QString m_cacheDirectory;
+    int m_distancesRevision;
 };
 
 #endif // LOSTNESS_H
@@ -1,23 +1,45 @@
 #include "lostnessgraph.h"
 
 #include <QBoxLayout>
-#include <QScrollArea>
+#include <QLabel>
+
+static const int kMinSpan = 30;     //seconds shown before a session is any longer
+
+//stretches of time the graph can show, 0 is the whole session
+static const int kSpans[] = {0, 30, 5 * 60, 30 * 60, 2 * 60 * 60};
+static const char *kSpanNames[] = {"Whole session", "30 seconds", "5 minutes", "30 minutes", "2 hours"};
+static const int kNumSpans = sizeof(kSpans) / sizeof(kSpans[0]);
 
 LostnessGraph::LostnessGraph(QWidget *parent)
-: m_series(new QtCharts::QLineSeries())
+: QDialog(parent)
 , m_chartView(new QtCharts::QChartView(new QtCharts::QChart()))
+, m_series(new QtCharts::QLineSeries())
 , m_axisX(new QtCharts::QValueAxis())
 , m_axisY(new QtCharts::QValueAxis())
-, QDialog(parent)
+, m_scrollBar(new QScrollBar(Qt::Horizontal))
+, m_spanBox(new QComboBox())
+, m_following(true)
 {
-    //Set up windows and make chart the centre
+    //Set up windows and make chart the centre, it is as big as the window and never wider
     QVBoxLayout *parentLayout = new QVBoxLayout;
-    QScrollArea *scrollArea = new QScrollArea;
-    scrollArea->setWidget(m_chartView);
-    parentLayout->addWidget(scrollArea);
+    QHBoxLayout *spanLayout = new QHBoxLayout;
+
+    for(int i = 0; i < kNumSpans; ++i)
+        m_spanBox->addItem(kSpanNames[i]);
+
+    spanLayout->addWidget(new QLabel(tr("Show:")));
+    spanLayout->addWidget(m_spanBox);
+    spanLayout->addStretch();
+
+    parentLayout->addWidget(m_chartView, 1);
+    parentLayout->addWidget(m_scrollBar);
+    parentLayout->addLayout(spanLayout);
     setLayout(parentLayout);
     setWindowTitle(tr("Lostness"));
-    resize(QSize(400,400));
+    resize(QSize(400,450));
+
+    connect(m_scrollBar, SIGNAL(valueChanged(int)), this, SLOT(onScrolled(int)));
+    connect(m_spanBox, SIGNAL(currentIndexChanged(int)), this, SLOT(onSpanChanged(int)));
 
     //set up chart
     m_chartView->chart()->legend()->hide();
@@ -32,15 +54,16 @@ LostnessGraph::~LostnessGraph()
 
 void LostnessGraph::resetAll()
 {
-    m_series->clear();
-    m_axisX->setRange(0, 30);
-    m_axisY->setRange(0, 1.44);
-    m_chartView->resize(QSize(360,375));
+    m_points.clear();
+    m_points.add(0, 0);     //needed to display the line graph correctly
+    m_following = true;
+
+    updateView();
 }
 
 void LostnessGraph::initialiseChart()
 {
-    m_axisX->setRange(0, 30);
+    m_axisX->setRange(0, kMinSpan);
     m_axisX->setLabelFormat("%.0f");
     m_axisX->setTickCount(7);
     m_axisX->setTitleText("Time (Seconds)");
@@ -53,18 +76,84 @@ void LostnessGraph::initialiseChart()
     m_chartView->chart()->setAxisY(m_axisY, m_series);
 
     m_chartView->setRenderHint(QPainter::Antialiasing);
-    m_chartView->resize(QSize(360,375));
 
-    m_series->append(0, 0); //needed to display the line graph correctly
+    resetAll();
 }
 
 void LostnessGraph::addPoint(qint64 x, float y)
 {
-    if(x > 30 && m_chartView->size().width() < (x*12))
+    m_points.add(x, y);
+
+    updateView();
+}
+
+void LostnessGraph::addPoints(const QVector<QPointF> &points)
+{
+    if(points.isEmpty())
+        return;
+
+    foreach (const QPointF &point, points)
+        m_points.add(qint64(point.x()), point.y());
+
+    updateView(); //one repaint for the whole batch
+}
+
+void LostnessGraph::resizeEvent(QResizeEvent *event)
+{
+    QDialog::resizeEvent(event);
+
+    //a bucket per pixel, so the level of detail follows the width
+    updateView();
+}
+
+void LostnessGraph::onScrolled(int value)
+{
+    m_following = value == m_scrollBar->maximum();
+    updateView();
+}
+
+void LostnessGraph::onSpanChanged(int index)
+{
+    Q_UNUSED(index);
+
+    m_following = true;
+    updateView();
+}
+
+void LostnessGraph::updateView()
+{
+    qint64 end = qMax(qint64(kMinSpan), m_points.getLastX());
+    qint64 span = kSpans[qMax(0, m_spanBox->currentIndex())];
+    qint64 from = 0;
+
+    //the scroll bar is only there while there is something to scroll to
+    m_scrollBar->blockSignals(true);
+
+    if(span == 0 || end <= span)
     {
-         m_axisX->setRange(0, x);
-         m_chartView->resize(x*12, m_chartView->size().height());
+        span = end;
+        m_scrollBar->setVisible(false);
     }
+    else
+    {
+        m_scrollBar->setRange(0, int(end - span));
+        m_scrollBar->setPageStep(int(span));
+        m_scrollBar->setSingleStep(qMax(1, int(span / 10)));
+
+        if(m_following)
+            m_scrollBar->setValue(m_scrollBar->maximum());
+
+        m_scrollBar->setVisible(true);
+        from = m_scrollBar->value();
+    }
+
+    m_scrollBar->blockSignals(false);
+
+    int width = int(m_chartView->chart()->plotArea().width());
+
+    if(width <= 0)  //not laid out yet
+        width = m_chartView->width();
 
-    m_series->append(x, y);
+    m_axisX->setRange(from, from + span);
+    m_series->replace(m_points.getPoints(from, from + span, qMax(1, width)));
 }
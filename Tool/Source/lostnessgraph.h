@@ -3,11 +3,24 @@
 
 #include <QDialog>
 #include <QWidget>
+#include <QVector>
+#include <QPointF>
+#include <QScrollBar>
+#include <QComboBox>
 #include <QtCharts/QLineSeries>
 #include <QtCharts/QChart>
 #include <QtCharts/QChartView>
 #include <QtCharts/QValueAxis>
 
+#include "lostnessseries.h"
+
+///
+/// \brief Lostness of the selected player over time, in a chart that stays the size of the window.
+///
+/// The points are kept in a LostnessSeries and only the stretch of time being shown is put in the
+/// chart, at about one bucket per pixel, so drawing costs the same however long the session is.
+/// Either the whole session is shown or a fixed stretch of it that can be scrolled back through.
+///
 class LostnessGraph : public QDialog
 {
     Q_OBJECT
@@ -19,8 +32,18 @@ public:
     void resetAll();
 
     void addPoint(qint64 x, float y);
+    void addPoints(const QVector<QPointF> &points);
+
+protected:
+    void resizeEvent(QResizeEvent *event) override;
+
+private slots:
+    void onScrolled(int value);
+    void onSpanChanged(int index);
+
 private:
     void initialiseChart();
+    void updateView();
 
     QtCharts::QChartView *m_chartView;
 
@@ -28,6 +51,12 @@ private:
 
     QtCharts::QValueAxis *m_axisX;
     QtCharts::QValueAxis *m_axisY;
+
+    QScrollBar *m_scrollBar;
+    QComboBox *m_spanBox;
+
+    LostnessSeries m_points;
+    bool m_following;   //keep the newest points in view, until scrolled back
 };
 
 #endif // LOSTNESSGRAPH_H
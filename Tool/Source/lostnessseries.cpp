@@ -0,0 +1,111 @@
+#include "lostnessseries.h"
+
+static const int kLevelFactor = 4;      //each level's buckets are this many of the level below, 1s up to about 4.5h
+static const qint64 kMaxSeconds = 7 * 24 * 60 * 60;     //points later than this are put at it, a session never runs that long
+
+void LostnessSeries::Bucket::add(qint32 x, float y)
+{
+    if(count == 0 || y < min)
+    {
+        min = y;
+        minX = x;
+    }
+
+    if(count == 0 || y > max)
+    {
+        max = y;
+        maxX = x;
+    }
+
+    if(count == 0 || x >= lastX)
+    {
+        last = y;
+        lastX = x;
+    }
+
+    ++count;
+}
+
+LostnessSeries::LostnessSeries()
+    : m_lastX(0)
+{
+
+}
+
+qint64 LostnessSeries::bucketWidth(int level)
+{
+    qint64 width = 1;
+
+    for(int i = 0; i < level; ++i)
+        width *= kLevelFactor;
+
+    return width;
+}
+
+void LostnessSeries::clear()
+{
+    for(int i = 0; i < kNumLevels; ++i)
+        m_levels[i].clear();
+
+    m_lastX = 0;
+}
+
+void LostnessSeries::add(qint64 x, float y)
+{
+    x = qBound(qint64(0), x, kMaxSeconds);
+
+    for(int i = 0; i < kNumLevels; ++i)
+    {
+        int index = int(x / bucketWidth(i));
+
+        if(index >= m_levels[i].size())
+            m_levels[i].resize(index + 1);
+
+        m_levels[i][index].add(qint32(x), y);
+    }
+
+    m_lastX = qMax(m_lastX, x);
+}
+
+QVector<QPointF> LostnessSeries::getPoints(qint64 from, qint64 to, int maxBuckets) const
+{
+    QVector<QPointF> points;
+
+    if(isEmpty() || to < from)
+        return points;
+
+    //finest level that fits, the coarsest one if none does
+    int level = 0;
+
+    while(level < kNumLevels - 1 && (to - from) / bucketWidth(level) > maxBuckets)
+        ++level;
+
+    const QVector<Bucket> &buckets = m_levels[level];
+    qint64 width = bucketWidth(level);
+    int first = int(qBound(qint64(0), from / width - 1, qint64(buckets.size())));
+    int last = int(qBound(qint64(0), to / width + 2, qint64(buckets.size())));
+
+    points.reserve((last - first) * 3);
+
+    for(int i = first; i < last; ++i)
+    {
+        const Bucket &bucket = buckets[i];
+
+        if(bucket.count == 0)
+            continue;
+
+        //the extremes in the order they happened, so a spike is drawn even when a bucket is narrower than a pixel
+        QPointF extremes[3] = {QPointF(bucket.minX, bucket.min), QPointF(bucket.maxX, bucket.max), QPointF(bucket.lastX, bucket.last)};
+
+        if(extremes[1].x() < extremes[0].x())
+            qSwap(extremes[0], extremes[1]);
+
+        points.append(extremes[0]);
+
+        for(int j = 1; j < 3; ++j)
+            if(extremes[j] != points.last())
+                points.append(extremes[j]);
+    }
+
+    return points;
+}
@@ -0,0 +1,65 @@
+#ifndef LOSTNESSSERIES_H
+#define LOSTNESSSERIES_H
+
+#include <QVector>
+#include <QPointF>
+
+///
+/// \brief Lostness over the time of a session, kept at several resolutions for drawing any stretch of it.
+///
+/// Every point goes into one bucket of each level, from one second wide up to a few hours wide,
+/// which keeps the smallest, largest and last lostness that fell in it. Memory grows with the length
+/// of the session in seconds, not with the number of points, and drawing a stretch only reads the
+/// level whose buckets are about as wide as a pixel.
+///
+class LostnessSeries
+{
+public:
+    LostnessSeries();
+
+    void clear();
+
+    ///
+    /// \brief Add the lostness at x seconds into the session, points may arrive in any order
+    ///
+    void add(qint64 x, float y);
+
+    bool isEmpty() const {return m_levels[0].isEmpty();}
+
+    ///
+    /// \brief Latest time with a point, 0 if there are none
+    ///
+    qint64 getLastX() const {return m_lastX;}
+
+    ///
+    /// \brief Points to draw the time from..to with, from no more than about maxBuckets buckets
+    ///
+    /// The buckets just outside the range are included, so the line runs on to the edges.
+    ///
+    QVector<QPointF> getPoints(qint64 from, qint64 to, int maxBuckets) const;
+
+private:
+    struct Bucket
+    {
+        Bucket() : count(0), min(0), max(0), last(0), minX(0), maxX(0), lastX(0) {}
+
+        void add(qint32 x, float y);
+
+        qint32 count;
+        float min;
+        float max;
+        float last;
+        qint32 minX;
+        qint32 maxX;
+        qint32 lastX;
+    };
+
+    static const int kNumLevels = 8;
+
+    static qint64 bucketWidth(int level);
+
+    QVector<Bucket> m_levels[kNumLevels];   //indexed by x divided by the width of the level's buckets
+    qint64 m_lastX;
+};
+
+#endif // LOSTNESSSERIES_H
@@ -1,6 +1,88 @@
 #include "mainwindow.h"
 
 #include <QApplication>
+#include <QCoreApplication>
+#include <QDebug>
+
+#include "analyticslatencyprobe.h"
+#include "analyticsbatchrescorer.h"
+
+static const QString kName_VerbFile = "analyticsverbs.json";    //same file the analytics handler loads
+
+///
+/// \brief Re-score a directory of logs without the GUI.
+///
+/// "--rescore <spatial graph.json> <tasks.json> <log directory> <output directory> [--start-node <node>] [--columns] [--no-graph-cache]"
+///
+/// \return             0 if every log was re-scored, otherwise an error code.
+///
+static int rescoreLogs(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    app.setOrganizationName("Reveal VR Consortium");
+    app.setApplicationName("Reveal_StoryScaffolding");
+
+    QStringList arguments = app.arguments();
+    int rescoreArg = arguments.indexOf("--rescore");
+    int startNodeArg = arguments.indexOf("--start-node");
+
+    if(rescoreArg + 4 >= arguments.size())
+    {
+        qDebug() << "Usage: --rescore <spatial graph.json> <tasks.json> <log directory> <output directory> [--start-node <node>] [--columns] [--no-graph-cache]";
+        return 1;
+    }
+
+    AnalyticsBatchRescorer rescorer;
+    AnalyticsVerbTable verbs;
+    QString error;
+
+    verbs.loadFromFile(kName_VerbFile);    //the default verbs are kept if there is no file
+    rescorer.setVerbs(verbs);
+
+    if(startNodeArg != -1 && startNodeArg + 1 < arguments.size())
+        rescorer.setStartNode(arguments[startNodeArg + 1]);
+
+    rescorer.setColumnarExport(arguments.contains("--columns"));
+
+    if(arguments.contains("--no-graph-cache"))
+        rescorer.setGraphCacheDirectory(QString());
+
+    if(!rescorer.loadSpatialGraph(arguments[rescoreArg + 1], error) || !rescorer.loadCuratorLabels(arguments[rescoreArg + 2], error))
+    {
+        qDebug().noquote() << error;
+        return 1;
+    }
+
+    int numFailed = rescorer.run(arguments[rescoreArg + 3], arguments[rescoreArg + 4]);
+
+    if(numFailed > 0)
+        qDebug() << numFailed << "logs could not be re-scored, see summary.csv";
+
+    return numFailed == 0 ? 0 : 1;
+}
+
+///
+/// \brief Average objective lostness over the columnar logs written by "--rescore ... --columns".
+///
+/// "--aggregate <columnar log directory> <output.csv>"
+///
+/// \return             0 if the CSV was written, otherwise an error code.
+///
+static int aggregateLogs(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QStringList arguments = app.arguments();
+    int aggregateArg = arguments.indexOf("--aggregate");
+
+    if(aggregateArg + 2 >= arguments.size())
+    {
+        qDebug() << "Usage: --aggregate <columnar log directory> <output.csv>";
+        return 1;
+    }
+
+    return AnalyticsBatchRescorer::aggregate(arguments[aggregateArg + 1], arguments[aggregateArg + 2]) ? 0 : 1;
+}
 
 ///
 /// \brief Main function of this application.
@@ -12,16 +94,36 @@
 ///
 int main(int argc, char *argv[])
 {
+    //batch re-scoring runs without creating any widgets, so it works without a display
+    for(int i = 1; i < argc; ++i)
+    {
+        if(qstrcmp(argv[i], "--rescore") == 0)
+            return rescoreLogs(argc, argv);
+
+        if(qstrcmp(argv[i], "--aggregate") == 0)
+            return aggregateLogs(argc, argv);
+    }
+
     // create application
     QApplication app(argc, argv);
     app.setOrganizationName("Reveal VR Consortium");
     app.setOrganizationDomain("http://revealvr.eu/");
     app.setApplicationName("Reveal_StoryScaffolding");
 
+    // "--benchmark <report.csv> [--benchmark-budget <ms>]" measures analytics latency, see AnalyticsBench
+    QStringList arguments = app.arguments();
+    int benchmarkArg = arguments.indexOf("--benchmark");
+    int budgetArg = arguments.indexOf("--benchmark-budget");
+
+    if(benchmarkArg != -1 && benchmarkArg + 1 < arguments.size())
+        AnalyticsLatencyProbe::enable(arguments[benchmarkArg + 1], budgetArg != -1 && budgetArg + 1 < arguments.size() ? arguments[budgetArg + 1].toInt() : 100);
+
     // create the main window and enter the main execution loop
     MainWindow window;
     window.show();
     int result = app.exec();
 
+    AnalyticsLatencyProbe::writeReport();
+
     return result;
 }
@@ -60,8 +60,8 @@ MainCtrl::MainCtrl(QObject *parent, zodiac::Scene* scene, PropertyEditor* proper
     connect(&m_scene, SIGNAL(updateAnalyticsProperties()),
             this, SLOT(updateAnalyticsProperties()));
 
-    connect(m_analytics, SIGNAL(unlockNode(QString)),
-            this, SLOT(unlockNode(QString)));
+    connect(m_analytics, SIGNAL(unlockNodes(QStringList)),
+            this, SLOT(unlockNodes(QStringList)));
 
     connect(m_analytics, &AnalyticsHandler::checkForGraphs,
         [=]{ checkGraphLoaded(zodiac::NODE_STORY); checkGraphLoaded(zodiac::NODE_NARRATIVE);});
@@ -1721,50 +1721,37 @@ void MainCtrl::resetAllNodes()
 }
 
 void MainCtrl::unlockNode(QString nodeName)
+{
+    unlockNodes(QStringList(nodeName));
+}
+
+void MainCtrl::unlockNodes(QStringList nodeNames)
 {
     QList<zodiac::NodeHandle> currentNodes =  m_scene.getNodes();
 
-    zodiac::NodeHandle foundNode;
+    //index the scene once for the whole batch instead of searching it for every node
+    QHash<QString, QList<zodiac::NodeHandle>> narrativeNodes;
 
     foreach(zodiac::NodeHandle cNode, currentNodes)
-    {
-        if(cNode.getType() == zodiac::NODE_NARRATIVE && cNode.getName() == nodeName)
-        {
-            foundNode = cNode;
-
-            //unlocked change colour of node to green to show unlocked
-            cNode.setLockedStatus(zodiac::UNLOCKED);
-            cNode.setIdleColor(unlockedNodeUnselectedColor);
-            cNode.setSelectedColor(unlockedNodeSelectedColor);
-
-            //change colour of story nodes to green as now unlocked, also show links more pronounced for related nodes
-            if(cNode.getPlug("storyOut").isValid())
-            {
-                QList<zodiac::PlugHandle> storyOutPlugs = cNode.getPlug("storyOut").getConnectedPlugs();
-
-                foreach(zodiac::PlugHandle outPlug, storyOutPlugs)
-                {
-                    outPlug.getNode().setIdleColor(unlockedNodeUnselectedColor);
-                    cNode.setSelectedColor(unlockedNodeSelectedColor);
-                }
-            }
+        if(cNode.getType() == zodiac::NODE_NARRATIVE)
+            narrativeNodes[cNode.getName()].push_back(cNode);
 
-            //check if other nodes are unlockable, turn them blue
-            if(cNode.getPlug("reqIn").isValid())
-            {
-                QList<zodiac::NodeHandle> reqNodes;
-                QList<zodiac::PlugHandle> reqPlugs = cNode.getPlug("reqIn").getConnectedPlugs();
+    zodiac::NodeHandle foundNode;
 
-                //get all nodes which require node to be unlocked first
-                foreach(zodiac::PlugHandle reqPlug, reqPlugs)
-                    reqNodes.push_back(reqPlug.getNode());
+    foreach(const QString &nodeName, nodeNames)
+    {
+        QList<zodiac::NodeHandle> matchingNodes = narrativeNodes.value(nodeName);
 
-                showUnlockableNodes(reqNodes);
-            }
+        for(QList<zodiac::NodeHandle>::iterator nodeIt = matchingNodes.begin(); nodeIt != matchingNodes.end(); ++nodeIt)
+        {
+            foundNode = *nodeIt;
+            unlockNarrativeNode(*nodeIt);
         }
     }
 
+    //only the area of the last node unlocked is highlighted, so this is done once per batch
     if(foundNode.isValid())
+    {
         foreach(zodiac::NodeHandle cNode, currentNodes)
         {
             if(cNode.getType() == zodiac::NODE_NARRATIVE)
@@ -1775,12 +1762,13 @@ void MainCtrl::unlockNode(QString nodeName)
                     cNode.getPlug("storyOut").changeEdgeColor(QColor(0,204, 0, 25));
                 }
             }
+        }
 
-            if(foundNode.getPlug("reqOut").isValid())
-            {
-                getNarrativeGroupParent(foundNode);
-            }
+        if(foundNode.getPlug("reqOut").isValid())
+        {
+            getNarrativeGroupParent(foundNode);
         }
+    }
 
     /*if(!found)
     {
@@ -1790,6 +1778,39 @@ void MainCtrl::unlockNode(QString nodeName)
     }*/
 }
 
+void MainCtrl::unlockNarrativeNode(zodiac::NodeHandle &node)
+{
+    //unlocked change colour of node to green to show unlocked
+    node.setLockedStatus(zodiac::UNLOCKED);
+    node.setIdleColor(unlockedNodeUnselectedColor);
+    node.setSelectedColor(unlockedNodeSelectedColor);
+
+    //change colour of story nodes to green as now unlocked, also show links more pronounced for related nodes
+    if(node.getPlug("storyOut").isValid())
+    {
+        QList<zodiac::PlugHandle> storyOutPlugs = node.getPlug("storyOut").getConnectedPlugs();
+
+        foreach(zodiac::PlugHandle outPlug, storyOutPlugs)
+        {
+            outPlug.getNode().setIdleColor(unlockedNodeUnselectedColor);
+            node.setSelectedColor(unlockedNodeSelectedColor);
+        }
+    }
+
+    //check if other nodes are unlockable, turn them blue
+    if(node.getPlug("reqIn").isValid())
+    {
+        QList<zodiac::NodeHandle> reqNodes;
+        QList<zodiac::PlugHandle> reqPlugs = node.getPlug("reqIn").getConnectedPlugs();
+
+        //get all nodes which require node to be unlocked first
+        foreach(zodiac::PlugHandle reqPlug, reqPlugs)
+            reqNodes.push_back(reqPlug.getNode());
+
+        showUnlockableNodes(reqNodes);
+    }
+}
+
 void MainCtrl::getNarrativeGroupParent(zodiac::NodeHandle &node)
 {
     if(node.getPlug("reqOut").isValid())
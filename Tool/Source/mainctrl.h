@@ -165,6 +165,11 @@ public slots:
     ///
     void unlockNode(QString nodeName);
 
+    ///
+    /// \brief Shows a batch of nodes being unlocked, the scene is only searched once
+    ///
+    void unlockNodes(QStringList nodeNames);
+
     ///
     /// \brief Checks that a graph is loaded before starting a process
     ///
@@ -286,6 +291,7 @@ private: // members
     void lockAllNodes();
     void resetAllNodes();
 
+    void unlockNarrativeNode(zodiac::NodeHandle &node);
     void showUnlockableNodes(QList<zodiac::NodeHandle> &nodes);
     bool areAllNodesUnlocked(QList<zodiac::NodeHandle> &nodes);
 
@@ -0,0 +1,437 @@
+#include "spatialdistancetable.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QDataStream>
+#include <QCryptographicHash>
+#include <QRunnable>
+#include <QThreadPool>
+#include <QThread>
+#include <QThreadStorage>
+#include <QReadLocker>
+#include <QWriteLocker>
+#include <QDebug>
+
+#include <algorithm>
+#include <functional>
+
+static const quint32 kCacheMagic = 0x53534453;  //"SSDS"
+static const quint32 kCacheVersion = 2;         //bump when the steps are worked out differently
+
+static const QString kCacheSuffix = ".ssdsteps";
+
+typedef QPair<int, int> HeapEntry;  //cost so far, node
+
+//what a search needs, kept by each thread and reused so a search allocates and clears nothing
+struct SearchState
+{
+    SearchState() : generation(0) {}
+
+    void prepare(int numNodes)
+    {
+        if(cost[0].size() < numNodes)
+        {
+            for(int i = 0; i < 2; ++i)
+            {
+                stamp[i].fill(0, numNodes);
+                cost[i].resize(numNodes);
+            }
+
+            generation = 0;
+        }
+
+        for(int i = 0; i < 2; ++i)
+            heap[i].resize(0);  //keeps its capacity
+
+        //a node is reached when its stamp is this search's generation, the stamps only need clearing when it wraps
+        if(++generation == 0)
+        {
+            stamp[0].fill(0);
+            stamp[1].fill(0);
+            generation = 1;
+        }
+    }
+
+    quint32 generation;
+
+    //forwards from the start and backwards from the end
+    QVector<quint32> stamp[2];
+    QVector<int> cost[2];
+    QVector<HeapEntry> heap[2];
+};
+
+static QThreadStorage<SearchState*> s_searchStates;
+
+static SearchState &searchState(int numNodes)
+{
+    if(!s_searchStates.hasLocalData())
+        s_searchStates.setLocalData(new SearchState);
+
+    SearchState &state = *s_searchStates.localData();
+    state.prepare(numNodes);
+
+    return state;
+}
+
+//one side of a search, the cheapest node waiting is taken first
+struct SearchSide
+{
+    SearchSide(SearchState &state, int side, const int *offsets, const int *neighbors)
+        : stamp(state.stamp[side].data())
+        , cost(state.cost[side].data())
+        , heap(state.heap[side])
+        , generation(state.generation)
+        , offsets(offsets)
+        , neighbors(neighbors)
+    {}
+
+    bool isReached(int node) const {return stamp[node] == generation;}
+
+    ///
+    /// \brief Whether the node was reached for less than before
+    ///
+    bool reach(int node, int nodeCost)
+    {
+        if(isReached(node) && cost[node] <= nodeCost)
+            return false;
+
+        stamp[node] = generation;
+        cost[node] = nodeCost;
+        heap.append(HeapEntry(nodeCost, node));
+        std::push_heap(heap.begin(), heap.end(), std::greater<HeapEntry>());
+
+        return true;
+    }
+
+    ///
+    /// \brief Drop entries left behind by nodes reached for less since, false when nothing is waiting
+    ///
+    bool hasNext()
+    {
+        while(!heap.isEmpty() && heap.first().first > cost[heap.first().second])
+            takeNext();
+
+        return !heap.isEmpty();
+    }
+
+    int nextCost() const {return heap.first().first;}
+
+    int takeNext()
+    {
+        std::pop_heap(heap.begin(), heap.end(), std::greater<HeapEntry>());
+        int node = heap.last().second;
+        heap.removeLast();
+
+        return node;
+    }
+
+    quint32 *stamp;
+    int *cost;
+    QVector<HeapEntry> &heap;
+    quint32 generation;
+    const int *offsets;
+    const int *neighbors;
+};
+
+//stepping from the start costs at least one, so paths from it are never free
+static inline int stepCost(const int *costs, int from, int node, int next)
+{
+    return node == from ? qMax(1, costs[next]) : costs[next];
+}
+
+class SpatialDistanceTable::Task : public QRunnable
+{
+public:
+    Task(const SpatialGraph &graph, const QVector<int> &sources, int begin, int end, quint16 *steps)
+        : m_graph(graph)
+        , m_sources(sources)
+        , m_begin(begin)
+        , m_end(end)
+        , m_steps(steps)
+    {}
+
+    void run() override
+    {
+        //each task fills its own rows, the graph is only read
+        int numNodes = m_graph.getNumNodes();
+
+        for(int i = m_begin; i < m_end; ++i)
+            searchAll(m_graph, m_sources[i], m_steps + qint64(i) * numNodes);
+    }
+
+private:
+    const SpatialGraph &m_graph;
+    const QVector<int> &m_sources;
+    int m_begin;
+    int m_end;
+    quint16 *m_steps;
+};
+
+SpatialDistanceTable::SpatialDistanceTable()
+{
+    clear();
+}
+
+void SpatialDistanceTable::clear()
+{
+    m_numNodes = 0;
+    m_numRows = 0;
+    m_rowOf.clear();
+    m_steps.clear();
+
+    QWriteLocker locker(&m_pairLock);
+    m_pairSteps.clear();
+}
+
+void SpatialDistanceTable::build(const SpatialGraph &graph, const QString &cacheDirectory)
+{
+    clear();
+
+    m_numNodes = graph.getNumNodes();
+
+    if(m_numNodes == 0)
+        return;
+
+    QVector<int> sources;
+
+    if(m_numNodes <= kMaxTableNodes)
+    {
+        for(int i = 0; i < m_numNodes; ++i)
+            sources.append(i);
+    }
+    else
+    {
+        //landmarks are the nodes with the most edges in and out
+        QVector<int> degree(m_numNodes, 0);
+        const int *offsets = graph.getOffsets();
+        const int *neighbors = graph.getNeighbors();
+
+        for(int i = 0; i < m_numNodes; ++i)
+        {
+            degree[i] += offsets[i + 1] - offsets[i];
+
+            for(int j = offsets[i]; j < offsets[i + 1]; ++j)
+                ++degree[neighbors[j]];
+        }
+
+        sources.resize(m_numNodes);
+
+        for(int i = 0; i < m_numNodes; ++i)
+            sources[i] = i;
+
+        std::partial_sort(sources.begin(), sources.begin() + kNumLandmarks, sources.end(), [&degree](int a, int b)
+        {
+            return degree[a] != degree[b] ? degree[a] > degree[b] : a < b;
+        });
+
+        sources.resize(kNumLandmarks);
+    }
+
+    m_numRows = sources.size();
+    m_rowOf.fill(-1, m_numNodes);
+
+    for(int i = 0; i < m_numRows; ++i)
+        m_rowOf[sources[i]] = i;
+
+    QByteArray hash;
+    QString cacheFile;
+
+    if(isComplete() && !cacheDirectory.isEmpty())
+    {
+        hash = hashOf(graph);
+        cacheFile = QDir(cacheDirectory).filePath(QString::fromLatin1(hash.toHex()) + kCacheSuffix);
+
+        if(readCache(cacheFile, hash))
+            return;
+    }
+
+    m_steps.resize(m_numRows * m_numNodes);
+
+    QThreadPool pool;
+    pool.setMaxThreadCount(qMax(1, QThread::idealThreadCount()));
+
+    //a few tasks per core, so a core that finishes early takes another
+    int numTasks = qMin(m_numRows, pool.maxThreadCount() * 4);
+
+    for(int i = 0; i < numTasks; ++i)
+        pool.start(new Task(graph, sources, i * m_numRows / numTasks, (i + 1) * m_numRows / numTasks, m_steps.data()));
+
+    pool.waitForDone();
+
+    if(!cacheFile.isEmpty())
+        writeCache(cacheFile, hash);
+}
+
+int SpatialDistanceTable::getSteps(const SpatialGraph &graph, int from, int to) const
+{
+    if(from < 0 || from >= m_numNodes || to < 0 || to >= m_numNodes)
+        return -1;
+
+    int row = m_rowOf[from];
+
+    if(row == -1)
+    {
+        quint64 pair = (quint64(quint32(from)) << 32) | quint32(to);
+
+        {
+            QReadLocker locker(&m_pairLock);
+            QHash<quint64, int>::const_iterator it = m_pairSteps.constFind(pair);
+
+            if(it != m_pairSteps.constEnd())
+                return it.value();
+        }
+
+        int steps = search(graph, from, to);
+
+        QWriteLocker locker(&m_pairLock);
+
+        if(m_pairSteps.size() >= kMaxCachedPairs)
+            m_pairSteps.clear();
+
+        m_pairSteps.insert(pair, steps);
+
+        return steps;
+    }
+
+    quint16 steps = m_steps[row * m_numNodes + to];
+
+    return steps == kUnreachable ? -1 : steps;
+}
+
+int SpatialDistanceTable::search(const SpatialGraph &graph, int from, int to)
+{
+    SearchState &state = searchState(graph.getNumNodes());
+    SearchSide forwards(state, 0, graph.getOffsets(), graph.getNeighbors());
+    SearchSide backwards(state, 1, graph.getReverseOffsets(), graph.getReverseNeighbors());
+    const int *costs = graph.getCosts();
+    int best = -1;
+
+    backwards.reach(to, 0);
+
+    //the start is not reached, so a path back to it has to go round a loop
+    for(int i = forwards.offsets[from]; i < forwards.offsets[from + 1]; ++i)
+    {
+        int next = forwards.neighbors[i];
+
+        if(forwards.reach(next, stepCost(costs, from, from, next)) && backwards.isReached(next))
+            best = forwards.cost[next];
+    }
+
+    //the side with fewer nodes waiting goes next, until nothing either has waiting could make a cheaper path
+    while(forwards.hasNext() && backwards.hasNext())
+    {
+        if(best != -1 && forwards.nextCost() + backwards.nextCost() >= best)
+            break;
+
+        bool isForwards = forwards.heap.size() <= backwards.heap.size();
+        SearchSide &side = isForwards ? forwards : backwards;
+        SearchSide &other = isForwards ? backwards : forwards;
+        int node = side.takeNext();
+
+        for(int i = side.offsets[node]; i < side.offsets[node + 1]; ++i)
+        {
+            int next = side.neighbors[i];
+            int nextCost = side.cost[node] + (isForwards ? stepCost(costs, from, node, next) : stepCost(costs, from, next, node));
+
+            if(side.reach(next, nextCost) && other.isReached(next) && (best == -1 || nextCost + other.cost[next] < best))
+                best = nextCost + other.cost[next];
+        }
+    }
+
+    return best;
+}
+
+void SpatialDistanceTable::searchAll(const SpatialGraph &graph, int from, quint16 *row)
+{
+    int numNodes = graph.getNumNodes();
+    SearchState &state = searchState(numNodes);
+    SearchSide forwards(state, 0, graph.getOffsets(), graph.getNeighbors());
+    const int *costs = graph.getCosts();
+
+    for(int i = forwards.offsets[from]; i < forwards.offsets[from + 1]; ++i)
+        forwards.reach(forwards.neighbors[i], stepCost(costs, from, from, forwards.neighbors[i]));
+
+    while(forwards.hasNext())
+    {
+        int node = forwards.takeNext();
+
+        for(int i = forwards.offsets[node]; i < forwards.offsets[node + 1]; ++i)
+            forwards.reach(forwards.neighbors[i], forwards.cost[node] + stepCost(costs, from, node, forwards.neighbors[i]));
+    }
+
+    for(int i = 0; i < numNodes; ++i)
+        row[i] = forwards.isReached(i) ? quint16(qMin(forwards.cost[i], int(kUnreachable) - 1)) : kUnreachable;
+}
+
+QByteArray SpatialDistanceTable::hashOf(const SpatialGraph &graph)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    int numNodes = graph.getNumNodes();
+
+    for(int i = 0; i < numNodes; ++i)
+    {
+        hash.addData(graph.nameOf(i).toUtf8());
+        hash.addData("\n", 1);
+    }
+
+    hash.addData(reinterpret_cast<const char*>(graph.getOffsets()), (numNodes + 1) * int(sizeof(int)));
+    hash.addData(reinterpret_cast<const char*>(graph.getNeighbors()), graph.getNumEdges() * int(sizeof(int)));
+    hash.addData(reinterpret_cast<const char*>(graph.getCosts()), numNodes * int(sizeof(int)));
+
+    return hash.result();
+}
+
+bool SpatialDistanceTable::readCache(const QString &fileName, const QByteArray &hash)
+{
+    QFile file(fileName);
+
+    if(!file.open(QIODevice::ReadOnly))
+        return false;
+
+    QDataStream stream(&file);
+    quint32 magic, version;
+    QByteArray fileHash;
+    qint32 numNodes;
+
+    stream >> magic >> version >> fileHash >> numNodes;
+
+    if(stream.status() != QDataStream::Ok || magic != kCacheMagic || version != kCacheVersion || fileHash != hash || numNodes != m_numNodes)
+        return false;
+
+    //written raw, the cache is only read back on the machine that wrote it
+    m_steps.resize(m_numNodes * m_numNodes);
+    int size = m_steps.size() * int(sizeof(quint16));
+
+    if(stream.readRawData(reinterpret_cast<char*>(m_steps.data()), size) != size)
+    {
+        qDebug() << "Spatial graph cache" << fileName << "is cut short";
+        m_steps.clear();
+        return false;
+    }
+
+    return true;
+}
+
+void SpatialDistanceTable::writeCache(const QString &fileName, const QByteArray &hash) const
+{
+    if(!QDir().mkpath(QFileInfo(fileName).absolutePath()))
+        return;
+
+    //written aside and renamed, so another instance never reads half a table
+    QSaveFile file(fileName);
+
+    if(!file.open(QIODevice::WriteOnly))
+    {
+        qDebug() << "Could not write spatial graph cache" << fileName;
+        return;
+    }
+
+    QDataStream stream(&file);
+    stream << kCacheMagic << kCacheVersion << hash << qint32(m_numNodes);
+    stream.writeRawData(reinterpret_cast<const char*>(m_steps.constData()), m_steps.size() * int(sizeof(quint16)));
+
+    if(!file.commit())
+        qDebug() << "Could not write spatial graph cache" << fileName;
+}
@@ -0,0 +1,82 @@
+#ifndef SPATIALDISTANCETABLE_H
+#define SPATIALDISTANCETABLE_H
+
+#include <QVector>
+#include <QString>
+#include <QByteArray>
+#include <QHash>
+#include <QReadWriteLock>
+
+#include "spatialgraph.h"
+
+///
+/// \brief Steps between the nodes of a spatial graph, worked out once when the graph is loaded.
+///
+/// The steps of a path are what stepping onto each of its nodes costs (see SpatialGraph), the
+/// first step costing at least one. A row of the fewest steps is found from each source with one
+/// Dijkstra search, the rows being split between the cores. Graphs of up to kMaxTableNodes nodes
+/// get a row for every node, so any query is a lookup. Bigger graphs only get rows for
+/// kNumLandmarks landmarks, the best connected nodes: queries from a landmark are still looked up
+/// and the rest are searched by search(), keeping the answer for when the same pair comes again.
+///
+/// Full tables can be cached on disk, named by a hash of the compiled graph, so loading the same
+/// graph again reads the table instead of searching.
+///
+class SpatialDistanceTable
+{
+public:
+    static const quint16 kUnreachable = 0xffff;
+    static const int kMaxTableNodes = 4096;     //32MB of steps
+    static const int kNumLandmarks = 32;
+    static const int kMaxCachedPairs = 65536;   //searched pairs kept before starting over
+
+    SpatialDistanceTable();
+
+    void clear();
+
+    ///
+    /// \brief Work out the rows for the graph, reading and writing the cache if the directory is set
+    ///
+    void build(const SpatialGraph &graph, const QString &cacheDirectory);
+
+    ///
+    /// \brief Steps from one node to the other, -1 if there is no path
+    ///
+    /// The graph has to be the one the table was built for.
+    ///
+    int getSteps(const SpatialGraph &graph, int from, int to) const;
+
+    bool isComplete() const {return m_numRows == m_numNodes;}
+
+    ///
+    /// \brief Steps from one node to the other found by searching, -1 if there is no path
+    ///
+    /// Searches forwards from the start and backwards from the end until no cheaper path can be
+    /// found where they meet, with space kept by each calling thread, so it can be called from any
+    /// thread without locking.
+    ///
+    static int search(const SpatialGraph &graph, int from, int to);
+
+private:
+    class Task;
+
+    ///
+    /// \brief Steps from a node to every node, kUnreachable for the ones it has no path to
+    ///
+    static void searchAll(const SpatialGraph &graph, int from, quint16 *row);
+
+    static QByteArray hashOf(const SpatialGraph &graph);
+
+    bool readCache(const QString &fileName, const QByteArray &hash);
+    void writeCache(const QString &fileName, const QByteArray &hash) const;
+
+    int m_numNodes;
+    int m_numRows;
+    QVector<int> m_rowOf;       //row of each node, -1 if it has none
+    QVector<quint16> m_steps;   //m_numRows rows of m_numNodes steps
+
+    mutable QHash<quint64, int> m_pairSteps;    //searched steps by from and to
+    mutable QReadWriteLock m_pairLock;
+};
+
+#endif // SPATIALDISTANCETABLE_H
@@ -0,0 +1,232 @@
+#include "spatialgraph.h"
+
+SpatialGraph::SpatialGraph()
+    : m_revision(0)
+{
+    m_typeCosts[TYPE_LOCO] = 1;
+    m_typeCosts[TYPE_TRIGGER] = 1;
+    m_typeCosts[TYPE_ARTIFACT] = 1;
+    m_typeCosts[TYPE_LOGIC] = 0;
+
+    clear();
+}
+
+void SpatialGraph::clear()
+{
+    m_ids.clear();
+    m_names.clear();
+    m_flags.clear();
+    m_types.clear();
+    m_costs.clear();
+    m_neighbors.clear();
+    m_reverseNeighbors.clear();
+
+    m_offsets.clear();
+    m_offsets.append(0);
+    m_reverseOffsets = m_offsets;
+
+    ++m_revision;
+}
+
+void SpatialGraph::clearEdges()
+{
+    compile(QVector<QPair<int, int> >());
+}
+
+void SpatialGraph::clearTypes()
+{
+    for(int i = 0; i < m_flags.size(); ++i)
+    {
+        m_flags[i] &= ~kFlag_Typed;
+        m_types[i] = quint8(defaultType(i));
+        m_costs[i] = m_typeCosts[m_types[i]];
+    }
+
+    compile(getEdges());
+}
+
+void SpatialGraph::addEdges(const QVector<QPair<QString, QString> > &edges)
+{
+    QVector<QPair<int, int> > idEdges = getEdges();
+    idEdges.reserve(idEdges.size() + edges.size());
+
+    for(int i = 0; i < edges.size(); ++i)
+        idEdges.append(qMakePair(intern(edges[i].first), intern(edges[i].second)));
+
+    compile(idEdges);
+}
+
+void SpatialGraph::setType(const QString &name, SpatialNodeType type)
+{
+    int id = intern(name);
+
+    m_flags[id] |= kFlag_Typed;
+    m_types[id] = quint8(type);
+    m_costs[id] = m_typeCosts[type];
+
+    ++m_revision;
+}
+
+void SpatialGraph::setTypeCost(SpatialNodeType type, int cost)
+{
+    if(m_typeCosts[type] == cost)
+        return;
+
+    m_typeCosts[type] = cost;
+
+    for(int i = 0; i < m_costs.size(); ++i)
+        m_costs[i] = m_typeCosts[m_types[i]];
+
+    ++m_revision;
+}
+
+int SpatialGraph::getNumTypedNodes() const
+{
+    int count = 0;
+
+    for(int i = 0; i < m_flags.size(); ++i)
+        if(m_flags[i] & kFlag_Typed)
+            ++count;
+
+    return count;
+}
+
+QStringList SpatialGraph::getNames() const
+{
+    QStringList names = m_names.toList();
+    names.sort();
+
+    return names;
+}
+
+int SpatialGraph::intern(const QString &name)
+{
+    QHash<QString, int>::const_iterator it = m_ids.constFind(name);
+
+    if(it != m_ids.constEnd())
+        return it.value();
+
+    int id = m_names.size();
+
+    m_ids.insert(name, id);
+    m_names.append(name);
+    m_flags.append(name.contains("Logic") ? quint8(kFlag_LogicName) : quint8(0));
+    m_types.append(quint8(defaultType(id)));
+    m_costs.append(m_typeCosts[m_types[id]]);
+    m_offsets.append(m_offsets.last());     //no neighbours until the next compile
+    m_reverseOffsets.append(m_reverseOffsets.last());
+
+    return id;
+}
+
+QVector<QPair<int, int> > SpatialGraph::getEdges() const
+{
+    QVector<QPair<int, int> > edges;
+    edges.reserve(m_neighbors.size());
+
+    for(int i = 0; i + 1 < m_offsets.size(); ++i)
+        for(int j = m_offsets[i]; j < m_offsets[i + 1]; ++j)
+            edges.append(qMakePair(i, m_neighbors[j]));
+
+    return edges;
+}
+
+void SpatialGraph::compile(const QVector<QPair<int, int> > &edges)
+{
+    int numOld = m_names.size();
+
+    //keep the nodes on an edge or with a type, in the order they were first seen
+    QVector<bool> onEdge(numOld, false);
+
+    for(int i = 0; i < edges.size(); ++i)
+    {
+        onEdge[edges[i].first] = true;
+        onEdge[edges[i].second] = true;
+    }
+
+    QVector<int> newIds(numOld, kNoNode);
+    QVector<QString> names;
+    QVector<quint8> flags;
+    QVector<quint8> types;
+    QVector<int> costs;
+
+    for(int i = 0; i < numOld; ++i)
+    {
+        if(!onEdge[i] && !(m_flags[i] & kFlag_Typed))
+            continue;
+
+        newIds[i] = names.size();
+        names.append(m_names[i]);
+        flags.append(m_flags[i]);
+        types.append(m_types[i]);
+        costs.append(m_costs[i]);
+    }
+
+    m_names = names;
+    m_flags = flags;
+    m_types = types;
+    m_costs = costs;
+
+    m_ids.clear();
+    m_ids.reserve(m_names.size());
+
+    for(int i = 0; i < m_names.size(); ++i)
+        m_ids.insert(m_names[i], i);
+
+    //counting sort by source, which keeps each row in the order the edges were added
+    int numNodes = m_names.size();
+    m_offsets.fill(0, numNodes + 1);
+
+    for(int i = 0; i < edges.size(); ++i)
+        ++m_offsets[newIds[edges[i].first] + 1];
+
+    for(int i = 0; i < numNodes; ++i)
+        m_offsets[i + 1] += m_offsets[i];
+
+    QVector<int> neighbors(edges.size());
+    QVector<int> fill = m_offsets;
+
+    for(int i = 0; i < edges.size(); ++i)
+        neighbors[fill[newIds[edges[i].first]]++] = newIds[edges[i].second];
+
+    //drop repeated edges, a row's neighbours are stamped with its source as they are seen
+    QVector<int> seenFrom(numNodes, kNoNode);
+    int size = 0;
+
+    for(int i = 0; i < numNodes; ++i)
+    {
+        int begin = m_offsets[i];
+        m_offsets[i] = size;
+
+        for(int j = begin; j < m_offsets[i + 1]; ++j)
+        {
+            if(seenFrom[neighbors[j]] == i)
+                continue;
+
+            seenFrom[neighbors[j]] = i;
+            neighbors[size++] = neighbors[j];
+        }
+    }
+
+    m_offsets[numNodes] = size;
+    neighbors.resize(size);
+    m_neighbors = neighbors;
+
+    //the same edges by target, rows again in the order the edges were added
+    m_reverseOffsets.fill(0, numNodes + 1);
+
+    for(int i = 0; i < size; ++i)
+        ++m_reverseOffsets[m_neighbors[i] + 1];
+
+    for(int i = 0; i < numNodes; ++i)
+        m_reverseOffsets[i + 1] += m_reverseOffsets[i];
+
+    m_reverseNeighbors.resize(size);
+    fill = m_reverseOffsets;
+
+    for(int i = 0; i < numNodes; ++i)
+        for(int j = m_offsets[i]; j < m_offsets[i + 1]; ++j)
+            m_reverseNeighbors[fill[m_neighbors[j]]++] = i;
+
+    ++m_revision;
+}
@@ -0,0 +1,140 @@
+#ifndef SPATIALGRAPH_H
+#define SPATIALGRAPH_H
+
+#include <QHash>
+#include <QVector>
+#include <QPair>
+#include <QStringList>
+
+enum SpatialNodeType
+{
+    TYPE_LOCO,
+    TYPE_TRIGGER,
+    TYPE_ARTIFACT,
+    TYPE_LOGIC
+};
+
+///
+/// \brief Spatial graph compiled into integer ids and a compressed sparse row adjacency.
+///
+/// Node ids are interned as they are loaded and only turned back into strings at the edges of the
+/// API, so path queries walk contiguous arrays of ints: the neighbours of node i are
+/// getNeighbors()[getOffsets()[i]] up to getNeighbors()[getOffsets()[i + 1]], in the order their
+/// edges were loaded. The edges into each node are kept the same way, for searching backwards.
+/// Loading recompiles the whole graph, which is only done when files are opened.
+///
+/// Stepping onto a node costs what its type is set to cost, so paths can pass through logic or
+/// trigger nodes without counting them. The cost of every node is worked out as types and costs
+/// are set, nodes without a type from the nodes file being taken as logic if their id says so and
+/// as locomotion otherwise.
+///
+class SpatialGraph
+{
+public:
+    static const int kNoNode = -1;
+
+    SpatialGraph();
+
+    void clear();
+
+    ///
+    /// \brief Drop every edge, nodes that only had edges go with them
+    ///
+    void clearEdges();
+
+    ///
+    /// \brief Drop every node type, nodes that only had a type go with them
+    ///
+    void clearTypes();
+
+    ///
+    /// \brief Add directed edges from the first node of each pair to the second, repeats are only kept once
+    ///
+    void addEdges(const QVector<QPair<QString, QString> > &edges);
+
+    void setType(const QString &name, SpatialNodeType type);
+
+    ///
+    /// \brief Set what stepping onto a node of a type costs, by default logic nodes cost 0 and the rest 1
+    ///
+    void setTypeCost(SpatialNodeType type, int cost);
+
+    ///
+    /// \brief Id of a node, kNoNode if the graph does not have it
+    ///
+    int idOf(const QString &name) const {return m_ids.value(name, kNoNode);}
+    const QString &nameOf(int id) const {return m_names[id];}
+
+    int getNumNodes() const {return m_names.size();}
+    int getNumEdges() const {return m_neighbors.size();}
+    int getNumTypedNodes() const;
+
+    const int *getOffsets() const {return m_offsets.constData();}
+    const int *getNeighbors() const {return m_neighbors.constData();}
+
+    ///
+    /// \brief Same as getOffsets() and getNeighbors(), for the nodes with an edge into each node
+    ///
+    const int *getReverseOffsets() const {return m_reverseOffsets.constData();}
+    const int *getReverseNeighbors() const {return m_reverseNeighbors.constData();}
+
+    ///
+    /// \brief Whether the node's type was set rather than taken from its id
+    ///
+    bool hasType(int id) const {return m_flags[id] & kFlag_Typed;}
+    SpatialNodeType getType(int id) const {return SpatialNodeType(m_types[id]);}
+
+    ///
+    /// \brief What stepping onto the node costs
+    ///
+    int getCost(int id) const {return m_costs[id];}
+    const int *getCosts() const {return m_costs.constData();}
+
+    ///
+    /// \brief Ids of every node that has edges or a type, sorted
+    ///
+    QStringList getNames() const;
+
+    ///
+    /// \brief Changes whenever nodes, edges or types change, for telling when what was worked out from the graph is stale
+    ///
+    int getRevision() const {return m_revision;}
+
+private:
+    enum Flag
+    {
+        kFlag_Typed = 1,
+        kFlag_LogicName = 2
+    };
+
+    int intern(const QString &name);
+
+    ///
+    /// \brief Type of a node that has not been set one
+    ///
+    SpatialNodeType defaultType(int id) const {return m_flags[id] & kFlag_LogicName ? TYPE_LOGIC : TYPE_LOCO;}
+
+    ///
+    /// \brief Rebuild the ids and rows from a list of edges, keeping the nodes that have a type
+    ///
+    void compile(const QVector<QPair<int, int> > &edges);
+
+    QVector<QPair<int, int> > getEdges() const;
+
+    QHash<QString, int> m_ids;
+    QVector<QString> m_names;
+    QVector<quint8> m_flags;
+    QVector<quint8> m_types;    //SpatialNodeType, the default one without kFlag_Typed
+    QVector<int> m_costs;
+
+    int m_typeCosts[TYPE_LOGIC + 1];
+
+    QVector<int> m_offsets;     //getNumNodes() + 1 entries
+    QVector<int> m_neighbors;
+    QVector<int> m_reverseOffsets;
+    QVector<int> m_reverseNeighbors;
+
+    int m_revision;
+};
+
+#endif // SPATIALGRAPH_H